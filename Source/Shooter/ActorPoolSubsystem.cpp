@@ -0,0 +1,176 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ActorPoolSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "Weapon.h"
+#include "ItemAssetStreamer.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/WorldSettings.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pool Hits"), STAT_ActorPoolHits, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pool Fresh Spawns"), STAT_ActorPoolFreshSpawns, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Actors"), STAT_ActorPoolFreeActors, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarActorPoolMaxPerClass(
+	TEXT("Shooter.ActorPool.MaxPerClass"),
+	64,
+	TEXT("Free actors kept per class, actors released past it are destroyed."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarActorPoolPrewarmCharacters(
+	TEXT("Shooter.ActorPool.PrewarmCharacters"),
+	0,
+	TEXT("Characters of the game mode's default pawn class spawned into the pool when the map starts."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarActorPoolPrewarmWeapons(
+	TEXT("Shooter.ActorPool.PrewarmWeapons"),
+	8,
+	TEXT("Default weapons of the game mode's default pawn class spawned into the pool once the map starts\n")
+	TEXT("and the weapon class is streamed in."),
+	ECVF_Default);
+
+bool UActorPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Only the server owns the replicated actors, clients receive them
+	const AGameModeBase* GameMode = InWorld.GetAuthGameMode();
+	UClass* CharacterClass = GameMode ? GameMode -> DefaultPawnClass.Get() : nullptr;
+	if(CharacterClass == nullptr || !CharacterClass -> IsChildOf(AShooterCharacter::StaticClass())) return;
+
+	Prewarm(CharacterClass, CVarActorPoolPrewarmCharacters.GetValueOnGameThread());
+	const int32 NumWeapons = CVarActorPoolPrewarmWeapons.GetValueOnGameThread();
+	UItemAssetStreamer* AssetStreamer = InWorld.GetSubsystem<UItemAssetStreamer>();
+	if(NumWeapons > 0 && AssetStreamer)
+	{
+		// Loading the weapon class here would stall the map start, prewarm once it is streamed in
+		const TSoftClassPtr<AWeapon> WeaponClass =
+			GetDefault<AShooterCharacter>(CharacterClass) -> GetDefaultWeaponClass();
+		TArray<FSoftObjectPath> Paths{ WeaponClass.ToSoftObjectPath() };
+		AssetStreamer -> RequestAssets(this, MoveTemp(Paths), FStreamableDelegate::CreateWeakLambda(this,
+			[this, WeaponClass, NumWeapons]()
+			{
+				Prewarm(WeaponClass.Get(), NumWeapons);
+			}));
+	}
+}
+
+AActor* UActorPoolSubsystem::AcquireActor(UClass* Class, const FTransform& Transform)
+{
+	if(Class == nullptr) return nullptr;
+
+	if(FActorPoolBucket* Bucket = Pools.Find(Class))
+	{
+		while(Bucket -> FreeActors.Num() > 0)
+		{
+			AActor* Actor = Bucket -> FreeActors.Pop(false);
+			DEC_DWORD_STAT(STAT_ActorPoolFreeActors);
+			// Something else may have destroyed it while it was pooled
+			if(!IsValid(Actor)) continue;
+
+			Actor -> SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+			Actor -> SetActorHiddenInGame(false);
+			Actor -> SetActorEnableCollision(true);
+			RestoreTicks(Actor);
+			if(IPooledActor* PooledActor = Cast<IPooledActor>(Actor))
+			{
+				PooledActor -> OnAcquiredFromPool();
+			}
+			INC_DWORD_STAT(STAT_ActorPoolHits);
+			return Actor;
+		}
+	}
+
+	INC_DWORD_STAT(STAT_ActorPoolFreshSpawns);
+	return SpawnPooledActor(Class, Transform);
+}
+
+void UActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	if(!IsValid(Actor)) return;
+
+	FActorPoolBucket& Bucket = Pools.FindOrAdd(Actor -> GetClass());
+	if(Bucket.FreeActors.Num() >= CVarActorPoolMaxPerClass.GetValueOnGameThread())
+	{
+		Actor -> Destroy();
+		return;
+	}
+	if(Bucket.FreeActors.Contains(Actor)) return;
+
+	if(IPooledActor* PooledActor = Cast<IPooledActor>(Actor))
+	{
+		PooledActor -> OnReleasedToPool();
+	}
+	Deactivate(Actor);
+	Bucket.FreeActors.Add(Actor);
+	INC_DWORD_STAT(STAT_ActorPoolFreeActors);
+}
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, int32 Count)
+{
+	if(Class == nullptr || Count <= 0) return;
+
+	const int32 MaxPerClass = CVarActorPoolMaxPerClass.GetValueOnGameThread();
+	FActorPoolBucket& Bucket = Pools.FindOrAdd(Class);
+	Bucket.FreeActors.Reserve(FMath::Min(Count, MaxPerClass));
+	while(Bucket.FreeActors.Num() < FMath::Min(Count, MaxPerClass))
+	{
+		// Out of the way, so they never show up nor overlap before they're hidden
+		AActor* Actor = SpawnPooledActor(Class, GetParkingTransform());
+		if(Actor == nullptr) return;
+
+		ReleaseActor(Actor);
+	}
+}
+
+int32 UActorPoolSubsystem::GetNumFreeActors(UClass* Class) const
+{
+	const FActorPoolBucket* Bucket = Pools.Find(Class);
+	return Bucket ? Bucket -> FreeActors.Num() : 0;
+}
+
+AActor* UActorPoolSubsystem::SpawnPooledActor(UClass* Class, const FTransform& Transform) const
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld() -> SpawnActor<AActor>(Class, Transform, SpawnParameters);
+}
+
+void UActorPoolSubsystem::Deactivate(AActor* Actor) const
+{
+	Actor -> SetActorHiddenInGame(true);
+	Actor -> SetActorEnableCollision(false);
+	Actor -> SetActorTickEnabled(false);
+	// Meshes and movement components tick on their own
+	Actor -> ForEachComponent<UActorComponent>(false, [](UActorComponent* Component)
+	{
+		Component -> SetComponentTickEnabled(false);
+	});
+	Actor -> SetActorTransform(GetParkingTransform(), false, nullptr, ETeleportType::ResetPhysics);
+}
+
+void UActorPoolSubsystem::RestoreTicks(AActor* Actor)
+{
+	Actor -> SetActorTickEnabled(Actor -> PrimaryActorTick.bStartWithTickEnabled);
+	Actor -> ForEachComponent<UActorComponent>(false, [](UActorComponent* Component)
+	{
+		Component -> SetComponentTickEnabled(Component -> PrimaryComponentTick.bStartWithTickEnabled);
+	});
+}
+
+FTransform UActorPoolSubsystem::GetParkingTransform() const
+{
+	const AWorldSettings* WorldSettings = GetWorld() -> GetWorldSettings();
+	const float KillZ = WorldSettings ? WorldSettings -> KillZ : -HALF_WORLD_MAX1;
+	return FTransform(FVector(0.f, 0.f, KillZ + 1000.f));
+}
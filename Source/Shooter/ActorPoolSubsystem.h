@@ -0,0 +1,90 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "ActorPoolSubsystem.generated.h"
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UPooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/** Reset hooks of actors recycled by UActorPoolSubsystem */
+class SHOOTER_API IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Called when the actor leaves the pool, once it is visible again at its new transform */
+	virtual void OnAcquiredFromPool() {}
+
+	/** Called when the actor goes back to the pool, before it is hidden */
+	virtual void OnReleasedToPool() {}
+};
+
+/** Free actors of a single class */
+USTRUCT()
+struct FActorPoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AActor*> FreeActors;
+};
+
+/**
+ * Per-world pool of weapons, items and characters.
+ * Released actors are hidden, lose their collision and their actor and component ticks, and are parked above the
+ * world's KillZ. AcquireActor hands them out again instead of spawning a new actor, so respawns and loot drops don't spawn, destroy and garbage collect actors.
+ * Actors implementing IPooledActor reset their state (ammo, ItemState, combat state) in its hooks.
+ * Replicated actors must be acquired and released on the server.
+ */
+UCLASS()
+class SHOOTER_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Returns a free actor of Class moved to Transform, or a freshly spawned one if the pool of Class is empty */
+	AActor* AcquireActor(UClass* Class, const FTransform& Transform);
+
+	template<class T>
+	T* AcquireActor(UClass* Class, const FTransform& Transform)
+	{
+		return Cast<T>(AcquireActor(Class, Transform));
+	}
+
+	/** Put Actor back in the pool of its class, or destroy it if the pool is full */
+	void ReleaseActor(AActor* Actor);
+
+	/** Spawn free actors of Class until its pool holds Count of them */
+	UFUNCTION(BlueprintCallable, Category = "Actor Pool")
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count);
+
+	/** Returns the number of free actors of Class */
+	int32 GetNumFreeActors(UClass* Class) const;
+
+private:
+	/** Spawn a new actor of Class at Transform */
+	AActor* SpawnPooledActor(UClass* Class, const FTransform& Transform) const;
+
+	/** Hide Actor, disable its collision and ticks, and park it */
+	void Deactivate(AActor* Actor) const;
+
+	/** Enable the ticks of Actor and its components that start enabled */
+	static void RestoreTicks(AActor* Actor);
+
+	/** Out of sight, but above KillZ so the world doesn't destroy the actors */
+	FTransform GetParkingTransform() const;
+
+	/** Pools mapped by actor class */
+	UPROPERTY()
+	TMap<UClass*, FActorPoolBucket> Pools;
+};
@@ -0,0 +1,263 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "AnimBudgetSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "ShooterAnimInstance.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Budget Characters"), STAT_AnimBudgetCharacters, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Budget Full Rate Characters"), STAT_AnimBudgetFullRate, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Budget Reduced Rate Characters"), STAT_AnimBudgetReducedRate, STATGROUP_Shooter);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Anim Budget Estimated Cost (ms)"), STAT_AnimBudgetEstimatedCost, STATGROUP_Shooter);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Anim Budget Update Cost (ms)"), STAT_AnimBudgetUpdateCost, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarAnimBudgetBudgetMs(
+	TEXT("Shooter.AnimBudget.BudgetMs"),
+	2.f,
+	TEXT("Milliseconds per frame allowed for the animation of shooter characters."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarAnimBudgetUpdateCostMs(
+	TEXT("Shooter.AnimBudget.UpdateCostMs"),
+	0.08f,
+	TEXT("Milliseconds of a single full anim graph update assumed until one is measured."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAnimBudgetCostSmoothing(
+	TEXT("Shooter.AnimBudget.CostSmoothing"),
+	0.1f,
+	TEXT("Weight of the last frame's measured update cost in the smoothed cost, between 0 and 1.\n")
+	TEXT("0 doesn't measure and always uses Shooter.AnimBudget.UpdateCostMs."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAnimBudgetFullRateDistance(
+	TEXT("Shooter.AnimBudget.FullRateDistance"),
+	1500.f,
+	TEXT("Characters closer than this to a view always update at full rate."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarAnimBudgetMaxTickRate(
+	TEXT("Shooter.AnimBudget.MaxTickRate"),
+	8,
+	TEXT("Characters update their anim graph at least once every this many frames, off screen ones always do."),
+	ECVF_Scalability);
+
+UAnimBudgetSubsystem::UAnimBudgetSubsystem():
+	SmoothedUpdateCostMs(-1.f)
+{
+
+}
+
+bool UAnimBudgetSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UAnimBudgetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	MeasureUpdateCost();
+	AllocateBudget();
+}
+
+bool UAnimBudgetSubsystem::IsTickable() const
+{
+	return Entries.Num() > 0;
+}
+
+TStatId UAnimBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAnimBudgetSubsystem, STATGROUP_Tickables);
+}
+
+void UAnimBudgetSubsystem::RegisterCharacter(AShooterCharacter* Character)
+{
+	if(Character == nullptr || Entries.ContainsByPredicate(
+		[Character](const FAnimBudgetEntry& Entry) { return Entry.Character == Character; })) return;
+
+	USkeletalMeshComponent* Mesh = Character -> GetMesh();
+	Mesh -> bEnableUpdateRateOptimizations = true;
+	Mesh -> EnableExternalTickRateControl(true);
+	Mesh -> SetExternalTickRate(1);
+
+	FAnimBudgetEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Character = Character;
+	INC_DWORD_STAT(STAT_AnimBudgetCharacters);
+}
+
+void UAnimBudgetSubsystem::UnregisterCharacter(AShooterCharacter* Character)
+{
+	const int32 Index = Entries.IndexOfByPredicate(
+		[Character](const FAnimBudgetEntry& Entry) { return Entry.Character == Character; });
+	if(Index == INDEX_NONE) return;
+
+	USkeletalMeshComponent* Mesh = Character -> GetMesh();
+	Mesh -> EnableExternalTickRateControl(false);
+	Mesh -> EnableExternalInterpolation(false);
+	Entries.RemoveAtSwap(Index);
+	DEC_DWORD_STAT(STAT_AnimBudgetCharacters);
+}
+
+float UAnimBudgetSubsystem::GetUpdateCostMs() const
+{
+	if(SmoothedUpdateCostMs < 0.f || CVarAnimBudgetCostSmoothing.GetValueOnGameThread() <= 0.f)
+	{
+		return CVarAnimBudgetUpdateCostMs.GetValueOnGameThread();
+	}
+	return SmoothedUpdateCostMs;
+}
+
+void UAnimBudgetSubsystem::MeasureUpdateCost()
+{
+	const float Smoothing = FMath::Min(CVarAnimBudgetCostSmoothing.GetValueOnGameThread(), 1.f);
+	if(Smoothing <= 0.f) return;
+
+	// The anim instances time their updates since we last asked, full rate or not
+	float CostMs = 0.f;
+	int32 NumUpdates = 0;
+	for(const FAnimBudgetEntry& Entry : Entries)
+	{
+		const AShooterCharacter* Character = Entry.Character.Get();
+		UShooterAnimInstance* AnimInstance = Character ?
+			Cast<UShooterAnimInstance>(Character -> GetMesh() -> GetAnimInstance()) : nullptr;
+		if(AnimInstance == nullptr) continue;
+
+		int32 InstanceUpdates = 0;
+		CostMs += AnimInstance -> ConsumeUpdateCostMs(InstanceUpdates);
+		NumUpdates += InstanceUpdates;
+	}
+	if(NumUpdates == 0) return;
+
+	const float SampleMs = CostMs / NumUpdates;
+	SmoothedUpdateCostMs = SmoothedUpdateCostMs < 0.f ? SampleMs :
+		FMath::Lerp(SmoothedUpdateCostMs, SampleMs, Smoothing);
+}
+
+void UAnimBudgetSubsystem::AllocateBudget()
+{
+	CSV_SCOPED_TIMING_STAT(Shooter, AnimBudgetAllocate);
+
+	// Local views, or every player on a dedicated server
+	ViewLocations.Reset();
+	for(FConstPlayerControllerIterator Iterator = GetWorld() -> GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator -> Get();
+		if(PlayerController == nullptr) continue;
+		if(PlayerController -> IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController -> GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+		else if(GetWorld() -> GetNetMode() == NM_DedicatedServer && PlayerController -> GetPawn())
+		{
+			ViewLocations.Add(PlayerController -> GetPawn() -> GetActorLocation());
+		}
+	}
+
+	const float FullRateDistanceSquared = FMath::Square(CVarAnimBudgetFullRateDistance.GetValueOnGameThread());
+	const int32 MaxTickRate = FMath::Clamp(CVarAnimBudgetMaxTickRate.GetValueOnGameThread(), 1, 255);
+
+	// Split the characters between the full rate ones and the ones sharing the budget
+	int32 NumFullRate = 0;
+	int32 NumVisible = 0;
+	RankedEntries.Reset();
+	for(int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		FAnimBudgetEntry& Entry = Entries[Index];
+		const AShooterCharacter* Character = Entry.Character.Get();
+		if(Character == nullptr) continue;
+
+		Entry.ViewDistanceSquared = MAX_flt;
+		for(const FVector& ViewLocation : ViewLocations)
+		{
+			Entry.ViewDistanceSquared = FMath::Min(Entry.ViewDistanceSquared,
+				FVector::DistSquared(ViewLocation, Character -> GetActorLocation()));
+		}
+		Entry.bVisible = Character -> GetMesh() -> WasRecentlyRendered(0.2f);
+		Entry.bFullRate = Character -> IsLocallyControlled() || Entry.ViewDistanceSquared <= FullRateDistanceSquared;
+		if(Entry.bFullRate)
+		{
+			NumFullRate++;
+		}
+		else
+		{
+			RankedEntries.Add(Index);
+			NumVisible += Entry.bVisible ? 1 : 0;
+		}
+	}
+
+	// Visible characters first, the closest first
+	RankedEntries.Sort([this](int32 A, int32 B)
+	{
+		const FAnimBudgetEntry& EntryA = Entries[A];
+		const FAnimBudgetEntry& EntryB = Entries[B];
+		if(EntryA.bVisible != EntryB.bVisible) return EntryA.bVisible;
+		return EntryA.ViewDistanceSquared < EntryB.ViewDistanceSquared;
+	});
+
+	// Find the largest bucket of full rate updates that fits in the budget, off screen characters take the slowest rate
+	const float UpdateCostMs = FMath::Max(GetUpdateCostMs(), KINDA_SMALL_NUMBER);
+	const float OffScreenUpdates = static_cast<float>(RankedEntries.Num() - NumVisible) / MaxTickRate;
+	const float AvailableUpdates = CVarAnimBudgetBudgetMs.GetValueOnGameThread() / UpdateCostMs - NumFullRate -
+		OffScreenUpdates;
+	int32 BucketSize = 1;
+	int32 MaxBucketSize = FMath::Max(NumVisible, 1);
+	while(BucketSize < MaxBucketSize)
+	{
+		const int32 Middle = (BucketSize + MaxBucketSize + 1) / 2;
+		if(GetUpdatesPerFrame(NumVisible, Middle, MaxTickRate) <= AvailableUpdates)
+		{
+			BucketSize = Middle;
+		}
+		else
+		{
+			MaxBucketSize = Middle - 1;
+		}
+	}
+
+	// Hand the rates to the meshes, the engine interpolates the frames they skip
+	float EstimatedUpdates = NumFullRate;
+	for(FAnimBudgetEntry& Entry : Entries)
+	{
+		if(Entry.bFullRate && Entry.Character.IsValid())
+		{
+			Entry.Character -> GetMesh() -> SetExternalTickRate(1);
+			Entry.Character -> GetMesh() -> EnableExternalInterpolation(false);
+		}
+	}
+	for(int32 Rank = 0; Rank < RankedEntries.Num(); Rank++)
+	{
+		const int32 TickRate = Rank < NumVisible ? GetTickRate(Rank, BucketSize, MaxTickRate) : MaxTickRate;
+		EstimatedUpdates += 1.f / TickRate;
+
+		USkeletalMeshComponent* Mesh = Entries[RankedEntries[Rank]].Character -> GetMesh();
+		Mesh -> SetExternalTickRate(static_cast<uint8>(TickRate));
+		Mesh -> EnableExternalInterpolation(TickRate > 1);
+	}
+
+	INC_DWORD_STAT_BY(STAT_AnimBudgetFullRate, NumFullRate);
+	INC_DWORD_STAT_BY(STAT_AnimBudgetReducedRate, RankedEntries.Num());
+	SET_FLOAT_STAT(STAT_AnimBudgetEstimatedCost, EstimatedUpdates * UpdateCostMs);
+	SET_FLOAT_STAT(STAT_AnimBudgetUpdateCost, UpdateCostMs);
+}
+
+float UAnimBudgetSubsystem::GetUpdatesPerFrame(int32 Count, int32 BucketSize, int32 MaxTickRate)
+{
+	float Updates = 0.f;
+	for(int32 Rank = 0; Rank < Count; Rank++)
+	{
+		Updates += 1.f / GetTickRate(Rank, BucketSize, MaxTickRate);
+	}
+	return Updates;
+}
+
+int32 UAnimBudgetSubsystem::GetTickRate(int32 Rank, int32 BucketSize, int32 MaxTickRate)
+{
+	return FMath::Min(1 + Rank / BucketSize, MaxTickRate);
+}
@@ -0,0 +1,82 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AnimBudgetSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** Animation budget state of a single character */
+struct FAnimBudgetEntry
+{
+	TWeakObjectPtr<AShooterCharacter> Character;
+
+	/** Squared distance to the closest view, lower is more significant */
+	float ViewDistanceSquared;
+
+	/** True if the character animates every frame regardless of the budget */
+	bool bFullRate;
+
+	/** True if the mesh was rendered recently */
+	bool bVisible;
+};
+
+/**
+ * Keeps the animation cost of all shooter characters within Shooter.AnimBudget.BudgetMs.
+ * Characters are ranked by distance to the local views, the least significant ones update their anim graph every
+ * few frames (update rate optimization) and interpolate the skipped frames. Locally controlled characters and the
+ * ones within Shooter.AnimBudget.FullRateDistance always update at full rate.
+ * The cost of an update is measured every frame on the characters' anim instances and smoothed
+ * (Shooter.AnimBudget.CostSmoothing), Shooter.AnimBudget.UpdateCostMs is only assumed until the first measurement.
+ */
+UCLASS()
+class SHOOTER_API UAnimBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UAnimBudgetSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Take control of Character's mesh update rate */
+	void RegisterCharacter(AShooterCharacter* Character);
+
+	/** Give the update rate of Character's mesh back to the engine */
+	void UnregisterCharacter(AShooterCharacter* Character);
+
+	FORCEINLINE int32 GetNumCharacters() const { return Entries.Num(); }
+
+	/** Milliseconds of a single full anim graph update the budget is allocated with */
+	float GetUpdateCostMs() const;
+
+private:
+	/** Add the animation cost of the characters' last updates to the smoothed cost */
+	void MeasureUpdateCost();
+
+	/** Rank the characters and set the update rate of their meshes */
+	void AllocateBudget();
+
+	/** Number of full rate updates per frame of Count ranked characters, the ones past every BucketSize update less often */
+	static float GetUpdatesPerFrame(int32 Count, int32 BucketSize, int32 MaxTickRate);
+
+	/** Returns the tick rate of the character at Rank */
+	static int32 GetTickRate(int32 Rank, int32 BucketSize, int32 MaxTickRate);
+
+	/** Registered characters */
+	TArray<FAnimBudgetEntry> Entries;
+
+	/** Indices of Entries sharing the budget, ordered by significance. Reused every frame */
+	TArray<int32> RankedEntries;
+
+	/** Locations the characters are seen from. Reused every frame */
+	TArray<FVector> ViewLocations;
+
+	/** Smoothed measured milliseconds of a single update, negative until the first one is measured */
+	float SmoothedUpdateCostMs;
+};
@@ -0,0 +1,198 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "DroppedItemSubsystem.h"
+
+#include "Shooter.h"
+#include "ActorPoolSubsystem.h"
+#include "Item.h"
+#include "Weapon.h"
+
+DECLARE_CYCLE_STAT(TEXT("Dropped Items Settling"), STAT_DroppedItemsSettling, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dropped Items"), STAT_DroppedItems, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dropped Items Settled Early"), STAT_DroppedItemsSettled, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dropped Items Despawned"), STAT_DroppedItemsDespawned, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarDropsMaxItems(
+	TEXT("Shooter.Drops.MaxItems"),
+	32,
+	TEXT("Maximum number of dropped items in the world, the least recently watched ones despawn first.\n")
+	TEXT("Watched items are never despawned, so the cap can be exceeded while players look at the drops."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDropsWatchRadius(
+	TEXT("Shooter.Drops.WatchRadius"),
+	2000.f,
+	TEXT("Dropped items closer than this to a player, or recently rendered, count as watched."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDropsSettleSpeed(
+	TEXT("Shooter.Drops.SettleSpeed"),
+	5.f,
+	TEXT("A falling item moving slower than this (cm/s) for Shooter.Drops.SettleTime stops simulating physics."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDropsSettleTime(
+	TEXT("Shooter.Drops.SettleTime"),
+	0.15f,
+	TEXT("Seconds a falling item has to stay below Shooter.Drops.SettleSpeed to count as resting."),
+	ECVF_Default);
+
+/** Seconds between two world cap updates */
+static constexpr float DropsCapInterval = 0.5f;
+
+UDroppedItemSubsystem::UDroppedItemSubsystem():
+	CapCountdown(0.f)
+{
+
+}
+
+bool UDroppedItemSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UDroppedItemSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	CSV_SCOPED_TIMING_STAT(Shooter, DroppedItemsTick);
+
+	UpdateSettling(DeltaTime);
+
+	CapCountdown -= DeltaTime;
+	if(CapCountdown <= 0.f)
+	{
+		CapCountdown = DropsCapInterval;
+		UpdateWorldCap();
+	}
+}
+
+bool UDroppedItemSubsystem::IsTickable() const
+{
+	return Drops.Num() > 0;
+}
+
+TStatId UDroppedItemSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDroppedItemSubsystem, STATGROUP_Tickables);
+}
+
+void UDroppedItemSubsystem::RegisterDrop(AItem* Item)
+{
+	if(Item == nullptr) return;
+
+	FDroppedItemEntry* Entry = Drops.FindByPredicate([Item](const FDroppedItemEntry& Drop) { return Drop.Item == Item; });
+	if(Entry == nullptr)
+	{
+		Entry = &Drops.AddDefaulted_GetRef();
+		Entry -> Item = Item;
+		INC_DWORD_STAT(STAT_DroppedItems);
+	}
+	Entry -> LastWatchedTime = GetWorld() -> GetTimeSeconds();
+	Entry -> RestingTime = 0.f;
+}
+
+void UDroppedItemSubsystem::UpdateSettling(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_DroppedItemsSettling);
+
+	const float SettleSpeedSquared = FMath::Square(CVarDropsSettleSpeed.GetValueOnGameThread());
+	const float SettleTime = CVarDropsSettleTime.GetValueOnGameThread();
+
+	for(FDroppedItemEntry& Entry : Drops)
+	{
+		AItem* Item = Entry.Item.Get();
+		if(Item == nullptr || Item -> GetItemState() != EItemState::EIS_Falling) continue;
+
+		const UPrimitiveComponent* Mesh = Item -> GetItemMesh();
+		if(!Mesh -> IsSimulatingPhysics()) continue; // The collision profile isn't committed yet
+
+		// A sleeping body is at rest, an awake one has to stay slow for a while, not just at the top of its arc
+		const bool bSlow = Mesh -> GetPhysicsLinearVelocity().SizeSquared() < SettleSpeedSquared;
+		Entry.RestingTime = bSlow ? Entry.RestingTime + DeltaTime : 0.f;
+		if(Mesh -> RigidBodyIsAwake() && Entry.RestingTime < SettleTime) continue;
+
+		INC_DWORD_STAT(STAT_DroppedItemsSettled);
+		if(AWeapon* Weapon = Cast<AWeapon>(Item))
+		{
+			Weapon -> StopFalling();
+		}
+		else
+		{
+			Item -> SetItemState(EItemState::EIS_Pickup);
+		}
+	}
+}
+
+void UDroppedItemSubsystem::UpdateWorldCap()
+{
+	// Items picked up again are no longer drops
+	const int32 NumRemoved = Drops.RemoveAllSwap([](const FDroppedItemEntry& Entry)
+	{
+		const AItem* Item = Entry.Item.Get();
+		return Item == nullptr || (Item -> GetItemState() != EItemState::EIS_Falling &&
+			Item -> GetItemState() != EItemState::EIS_Pickup);
+	});
+	DEC_DWORD_STAT_BY(STAT_DroppedItems, NumRemoved);
+
+	// Clients predict their drops, only the server can despawn them
+	if(GetWorld() -> GetNetMode() == NM_Client) return;
+
+	const float Now = GetWorld() -> GetTimeSeconds();
+	TArray<int32, TInlineAllocator<16>> Unwatched;
+	for(int32 Index = 0; Index < Drops.Num(); Index++)
+	{
+		if(IsWatched(Drops[Index].Item.Get()))
+		{
+			Drops[Index].LastWatchedTime = Now;
+		}
+		else
+		{
+			Unwatched.Add(Index);
+		}
+	}
+
+	const int32 NumOverCap = Drops.Num() - FMath::Max(CVarDropsMaxItems.GetValueOnGameThread(), 0);
+	if(NumOverCap <= 0 || Unwatched.Num() == 0) return;
+
+	Unwatched.Sort([this](int32 A, int32 B) { return Drops[A].LastWatchedTime < Drops[B].LastWatchedTime; });
+	// Despawned items go back to the pool when there is one, they come back as the next dropped or spawned weapon
+	UActorPoolSubsystem* ActorPool = GetWorld() -> GetSubsystem<UActorPoolSubsystem>();
+	const int32 NumDespawns = FMath::Min(NumOverCap, Unwatched.Num());
+	for(int32 Despawn = 0; Despawn < NumDespawns; Despawn++)
+	{
+		AItem* Item = Drops[Unwatched[Despawn]].Item.Get();
+		if(ActorPool)
+		{
+			ActorPool -> ReleaseActor(Item);
+		}
+		else
+		{
+			Item -> Destroy();
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_DroppedItemsDespawned, NumDespawns);
+
+	// Despawned items are pooled or invalid now
+	DEC_DWORD_STAT_BY(STAT_DroppedItems, Drops.RemoveAllSwap([](const FDroppedItemEntry& Entry)
+	{
+		return !Entry.Item.IsValid() || Entry.Item -> GetItemState() == EItemState::EIS_Pooled;
+	}));
+}
+
+bool UDroppedItemSubsystem::IsWatched(const AItem* Item) const
+{
+	if(Item -> WasRecentlyRendered(DropsCapInterval)) return true;
+
+	const float WatchRadiusSquared = FMath::Square(CVarDropsWatchRadius.GetValueOnGameThread());
+	for(FConstPlayerControllerIterator Iterator = GetWorld() -> GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APawn* Pawn = Iterator -> Get() ? Iterator -> Get() -> GetPawn() : nullptr;
+		if(Pawn && FVector::DistSquared(Pawn -> GetActorLocation(), Item -> GetActorLocation()) <= WatchRadiusSquared)
+		{
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,61 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DroppedItemSubsystem.generated.h"
+
+class AItem;
+
+/** An item dropped by a character, tracked until it is picked up or despawned */
+struct FDroppedItemEntry
+{
+	TWeakObjectPtr<AItem> Item;
+
+	/** Time the item was dropped or last watched by a player, the oldest unwatched drops despawn first */
+	float LastWatchedTime;
+
+	/** Time the item has been moving slower than Shooter.Drops.SettleSpeed */
+	float RestingTime;
+};
+
+/**
+ * Keeps track of the items dropped by characters.
+ * Thrown weapons stop simulating as soon as they come to rest instead of waiting for the throw timer, and on the
+ * server the drops past Shooter.Drops.MaxItems are despawned, least recently watched first.
+ */
+UCLASS()
+class SHOOTER_API UDroppedItemSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UDroppedItemSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start tracking an item that was just dropped, or refresh it if it was dropped before */
+	void RegisterDrop(AItem* Item);
+
+	FORCEINLINE int32 GetNumDrops() const { return Drops.Num(); }
+
+private:
+	/** End the fall of the items that came to rest */
+	void UpdateSettling(float DeltaTime);
+
+	/** Forget the drops that were picked up, refresh the watched ones and despawn the oldest past the cap */
+	void UpdateWorldCap();
+
+	/** True if a player stands near Item or has rendered it recently */
+	bool IsWatched(const AItem* Item) const;
+
+	/** Dropped items, in no particular order */
+	TArray<FDroppedItemEntry> Drops;
+
+	/** Time left until the next world cap update */
+	float CapCountdown;
+};
@@ -0,0 +1,164 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "FXPoolSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterSignificanceSubsystem.h"
+#include "GameFramework/WorldSettings.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Pool Hits"), STAT_FXPoolHits, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Pool Misses"), STAT_FXPoolMisses, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Pool Overflows"), STAT_FXPoolOverflows, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Pool Culled"), STAT_FXPoolCulled, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Pool Components"), STAT_FXPoolComponents, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarFXPoolPrewarmCount(
+	TEXT("Shooter.FXPool.PrewarmCount"),
+	8,
+	TEXT("Number of particle components created up front for each pooled template."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFXPoolMaxSpawnsPerFrame(
+	TEXT("Shooter.FXPool.MaxSpawnsPerFrame"),
+	64,
+	TEXT("Maximum number of pooled emitters activated in a single frame, further requests are dropped."),
+	ECVF_Default);
+
+UFXPoolSubsystem::UFXPoolSubsystem():
+	SpawnFrame(0),
+	SpawnsThisFrame(0)
+{
+
+}
+
+bool UFXPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UFXPoolSubsystem::Deinitialize()
+{
+	for(UParticleSystemComponent* Component : PooledComponents)
+	{
+		if(IsValid(Component))
+		{
+			Component -> DestroyComponent();
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_FXPoolComponents, PooledComponents.Num());
+	PooledComponents.Empty();
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UFXPoolSubsystem::Prewarm(UParticleSystem* Template)
+{
+	if(Template == nullptr) return;
+
+	FEmitterPool& Pool = Pools.FindOrAdd(Template);
+	const int32 PrewarmCount = CVarFXPoolPrewarmCount.GetValueOnGameThread();
+	while(Pool.NumComponents < PrewarmCount)
+	{
+		Pool.FreeComponents.Add(CreatePooledComponent(Template, Pool));
+	}
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnEmitter(UParticleSystem* Template, const FTransform& Transform)
+{
+	if(Template == nullptr) return nullptr;
+
+	// Effects too far or out of view to be noticed aren't spawned at all
+	const UShooterSignificanceSubsystem* SignificanceSubsystem =
+		GetWorld() -> GetSubsystem<UShooterSignificanceSubsystem>();
+	const EShooterSignificance Significance = SignificanceSubsystem ?
+		SignificanceSubsystem -> GetLocationSignificance(Transform.GetLocation()) : EShooterSignificance::ESS_High;
+	if(Significance == EShooterSignificance::ESS_Culled)
+	{
+		INC_DWORD_STAT(STAT_FXPoolCulled);
+		return nullptr;
+	}
+
+	if(SpawnFrame != GFrameCounter)
+	{
+		SpawnFrame = GFrameCounter;
+		SpawnsThisFrame = 0;
+	}
+	if(SpawnsThisFrame >= CVarFXPoolMaxSpawnsPerFrame.GetValueOnGameThread())
+	{
+		INC_DWORD_STAT(STAT_FXPoolOverflows);
+		return nullptr;
+	}
+	++SpawnsThisFrame;
+
+	FEmitterPool& Pool = Pools.FindOrAdd(Template);
+	UParticleSystemComponent* Component = nullptr;
+	while(Component == nullptr && Pool.FreeComponents.Num() > 0)
+	{
+		Component = Pool.FreeComponents.Pop(false);
+		if(!IsValid(Component))
+		{
+			// Destroyed from outside the pool, forget about it
+			--Pool.NumComponents;
+			Component = nullptr;
+		}
+	}
+
+	if(Component)
+	{
+		INC_DWORD_STAT(STAT_FXPoolHits);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_FXPoolMisses);
+		Component = CreatePooledComponent(Template, Pool);
+	}
+
+	Component -> SetWorldLocationAndRotation(Transform.GetLocation(), Transform.GetRotation());
+	Component -> SetRelativeScale3D(Transform.GetScale3D());
+	UShooterSignificanceSubsystem::ApplyEmitterLOD(Component, Significance);
+	// Reset so recycled components start from a clean state, instance parameters (like the beam Target) are kept
+	Component -> Activate(true);
+	return Component;
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnEmitter(UParticleSystem* Template, const FVector& Location)
+{
+	return SpawnEmitter(Template, FTransform(Location));
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::CreatePooledComponent(UParticleSystem* Template, FEmitterPool& Pool)
+{
+	UWorld* World = GetWorld();
+	UObject* Outer = World -> GetWorldSettings() ? static_cast<UObject*>(World -> GetWorldSettings()) : World;
+
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(Outer);
+	Component -> bAutoDestroy = false;
+	Component -> bAutoActivate = false;
+	Component -> SetTemplate(Template);
+	Component -> SetUsingAbsoluteLocation(true);
+	Component -> SetUsingAbsoluteRotation(true);
+	Component -> SetUsingAbsoluteScale(true);
+	Component -> OnSystemFinished.AddDynamic(this, &UFXPoolSubsystem::OnEmitterFinished);
+	Component -> RegisterComponentWithWorld(World);
+
+	PooledComponents.Add(Component);
+	++Pool.NumComponents;
+	INC_DWORD_STAT(STAT_FXPoolComponents);
+	return Component;
+}
+
+void UFXPoolSubsystem::OnEmitterFinished(UParticleSystemComponent* FinishedComponent)
+{
+	if(FinishedComponent == nullptr) return;
+
+	FEmitterPool* Pool = Pools.Find(FinishedComponent -> Template);
+	if(Pool)
+	{
+		Pool -> FreeComponents.AddUnique(FinishedComponent);
+	}
+}
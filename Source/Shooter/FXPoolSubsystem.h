@@ -0,0 +1,69 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FXPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/**
+ * Per-world pool of particle system components for combat effects (muzzle flash, impact, beam).
+ * Components are pre-warmed per template, handed out by SpawnEmitter and put back in the pool once they finish,
+ * instead of spawning a new UParticleSystemComponent for every shot.
+ */
+UCLASS()
+class SHOOTER_API UFXPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UFXPoolSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** Create free components for Template until the pool holds Shooter.FXPool.PrewarmCount of them */
+	void Prewarm(UParticleSystem* Template);
+
+	/** Activate a pooled component of Template at Transform, at the LOD of its significance
+	 *  @return The activated component, or nullptr if Shooter.FXPool.MaxSpawnsPerFrame was reached this frame or the
+	 *	effect is culled by UShooterSignificanceSubsystem */
+	UParticleSystemComponent* SpawnEmitter(UParticleSystem* Template, const FTransform& Transform);
+
+	/** Activate a pooled component of Template at Location */
+	UParticleSystemComponent* SpawnEmitter(UParticleSystem* Template, const FVector& Location);
+
+private:
+	/** Free components and size of the pool of a single template */
+	struct FEmitterPool
+	{
+		/** Components which finished playing and can be activated again */
+		TArray<UParticleSystemComponent*> FreeComponents;
+
+		/** Number of components created for the template, free or playing */
+		int32 NumComponents = 0;
+	};
+
+	/** Create and register a new inactive component for Pool */
+	UParticleSystemComponent* CreatePooledComponent(UParticleSystem* Template, FEmitterPool& Pool);
+
+	/** Called when a pooled component finished playing, returns it to its pool */
+	UFUNCTION()
+	void OnEmitterFinished(UParticleSystemComponent* FinishedComponent);
+
+	/** Every component created by the pool, keeps them from being garbage collected */
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> PooledComponents;
+
+	/** Pools mapped by their particle system template */
+	TMap<UParticleSystem*, FEmitterPool> Pools;
+
+	/** Frame SpawnsThisFrame belongs to */
+	uint64 SpawnFrame;
+
+	/** Number of emitters spawned during SpawnFrame */
+	int32 SpawnsThisFrame;
+};
@@ -0,0 +1,184 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "GunfireAudioSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "ShooterSignificanceSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
+#include "Sound/SoundConcurrency.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gunfire Voices"), STAT_GunfireVoices, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gunfire Voices Culled"), STAT_GunfireVoicesCulled, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gunfire One Shots"), STAT_GunfireOneShots, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarGunfireAudioMaxLoops(
+	TEXT("Shooter.GunfireAudio.MaxLoops"),
+	16,
+	TEXT("Fire loops playing at once across all the shooters, the farthest ones are culled past it."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarGunfireAudioMaxOneShots(
+	TEXT("Shooter.GunfireAudio.MaxOneShots"),
+	24,
+	TEXT("Gunfire tails and single shots playing at once across all the shooters."),
+	ECVF_Scalability);
+
+UGunfireAudioSubsystem::UGunfireAudioSubsystem():
+	NumCulledVoices(0)
+{
+
+}
+
+bool UGunfireAudioSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld() && !IsRunningDedicatedServer();
+}
+
+void UGunfireAudioSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Sounds sharing a concurrency object are limited as one group, whatever their owner
+	FireLoopConcurrency = NewObject<USoundConcurrency>(this, TEXT("FireLoopConcurrency"));
+	FireLoopConcurrency -> Concurrency.bLimitToOwner = false;
+	FireLoopConcurrency -> Concurrency.ResolutionRule = EMaxConcurrentResolutionRule::StopFarthestThenOldest;
+
+	OneShotConcurrency = NewObject<USoundConcurrency>(this, TEXT("OneShotConcurrency"));
+	OneShotConcurrency -> Concurrency.bLimitToOwner = false;
+	OneShotConcurrency -> Concurrency.ResolutionRule = EMaxConcurrentResolutionRule::StopFarthestThenOldest;
+}
+
+bool UGunfireAudioSubsystem::StartFireLoop(AShooterCharacter* Shooter, USoundBase* LoopSound, bool b2D)
+{
+	if(Shooter == nullptr || LoopSound == nullptr) return false;
+	if(!IsAudible(*Shooter, b2D)) return false;
+
+	PruneFireLoops();
+	const int32 MaxLoops = FMath::Max(CVarGunfireAudioMaxLoops.GetValueOnGameThread(), 1);
+	while(FireLoops.Num() >= MaxLoops)
+	{
+		// Either the new loop or the farthest one goes
+		CullVoice();
+		const int32 CullIndex = FindFireLoopToCull(GetVoiceDistanceSquared(*Shooter, b2D));
+		if(CullIndex == INDEX_NONE) return false;
+
+		if(UAudioComponent* Component = FireLoops[CullIndex].Component.Get())
+		{
+			Component -> Stop();
+		}
+		FireLoops.RemoveAtSwap(CullIndex, 1, false);
+	}
+
+	// The engine enforces the same cap on the voices it actually plays
+	FireLoopConcurrency -> Concurrency.MaxCount = MaxLoops;
+	UAudioComponent* Component = b2D ?
+		UGameplayStatics::SpawnSound2D(Shooter, LoopSound, 1.f, 1.f, 0.f, FireLoopConcurrency) :
+		UGameplayStatics::SpawnSoundAttached(LoopSound, Shooter -> GetRootComponent(), NAME_None, FVector::ZeroVector,
+			EAttachLocation::KeepRelativeOffset, true, 1.f, 1.f, 0.f, nullptr, FireLoopConcurrency);
+
+	FGunfireVoice& Voice = FireLoops.AddDefaulted_GetRef();
+	Voice.Shooter = Shooter;
+	Voice.Component = Component;
+	Voice.b2D = b2D;
+	SET_DWORD_STAT(STAT_GunfireVoices, FireLoops.Num());
+	return true;
+}
+
+void UGunfireAudioSubsystem::StopFireLoop(AShooterCharacter* Shooter, USoundBase* TailSound)
+{
+	const int32 Index = FireLoops.IndexOfByPredicate([Shooter](const FGunfireVoice& Voice)
+	{
+		return Voice.Shooter.Get() == Shooter;
+	});
+	// The loop was culled, its tail goes with it
+	if(Index == INDEX_NONE) return;
+
+	const bool b2D = FireLoops[Index].b2D;
+	if(UAudioComponent* Component = FireLoops[Index].Component.Get())
+	{
+		Component -> Stop();
+	}
+	FireLoops.RemoveAtSwap(Index, 1, false);
+	SET_DWORD_STAT(STAT_GunfireVoices, FireLoops.Num());
+
+	if(TailSound && Shooter)
+	{
+		PlayOneShot(Shooter, TailSound, b2D);
+	}
+}
+
+void UGunfireAudioSubsystem::PlayOneShot(AShooterCharacter* Shooter, USoundBase* Sound, bool b2D)
+{
+	if(Shooter == nullptr || Sound == nullptr) return;
+	if(!IsAudible(*Shooter, b2D)) return;
+
+	OneShotConcurrency -> Concurrency.MaxCount = FMath::Max(CVarGunfireAudioMaxOneShots.GetValueOnGameThread(), 1);
+	if(b2D)
+	{
+		UGameplayStatics::PlaySound2D(Shooter, Sound, 1.f, 1.f, 0.f, OneShotConcurrency, Shooter, false);
+	}
+	else
+	{
+		UGameplayStatics::PlaySoundAtLocation(Shooter, Sound, Shooter -> GetActorLocation(), FRotator::ZeroRotator,
+			1.f, 1.f, 0.f, nullptr, OneShotConcurrency, Shooter);
+	}
+	INC_DWORD_STAT(STAT_GunfireOneShots);
+}
+
+bool UGunfireAudioSubsystem::IsAudible(const AShooterCharacter& Shooter, bool b2D)
+{
+	// Our own shots always play, the other characters' only if they're near or in view
+	if(b2D || Shooter.GetSignificance() <= EShooterSignificance::ESS_Medium) return true;
+
+	CullVoice();
+	return false;
+}
+
+void UGunfireAudioSubsystem::CullVoice()
+{
+	NumCulledVoices++;
+	INC_DWORD_STAT(STAT_GunfireVoicesCulled);
+}
+
+void UGunfireAudioSubsystem::PruneFireLoops()
+{
+	// A stale component finished on its own, a null one never existed (no audio device) and keeps counting
+	FireLoops.RemoveAllSwap([](const FGunfireVoice& Voice)
+	{
+		return !Voice.Shooter.IsValid() || Voice.Component.IsStale() ||
+			(Voice.Component.IsValid() && !Voice.Component -> IsPlaying());
+	});
+	SET_DWORD_STAT(STAT_GunfireVoices, FireLoops.Num());
+}
+
+int32 UGunfireAudioSubsystem::FindFireLoopToCull(float NewDistanceSquared) const
+{
+	// The new loop only takes the place of a farther one
+	int32 CullIndex = INDEX_NONE;
+	float CullDistanceSquared = NewDistanceSquared;
+	for(int32 Index = 0; Index < FireLoops.Num(); Index++)
+	{
+		const FGunfireVoice& Voice = FireLoops[Index];
+		const float DistanceSquared = GetVoiceDistanceSquared(*Voice.Shooter, Voice.b2D);
+		if(DistanceSquared > CullDistanceSquared)
+		{
+			CullIndex = Index;
+			CullDistanceSquared = DistanceSquared;
+		}
+	}
+	return CullIndex;
+}
+
+float UGunfireAudioSubsystem::GetVoiceDistanceSquared(const AShooterCharacter& Shooter, bool b2D) const
+{
+	if(b2D) return 0.f;
+
+	const UShooterSignificanceSubsystem* SignificanceSubsystem =
+		GetWorld() -> GetSubsystem<UShooterSignificanceSubsystem>();
+	return SignificanceSubsystem ? SignificanceSubsystem -> GetViewDistanceSquared(Shooter.GetActorLocation()) : 0.f;
+}
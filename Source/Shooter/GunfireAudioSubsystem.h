@@ -0,0 +1,89 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GunfireAudioSubsystem.generated.h"
+
+class AShooterCharacter;
+class UAudioComponent;
+class USoundBase;
+class USoundConcurrency;
+
+/** A sustained fire loop started by UGunfireAudioSubsystem */
+struct FGunfireVoice
+{
+	TWeakObjectPtr<AShooterCharacter> Shooter;
+
+	/** Null without an audio device, the voice still counts toward the cap */
+	TWeakObjectPtr<UAudioComponent> Component;
+
+	/** True for the local player's own gunfire, which plays in 2D and is never culled */
+	bool b2D;
+};
+
+/**
+ * Gunfire voices of all the shooters of the world.
+ * Automatic fire plays one looping voice per shooter instead of one voice per shot: the shooter starts its loop with
+ * the first shot and stops it with a tail (AShooterCharacter::FireLoopSound, FireTailSound). The loops are capped
+ * by Shooter.GunfireAudio.MaxLoops across all shooters; past it the farthest loop from the local views is culled,
+ * the new one or an older one. Tails and single shots share a second group capped by the engine's concurrency.
+ * Other characters' gunfire past Medium significance isn't played at all.
+ * The loops are counted whether an audio device exists or not, so the caps and the stats can be checked with the
+ * null audio device (-nosound) in a bot swarm.
+ */
+UCLASS()
+class SHOOTER_API UGunfireAudioSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UGunfireAudioSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Start the fire loop of Shooter, 2D if it is the local player's
+	 *	@return False if the loop was culled */
+	bool StartFireLoop(AShooterCharacter* Shooter, USoundBase* LoopSound, bool b2D);
+
+	/** Stop the fire loop of Shooter, and play TailSound where it was if it isn't null */
+	void StopFireLoop(AShooterCharacter* Shooter, USoundBase* TailSound);
+
+	/** Play a single shot or tail of Shooter in the shared one-shot group */
+	void PlayOneShot(AShooterCharacter* Shooter, USoundBase* Sound, bool b2D);
+
+	FORCEINLINE int32 GetNumFireLoops() const { return FireLoops.Num(); }
+
+	/** Returns the number of loops and one-shots culled since the world started */
+	FORCEINLINE int32 GetNumCulledVoices() const { return NumCulledVoices; }
+
+private:
+	/** Returns true if Shooter's gunfire is worth playing, counts it as culled otherwise */
+	bool IsAudible(const AShooterCharacter& Shooter, bool b2D);
+
+	/** Count a voice that won't play */
+	void CullVoice();
+
+	/** Remove the loops that finished or lost their shooter */
+	void PruneFireLoops();
+
+	/** Returns the index of the fire loop to cull for a new one, INDEX_NONE to cull the new one */
+	int32 FindFireLoopToCull(float NewDistanceSquared) const;
+
+	/** Squared distance of a voice to the local views, the local player's are always the closest */
+	float GetVoiceDistanceSquared(const AShooterCharacter& Shooter, bool b2D) const;
+
+	/** Concurrency shared by the fire loops of all the shooters */
+	UPROPERTY()
+	USoundConcurrency* FireLoopConcurrency;
+
+	/** Concurrency shared by the tails and single shots of all the shooters */
+	UPROPERTY()
+	USoundConcurrency* OneShotConcurrency;
+
+	TArray<FGunfireVoice> FireLoops;
+
+	int32 NumCulledVoices;
+};
@@ -0,0 +1,265 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "HitscanSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "LagCompensationSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitscan Resolve Shot Sync"), STAT_HitscanResolveShotSync, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Hitscan Submit Crosshair Traces"), STAT_HitscanSubmitCrosshairTraces, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Hitscan Submit Barrel Traces"), STAT_HitscanSubmitBarrelTraces, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Hitscan Resolve Barrel Traces"), STAT_HitscanResolveBarrelTraces, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Shots"), STAT_HitscanShots, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Traces"), STAT_HitscanTraces, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Lost Traces"), STAT_HitscanLostTraces, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarHitscanAsync(
+	TEXT("Shooter.Hitscan.Async"),
+	1,
+	TEXT("0: Trace shots on the game thread as soon as they are fired.\n")
+	TEXT("1: Batch the shots of a frame and resolve them with async traces."),
+	ECVF_Default);
+
+UHitscanSubsystem::UHitscanSubsystem():
+	CounterFrame(0),
+	ShotsThisFrame(0),
+	TracesThisFrame(0)
+{
+
+}
+
+bool UHitscanSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UHitscanSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	CSV_SCOPED_TIMING_STAT(Shooter, HitscanTick);
+
+	// Order matters, each step reads back the traces submitted by the step after it last frame
+	ResolveBarrelTraces();
+	SubmitBarrelTraces();
+	SubmitCrosshairTraces();
+}
+
+bool UHitscanSubsystem::IsTickable() const
+{
+	return QueuedShots.Num() > 0 || CrosshairTraceShots.Num() > 0 || BarrelTraceShots.Num() > 0;
+}
+
+TStatId UHitscanSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHitscanSubsystem, STATGROUP_Tickables);
+}
+
+void UHitscanSubsystem::QueueShot(const FShotRequest& Shot)
+{
+	UpdateFrameCounters();
+	++ShotsThisFrame;
+	INC_DWORD_STAT(STAT_HitscanShots);
+
+	if(CVarHitscanAsync.GetValueOnGameThread() == 0)
+	{
+		FShotRequest SyncShot{ Shot };
+		ResolveShotSync(SyncShot);
+		return;
+	}
+	QueuedShots.Add(Shot);
+}
+
+void UHitscanSubsystem::QueueShots(const TArray<FShotRequest>& Shots)
+{
+	for(const FShotRequest& Shot : Shots)
+	{
+		QueueShot(Shot);
+	}
+}
+
+int32 UHitscanSubsystem::GetShotsThisFrame() const
+{
+	return CounterFrame == GFrameCounter ? ShotsThisFrame : 0;
+}
+
+int32 UHitscanSubsystem::GetTracesThisFrame() const
+{
+	return CounterFrame == GFrameCounter ? TracesThisFrame : 0;
+}
+
+void UHitscanSubsystem::ResolveShotSync(FShotRequest& Shot)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_HitscanResolveShotSync);
+
+	FHitResult CrosshairHitResult;
+	const FCollisionQueryParams TraceParams{ GetTraceParams(Shot) };
+	GetWorld() -> LineTraceSingleByChannel(CrosshairHitResult, Shot.CrosshairTraceStart, Shot.CrosshairTraceEnd,
+		ECollisionChannel::ECC_Visibility, TraceParams);
+	CountTrace();
+	// If the crosshair trace didn't hit anything, the beam ends where the trace ends
+	Shot.BeamEndLocation = CrosshairHitResult.bBlockingHit ? CrosshairHitResult.Location : Shot.CrosshairTraceEnd;
+
+	// Is there something between the barrel and the BeamEnd?
+	const FVector MuzzleLocation{ Shot.MuzzleTransform.GetLocation() };
+	FHitResult WeaponTraceHit;
+	GetWorld() -> LineTraceSingleByChannel(WeaponTraceHit, MuzzleLocation,
+		GetBarrelTraceEnd(MuzzleLocation, Shot.BeamEndLocation), ECollisionChannel::ECC_Visibility, TraceParams);
+	CountTrace();
+
+	bool bBeamEnd = WeaponTraceHit.bBlockingHit;
+	if(bBeamEnd)
+	{
+		Shot.BeamEndLocation = WeaponTraceHit.Location;
+	}
+	RewindShot(Shot, bBeamEnd);
+	if(AShooterCharacter* Shooter = Shot.Shooter.Get())
+	{
+		Shooter -> ResolveShot(Shot, bBeamEnd);
+	}
+}
+
+void UHitscanSubsystem::SubmitCrosshairTraces()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_HitscanSubmitCrosshairTraces);
+
+	for(FShotRequest& Shot : QueuedShots)
+	{
+		Shot.TraceHandle = GetWorld() -> AsyncLineTraceByChannel(EAsyncTraceType::Single, Shot.CrosshairTraceStart,
+			Shot.CrosshairTraceEnd, ECollisionChannel::ECC_Visibility, GetTraceParams(Shot));
+		CountTrace();
+	}
+	CrosshairTraceShots.Append(MoveTemp(QueuedShots));
+	QueuedShots.Reset();
+}
+
+void UHitscanSubsystem::SubmitBarrelTraces()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_HitscanSubmitBarrelTraces);
+
+	for(int32 Index = CrosshairTraceShots.Num() - 1; Index >= 0; Index--)
+	{
+		FShotRequest& Shot = CrosshairTraceShots[Index];
+		bool bHit = false;
+		if(!QueryTraceResult(Shot.TraceHandle, bHit, Shot.BeamEndLocation))
+		{
+			// Trace the shot again now rather than lose its impact
+			INC_DWORD_STAT(STAT_HitscanLostTraces);
+			ResolveShotSync(Shot);
+			CrosshairTraceShots.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+		if(!bHit)
+		{
+			// If the crosshair trace didn't hit anything, the beam ends where the trace ends
+			Shot.BeamEndLocation = Shot.CrosshairTraceEnd;
+		}
+
+		const FVector MuzzleLocation{ Shot.MuzzleTransform.GetLocation() };
+		Shot.TraceHandle = GetWorld() -> AsyncLineTraceByChannel(EAsyncTraceType::Single, MuzzleLocation,
+			GetBarrelTraceEnd(MuzzleLocation, Shot.BeamEndLocation), ECollisionChannel::ECC_Visibility,
+			GetTraceParams(Shot));
+		CountTrace();
+	}
+	BarrelTraceShots.Append(MoveTemp(CrosshairTraceShots));
+	CrosshairTraceShots.Reset();
+}
+
+void UHitscanSubsystem::ResolveBarrelTraces()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_HitscanResolveBarrelTraces);
+
+	for(FShotRequest& Shot : BarrelTraceShots)
+	{
+		bool bBeamEnd = false;
+		if(!QueryTraceResult(Shot.TraceHandle, bBeamEnd, Shot.BeamEndLocation))
+		{
+			// Trace the shot again now rather than lose its impact
+			INC_DWORD_STAT(STAT_HitscanLostTraces);
+			ResolveShotSync(Shot);
+			continue;
+		}
+		RewindShot(Shot, bBeamEnd);
+		if(AShooterCharacter* Shooter = Shot.Shooter.Get())
+		{
+			Shooter -> ResolveShot(Shot, bBeamEnd);
+		}
+	}
+	BarrelTraceShots.Reset();
+}
+
+FCollisionQueryParams UHitscanSubsystem::GetTraceParams(const FShotRequest& Shot) const
+{
+	FCollisionQueryParams TraceParams{ SCENE_QUERY_STAT(HitscanTrace) };
+	if(Shot.bRewind)
+	{
+		// Characters are hit against their history instead, see RewindShot
+		const ULagCompensationSubsystem* LagCompensation = GetWorld() -> GetSubsystem<ULagCompensationSubsystem>();
+		if(LagCompensation)
+		{
+			TraceParams.AddIgnoredActors(LagCompensation -> GetCompensatedActors());
+		}
+	}
+	return TraceParams;
+}
+
+void UHitscanSubsystem::RewindShot(FShotRequest& Shot, bool& bBeamEnd) const
+{
+	if(!Shot.bRewind) return;
+	const ULagCompensationSubsystem* LagCompensation = GetWorld() -> GetSubsystem<ULagCompensationSubsystem>();
+	if(LagCompensation == nullptr) return;
+
+	// Same segment as the barrel trace, stopping at whatever it hit in the world
+	const FVector MuzzleLocation{ Shot.MuzzleTransform.GetLocation() };
+	const FVector RewindTraceEnd{ bBeamEnd ? Shot.BeamEndLocation :
+		GetBarrelTraceEnd(MuzzleLocation, Shot.BeamEndLocation) };
+	FRewindHit RewindHit;
+	if(LagCompensation -> RewindTrace(MuzzleLocation, RewindTraceEnd, Shot.Timestamp, Shot.Shooter.Get(), RewindHit))
+	{
+		Shot.BeamEndLocation = RewindHit.Location;
+		bBeamEnd = true;
+	}
+}
+
+bool UHitscanSubsystem::QueryTraceResult(const FTraceHandle& Handle, bool& bOutHit, FVector& OutHitLocation) const
+{
+	bOutHit = false;
+	FTraceDatum TraceDatum;
+	if(!GetWorld() -> QueryTraceData(Handle, TraceDatum)) return false;
+
+	for(const FHitResult& Hit : TraceDatum.OutHits)
+	{
+		if(Hit.bBlockingHit)
+		{
+			OutHitLocation = Hit.Location;
+			bOutHit = true;
+			break;
+		}
+	}
+	return true;
+}
+
+void UHitscanSubsystem::UpdateFrameCounters()
+{
+	if(CounterFrame != GFrameCounter)
+	{
+		CounterFrame = GFrameCounter;
+		ShotsThisFrame = 0;
+		TracesThisFrame = 0;
+	}
+}
+
+void UHitscanSubsystem::CountTrace()
+{
+	UpdateFrameCounters();
+	++TracesThisFrame;
+	INC_DWORD_STAT(STAT_HitscanTraces);
+}
+
+FVector UHitscanSubsystem::GetBarrelTraceEnd(const FVector& MuzzleLocation, const FVector& BeamEndLocation)
+{
+	const FVector StartToEnd{ BeamEndLocation - MuzzleLocation };
+	return MuzzleLocation + StartToEnd * 1.25;
+}
@@ -0,0 +1,122 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "HitscanSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** A single shot waiting to be traced by UHitscanSubsystem */
+struct FShotRequest
+{
+	/** Character who fired the shot, it spawns the impact and beam once the shot is resolved */
+	TWeakObjectPtr<AShooterCharacter> Shooter;
+
+	/** Transform of the gun barrel tip when the shot was fired */
+	FTransform MuzzleTransform;
+
+	/** Start of the trace from crosshair world location */
+	FVector CrosshairTraceStart{ 0.f };
+
+	/** End of the trace from crosshair world location */
+	FVector CrosshairTraceEnd{ 0.f };
+
+	/** World time at which the shot was fired, can be earlier than the current frame's time */
+	float Timestamp{ 0.f };
+
+	/** Trace characters as they were at Timestamp, set by the server for shots fired by clients */
+	bool bRewind{ false };
+
+	/** Where the beam ends, updated after each trace */
+	FVector BeamEndLocation{ 0.f };
+
+	/** Handle of the async trace currently in flight for this shot */
+	FTraceHandle TraceHandle;
+};
+
+/**
+ * Collects every shot fired in a frame and resolves them with the crosshair and gun barrel traces.
+ * In async mode (Shooter.Hitscan.Async 1) the crosshair traces are submitted as one batch, and the barrel traces
+ * are submitted once their results come back, so the impacts and beams are resolved a couple of frames later.
+ * In sync mode shots are traced and resolved as soon as they are queued. Async shots whose results are lost are
+ * traced again on the game thread, they are never dropped.
+ */
+UCLASS()
+class SHOOTER_API UHitscanSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UHitscanSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queue a shot for tracing, resolved immediately when async traces are disabled */
+	void QueueShot(const FShotRequest& Shot);
+
+	/** Queue all the shots a shooter fired this frame */
+	void QueueShots(const TArray<FShotRequest>& Shots);
+
+	/** Number of shots queued this frame */
+	int32 GetShotsThisFrame() const;
+
+	/** Number of traces performed or submitted this frame */
+	int32 GetTracesThisFrame() const;
+
+private:
+	/** Trace from crosshair and gun barrel on the game thread and resolve the shot */
+	void ResolveShotSync(FShotRequest& Shot);
+
+	/** Submit the crosshair traces for all the shots queued since last tick */
+	void SubmitCrosshairTraces();
+
+	/** Read back last frame's crosshair traces and submit the gun barrel traces */
+	void SubmitBarrelTraces();
+
+	/** Read back last frame's gun barrel traces and let the shooters spawn impacts and beams */
+	void ResolveBarrelTraces();
+
+	/** Trace params of a shot, rewound shots ignore the lag compensated characters' current collision */
+	FCollisionQueryParams GetTraceParams(const FShotRequest& Shot) const;
+
+	/** Trace the barrel segment of a rewound shot against the characters' history, updates the beam end on a hit */
+	void RewindShot(FShotRequest& Shot, bool& bBeamEnd) const;
+
+	/** Reads the result of an async trace, bOutHit is true if it hit something
+	 *	@return False if the result is lost, e.g. the frame's trace data was reset before it was read */
+	bool QueryTraceResult(const FTraceHandle& Handle, bool& bOutHit, FVector& OutHitLocation) const;
+
+	/** Start the per-frame counters over when a new frame starts */
+	void UpdateFrameCounters();
+
+	/** Records a trace in the per-frame counter and the stats */
+	void CountTrace();
+
+	/** Shots queued since last tick, waiting for their crosshair trace */
+	TArray<FShotRequest> QueuedShots;
+
+	/** Shots with a crosshair trace in flight */
+	TArray<FShotRequest> CrosshairTraceShots;
+
+	/** Shots with a gun barrel trace in flight */
+	TArray<FShotRequest> BarrelTraceShots;
+
+	/** Frame the counters below belong to */
+	uint64 CounterFrame;
+
+	/** Shots queued during CounterFrame */
+	int32 ShotsThisFrame;
+
+	/** Traces performed or submitted during CounterFrame */
+	int32 TracesThisFrame;
+
+public:
+	/** Returns the end of the gun barrel trace, it goes a bit further than the crosshair hit location */
+	static FVector GetBarrelTraceEnd(const FVector& MuzzleLocation, const FVector& BeamEndLocation);
+};
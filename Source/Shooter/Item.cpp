@@ -1,250 +1,408 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-
-#include "Item.h"
-
-#include "ShooterCharacter.h"
-#include "Components/BoxComponent.h"
-#include "Components/WidgetComponent.h"
-#include "Components/SphereComponent.h"
-#include "GameFramework/SpringArmComponent.h"
-
-// Sets default values
-AItem::AItem():
-	ItemName(FString("Default")),
-	ItemCount(0),
-	ItemRarity(EItemRarity::EIR_Common),
-	ItemState(EItemState::EIS_Pickup),
-	// Item pickup interpolation variables
-	ItemInterpStartLocation(FVector(0.f)),
-	ItemInterpCameraTargetLocation(FVector(0.f)),
-	bInterping(false),
-	CurveDuration(0.7f),
-	InterpInitialYawOffset(0.f)
-{
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
-	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ItemMesh"));
-	SetRootComponent(ItemMesh);
-
-	CollisionBox = CreateDefaultSubobject<UBoxComponent>(TEXT("CollisonBox"));
-	CollisionBox -> SetupAttachment(ItemMesh);
-	// Set CollisionBox to ignore all the channels expect ECC_Visibility channel, and block it.
-	CollisionBox -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	CollisionBox -> SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
-
-	PickupWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
-	PickupWidget -> SetupAttachment(ItemMesh);
-
-	AreaSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AreaSphere"));
-	AreaSphere -> SetupAttachment(ItemMesh);
-}
-
-// Called when the game starts or when spawned
-void AItem::BeginPlay()
-{
-	Super::BeginPlay();
-	
-	if(PickupWidget)
-	{
-		// Hide the Pickup widget by default
-		PickupWidget -> SetVisibility(false);
-	}
-	// Set ActiveStars array based on item rarity
-	SetActiveStars();
-	// Setup overlap for AreaSphere
-	AreaSphere -> OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereBeginOverlap);
-	AreaSphere -> OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
-
-	// Set properties for Item's components based on the state
-	UpdateItemProperties(ItemState);
-}
-
-void AItem::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-	int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
-{
-	if(OtherActor)
-	{
-		AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-		if(ShooterCharacter)
-		{
-			ShooterCharacter -> IncrementOverlappedItemCount(1);
-		}
-	}
-}
-
-void AItem::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-	int32 OtherBodyIndex)
-{
-	if(OtherActor)
-	{
-		AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-		if(ShooterCharacter)
-		{
-			ShooterCharacter -> IncrementOverlappedItemCount(-1);
-		}
-	}
-}
-
-void AItem::SetActiveStars()
-{
-	for(int32 i = 0; i <= 5; i++) // Element 0 isn't used.
-		ActiveStars.Add(false);
-	
-	switch(ItemRarity)
-	{
-	case EItemRarity::EIR_Legendary:
-		ActiveStars[5] = true;
-	case EItemRarity::EIR_Rare:
-		ActiveStars[4] = true;
-	case EItemRarity::EIR_Uncommon:
-		ActiveStars[3] = true;
-	case EItemRarity::EIR_Common:
-		ActiveStars[2] = true;
-	case EItemRarity::EIR_Damaged:
-		ActiveStars[1] = true; break;
-	}
-}
-
-void AItem::UpdateItemProperties(EItemState State)
-{
-	switch(State)
-	{
-	case EItemState::EIS_Pickup:
-		ItemMesh -> SetSimulatePhysics(false);
-		ItemMesh -> SetEnableGravity(false);
-		ItemMesh -> SetVisibility(true);
-		ItemMesh -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		CollisionBox -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox -> SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
-		CollisionBox -> SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		AreaSphere -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
-		AreaSphere -> SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		break;
-	case EItemState::EIS_EquipInterp:
-		PickupWidget -> SetVisibility(false);
-		ItemMesh -> SetSimulatePhysics(false);
-		ItemMesh -> SetEnableGravity(false);
-		ItemMesh -> SetVisibility(true);
-		ItemMesh -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		CollisionBox -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		AreaSphere -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_Equipped:
-		PickupWidget -> SetVisibility(false);
-		ItemMesh -> SetSimulatePhysics(false);
-		ItemMesh -> SetEnableGravity(false);
-		ItemMesh -> SetVisibility(true);
-		ItemMesh -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		CollisionBox -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		AreaSphere -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_Falling:
-		ItemMesh -> SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		ItemMesh -> SetSimulatePhysics(true);
-		ItemMesh -> SetEnableGravity(true);
-		ItemMesh -> SetVisibility(true);
-		ItemMesh -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh -> SetCollisionResponseToChannel(ECollisionChannel::ECC_WorldStatic, ECollisionResponse::ECR_Block);
-		CollisionBox -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		AreaSphere -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	}
-}
-
-void AItem::StartAnimCurves(AShooterCharacter* Char)
-{
-	Character = Char; // Store a handle to the Character that picked the item
-	ItemInterpStartLocation = GetActorLocation();
-	bInterping = true;
-	SetItemState(EItemState::EIS_EquipInterp);
-	
-	GetWorldTimerManager().SetTimer(CurveTimer, this, &AItem::FinishAnimCurves, CurveDuration);
-
-	const float CameraYaw = Character -> GetCameraBoom() -> GetComponentRotation().Yaw;
-	const float ItemYaw = GetActorRotation().Yaw;
-	
-	// Offset between camera and item yaw
-	InterpInitialYawOffset = ItemYaw - CameraYaw;
-}
-
-void AItem::FinishAnimCurves()
-{
-	bInterping = false;
-	if(Character)
-	{
-		Character -> PickupItem(this);
-	}
-	if(ItemScaleCurve) SetActorScale3D(FVector(1.f)); // Set scale back to normal
-}
-
-void AItem::PickupInterpHandler(float DeltaTime)
-{
-	if(!bInterping) return;
-	
-	if(Character && ItemZCurve)
-	{
-		const float ElapsedTime = GetWorldTimerManager().GetTimerElapsed(CurveTimer);
-		const float ZCurveValue = ItemZCurve -> GetFloatValue(ElapsedTime);
-
-		FVector ItemCurrentLocation = ItemInterpStartLocation;
-		const FVector TargetInterpLocation{ Character -> GetPickupInterpTargetLocation() };
-
-		// Vector from item to camera, X and Y are zeroed out 
-		const FVector ItemToCameraDeltaZ{ FVector(0.f, 0.f, (TargetInterpLocation - ItemCurrentLocation).Z ) };
-		// Scale factor to multiply with the CurveValue
-		const float DeltaZSize = ItemToCameraDeltaZ.Size();
-
-		const FVector ItemFirstLocation{ GetActorLocation() };
-		const float InterpXValue = FMath::FInterpTo(ItemFirstLocation.X, TargetInterpLocation.X,
-			DeltaTime, 30.f);
-		const float InterpYValue = FMath::FInterpTo(ItemFirstLocation.Y, TargetInterpLocation.Y,
-			DeltaTime, 30.f);
-
-		// Set X and Y location of item to interpolated values
-		ItemCurrentLocation.X = InterpXValue;
-		ItemCurrentLocation.Y = InterpYValue;
-		
-		// Adding to the Z component of item location based on the CurveValue multiplied by DeltaZSize(Scale)
-		ItemCurrentLocation.Z += ZCurveValue * DeltaZSize;
-		SetActorLocation(ItemCurrentLocation, false, nullptr, ETeleportType::TeleportPhysics);
-
-		// Camera's yaw this frame
-		const float CurrentCameraYaw = Character -> GetCameraBoom() -> GetComponentRotation().Yaw;
-		const FRotator ItemRotation{ 0.f, CurrentCameraYaw + InterpInitialYawOffset, 0.f };
-
-		// Keeping the OffsetYaw between the item and camera constant
-		SetActorRotation(ItemRotation, ETeleportType::TeleportPhysics);
-
-		if(ItemScaleCurve) // Applying a ScaleCurve is optional
-		{
-			const float ScaleCurveValue = ItemScaleCurve -> GetFloatValue(ElapsedTime);
-			SetActorScale3D(FVector(ScaleCurveValue));
-		}
-	}
-}
-
-// Called every frame
-void AItem::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-	
-	// Handle item pickup interpolation when (bInterping = true)
-	PickupInterpHandler(DeltaTime);
-}
-
-void AItem::SetItemState(EItemState State)
-{
-	ItemState = State;
-	UpdateItemProperties(State);
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "Item.h"
+
+#include "ShooterCharacter.h"
+#include "ItemInterpSubsystem.h"
+#include "PickupIndexSubsystem.h"
+#include "ShooterReplicationGraph.h"
+#include "ItemPickupWidget.h"
+#include "ItemCollisionSubsystem.h"
+#include "ItemAssetStreamer.h"
+#include "Shooter.h"
+#include "Components/BoxComponent.h"
+#include "Components/WidgetComponent.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "Net/UnrealNetwork.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Item Properties"), STAT_UpdateItemProperties, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Commit Item Properties"), STAT_CommitItemProperties, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ticking Items"), STAT_TickingItems, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Item Pickup Widgets"), STAT_ItemPickupWidgets, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item Physics State Recreations"), STAT_ItemPhysicsStateRecreations, STATGROUP_Shooter);
+
+// Sets default values
+AItem::AItem():
+	ItemName(FString("Default")),
+	ItemCount(0),
+	ItemRarity(EItemRarity::EIR_Common),
+	ItemState(EItemState::EIS_Pickup),
+	CommittedState(EItemState::EIS_Max),
+	// Item pickup interpolation variables
+	ItemInterpStartLocation(FVector(0.f)),
+	ItemInterpCameraTargetLocation(FVector(0.f)),
+	bInterping(false),
+	CurveDuration(0.7f),
+	InterpInitialYawOffset(0.f),
+	PickupWidgetLocation(FVector(0.f)),
+	PickupWidgetDrawSize(FVector2D(0.f)),
+	bSharedPickupWidget(false),
+	bOwnsPickupWidget(false),
+	Significance(EShooterSignificance::ESS_High)
+{
+	// Items don't tick, pickup interpolation is handled by UItemInterpSubsystem
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Loot is placed or dropped once and then sits there, it only replicates when its state changes
+	bReplicates = true;
+	SetReplicatingMovement(true);
+	NetDormancy = ENetDormancy::DORM_Initial;
+
+	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ItemMesh"));
+	SetRootComponent(ItemMesh);
+
+	CollisionBox = CreateDefaultSubobject<UBoxComponent>(TEXT("CollisonBox"));
+	CollisionBox -> SetupAttachment(ItemMesh);
+	// Set CollisionBox to ignore all the channels expect ECC_Visibility channel, and block it.
+	CollisionBox -> SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+	CollisionBox -> SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
+
+	PickupWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
+	PickupWidget -> SetupAttachment(ItemMesh);
+
+	AreaSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AreaSphere"));
+	AreaSphere -> SetupAttachment(ItemMesh);
+	// Only its radius is used, by UPickupIndexSubsystem
+	AreaSphere -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AreaSphere -> SetGenerateOverlapEvents(false);
+}
+
+// Called when the game starts or when spawned
+void AItem::BeginPlay()
+{
+	if(PickupWidget)
+	{
+		PickupWidgetClass = PickupWidget -> GetWidgetClass();
+		PickupWidgetLocation = PickupWidget -> GetRelativeLocation();
+		PickupWidgetDrawSize = PickupWidget -> GetDrawSize();
+
+		// The shared widget can only show items through UItemPickupWidget, other widget classes keep their own
+		bSharedPickupWidget = UItemPickupWidget::IsShared() && PickupWidgetClass &&
+			PickupWidgetClass -> IsChildOf(UItemPickupWidget::StaticClass());
+		if(bSharedPickupWidget || IsRunningDedicatedServer())
+		{
+			// Keep the component for the Blueprints using it, but stop it from creating its widget
+			PickupWidget -> SetWidgetClass(nullptr);
+			PickupWidget -> SetComponentTickEnabled(false);
+		}
+	}
+	Super::BeginPlay();
+
+	if(PickupWidget && PickupWidget -> GetUserWidgetObject())
+	{
+		bOwnsPickupWidget = true;
+		INC_DWORD_STAT(STAT_ItemPickupWidgets);
+	}
+
+	// Items are updated by the subsystems, this catches the Blueprint subclasses that tick anyway
+	if(PrimaryActorTick.bCanEverTick)
+	{
+		INC_DWORD_STAT(STAT_TickingItems);
+	}
+	if(PickupWidget)
+	{
+		// Hide the Pickup widget by default
+		PickupWidget -> SetVisibility(false);
+	}
+	// Set ActiveStars array based on item rarity
+	SetActiveStars();
+
+	UShooterSignificanceSubsystem* SignificanceSubsystem =
+		GetWorld() -> GetSubsystem<UShooterSignificanceSubsystem>();
+	if(SignificanceSubsystem)
+	{
+		SignificanceSubsystem -> RegisterItem(this);
+	}
+
+	// Set properties for Item's components based on the state
+	OnItemStateChanged(ItemState);
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UItemAssetStreamer* AssetStreamer = GetWorld() -> GetSubsystem<UItemAssetStreamer>();
+	if(AssetStreamer)
+	{
+		AssetStreamer -> ReleaseAssets(this);
+	}
+	if(PrimaryActorTick.bCanEverTick)
+	{
+		DEC_DWORD_STAT(STAT_TickingItems);
+	}
+	if(bOwnsPickupWidget)
+	{
+		DEC_DWORD_STAT(STAT_ItemPickupWidgets);
+	}
+	UPickupIndexSubsystem* PickupIndex = GetWorld() -> GetSubsystem<UPickupIndexSubsystem>();
+	if(PickupIndex)
+	{
+		PickupIndex -> RemoveItem(this);
+	}
+	UShooterSignificanceSubsystem* SignificanceSubsystem =
+		GetWorld() -> GetSubsystem<UShooterSignificanceSubsystem>();
+	if(SignificanceSubsystem)
+	{
+		SignificanceSubsystem -> UnregisterItem(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AItem::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AItem, ItemState);
+}
+
+void AItem::OnAcquiredFromPool()
+{
+	SetItemState(EItemState::EIS_Pickup);
+	// The pool turned the component ticks back on, PickupWidget has nothing to draw when it made no widget
+	if(PickupWidget && !bOwnsPickupWidget)
+	{
+		PickupWidget -> SetComponentTickEnabled(false);
+	}
+}
+
+void AItem::OnReleasedToPool()
+{
+	Character = nullptr;
+	bInterping = false;
+	SetItemState(EItemState::EIS_Pooled);
+}
+
+void AItem::SetSignificance(EShooterSignificance NewSignificance)
+{
+	Significance = NewSignificance;
+	const float TickInterval = ItemState == EItemState::EIS_Pickup ?
+		UShooterSignificanceSubsystem::GetTickInterval(Significance) : 0.f;
+	ItemMesh -> SetComponentTickInterval(TickInterval);
+	SetActorTickInterval(TickInterval);
+}
+
+void AItem::SetActiveStars()
+{
+	for(int32 i = 0; i <= 5; i++) // Element 0 isn't used.
+		ActiveStars.Add(false);
+	
+	switch(ItemRarity)
+	{
+	case EItemRarity::EIR_Legendary:
+		ActiveStars[5] = true;
+	case EItemRarity::EIR_Rare:
+		ActiveStars[4] = true;
+	case EItemRarity::EIR_Uncommon:
+		ActiveStars[3] = true;
+	case EItemRarity::EIR_Common:
+		ActiveStars[2] = true;
+	case EItemRarity::EIR_Damaged:
+		ActiveStars[1] = true; break;
+	}
+}
+
+void AItem::UpdateItemProperties(EItemState State)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_UpdateItemProperties);
+
+	if(PickupWidget && (State == EItemState::EIS_EquipInterp || State == EItemState::EIS_Equipped ||
+		State == EItemState::EIS_Pooled))
+	{
+		PickupWidget -> SetVisibility(false);
+	}
+
+	// Collision and physics are committed once at the end of the frame, whatever the number of state changes
+	UItemCollisionSubsystem* ItemCollision = GetWorld() -> GetSubsystem<UItemCollisionSubsystem>();
+	if(ItemCollision && HasActorBegunPlay())
+	{
+		ItemCollision -> QueueCommit(this);
+	}
+	else
+	{
+		CommitItemProperties();
+	}
+}
+
+const FItemStateCollision* AItem::GetStateCollision(EItemState State)
+{
+	// Built once, components only ever switch between these profiles
+	static const TArray<FItemStateCollision> StateCollisions = []()
+	{
+		FCollisionResponseContainer IgnoreAll;
+		IgnoreAll.SetAllChannels(ECollisionResponse::ECR_Ignore);
+		FCollisionResponseContainer BlockVisibility{ IgnoreAll };
+		BlockVisibility.SetResponse(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
+		FCollisionResponseContainer BlockWorldStatic{ IgnoreAll };
+		BlockWorldStatic.SetResponse(ECollisionChannel::ECC_WorldStatic, ECollisionResponse::ECR_Block);
+
+		const FItemComponentCollision NoCollision{ ECollisionEnabled::NoCollision, IgnoreAll };
+
+		TArray<FItemStateCollision> Collisions;
+		Collisions.SetNum(static_cast<int32>(EItemState::EIS_Max));
+		for(FItemStateCollision& Collision : Collisions)
+		{
+			Collision = { NoCollision, NoCollision, NoCollision, false, false, true };
+		}
+		// Traces from the character hit the CollisionBox
+		Collisions[static_cast<int32>(EItemState::EIS_Pickup)].CollisionBox =
+			{ ECollisionEnabled::QueryAndPhysics, BlockVisibility };
+		// The mesh falls until it lands on the world
+		FItemStateCollision& Falling = Collisions[static_cast<int32>(EItemState::EIS_Falling)];
+		Falling.ItemMesh = { ECollisionEnabled::QueryAndPhysics, BlockWorldStatic };
+		Falling.bSimulatePhysics = true;
+		Falling.bEnableGravity = true;
+		// Picked up items keep whatever they had
+		Collisions[static_cast<int32>(EItemState::EIS_PickedUp)].bApply = false;
+		return Collisions;
+	}();
+	return StateCollisions.IsValidIndex(static_cast<int32>(State)) ? &StateCollisions[static_cast<int32>(State)] : nullptr;
+}
+
+void AItem::CommitItemProperties()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_CommitItemProperties);
+
+	if(ItemState == CommittedState) return;
+	const FItemStateCollision* Collision = GetStateCollision(ItemState);
+	if(Collision == nullptr || !Collision -> bApply) return;
+	CommittedState = ItemState;
+
+	// Stop simulating before the collision changes, start after, so a body is never simulated without collision
+	if(!Collision -> bSimulatePhysics)
+	{
+		SetSimulatePhysicsIfChanged(ItemMesh, false);
+	}
+	ApplyComponentCollision(ItemMesh, Collision -> ItemMesh);
+	ApplyComponentCollision(CollisionBox, Collision -> CollisionBox);
+	ApplyComponentCollision(AreaSphere, Collision -> AreaSphere);
+	if(ItemMesh -> IsGravityEnabled() != Collision -> bEnableGravity)
+	{
+		ItemMesh -> SetEnableGravity(Collision -> bEnableGravity);
+	}
+	if(Collision -> bSimulatePhysics)
+	{
+		SetSimulatePhysicsIfChanged(ItemMesh, true);
+	}
+	ItemMesh -> SetVisibility(true);
+}
+
+void AItem::ApplyComponentCollision(UPrimitiveComponent* Component, const FItemComponentCollision& Collision)
+{
+	// One filter update for all the channels, instead of one per SetCollisionResponseToChannel
+	if(!(Component -> GetCollisionResponseToChannels() == Collision.Responses))
+	{
+		Component -> SetCollisionResponseToChannels(Collision.Responses);
+	}
+	if(Component -> GetCollisionEnabled() != Collision.CollisionEnabled)
+	{
+		// Turning collision on or off creates or destroys the body
+		if(Component -> GetCollisionEnabled() == ECollisionEnabled::NoCollision ||
+			Collision.CollisionEnabled == ECollisionEnabled::NoCollision)
+		{
+			INC_DWORD_STAT(STAT_ItemPhysicsStateRecreations);
+		}
+		Component -> SetCollisionEnabled(Collision.CollisionEnabled);
+	}
+}
+
+void AItem::SetSimulatePhysicsIfChanged(UPrimitiveComponent* Component, bool bSimulate)
+{
+	if(Component -> IsSimulatingPhysics() == bSimulate) return;
+	INC_DWORD_STAT(STAT_ItemPhysicsStateRecreations);
+	Component -> SetSimulatePhysics(bSimulate);
+}
+
+void AItem::StartAnimCurves(AShooterCharacter* Char)
+{
+	Character = Char; // Store a handle to the Character that picked the item
+	ItemInterpStartLocation = GetActorLocation();
+	bInterping = true;
+	SetItemState(EItemState::EIS_EquipInterp);
+
+	const float CameraYaw = Character -> GetCameraBoom() -> GetComponentRotation().Yaw;
+	const float ItemYaw = GetActorRotation().Yaw;
+	
+	// Offset between camera and item yaw
+	InterpInitialYawOffset = ItemYaw - CameraYaw;
+
+	// The curves are usually streamed in already, the character has been standing next to the item.
+	// If not, UItemInterpSubsystem interpolates linearly until they are
+	UItemAssetStreamer* AssetStreamer = GetWorld() -> GetSubsystem<UItemAssetStreamer>();
+	if(AssetStreamer)
+	{
+		AssetStreamer -> RequestItemAssets(this);
+	}
+
+	UItemInterpSubsystem* ItemInterpSubsystem = GetWorld() -> GetSubsystem<UItemInterpSubsystem>();
+	if(ItemInterpSubsystem)
+	{
+		ItemInterpSubsystem -> StartInterp(this, Character);
+	}
+}
+
+void AItem::GetStreamedAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Add(ItemZCurve.ToSoftObjectPath());
+	OutPaths.Add(ItemScaleCurve.ToSoftObjectPath());
+	OutPaths.Add(PickupSound.ToSoftObjectPath());
+	OutPaths.Add(EquipSound.ToSoftObjectPath());
+}
+
+void AItem::FinishAnimCurves()
+{
+	bInterping = false;
+	if(Character)
+	{
+		Character -> PickupItem(this);
+	}
+	if(!ItemScaleCurve.IsNull()) SetActorScale3D(FVector(1.f)); // Set scale back to normal
+}
+
+void AItem::SetItemState(EItemState State)
+{
+	const EItemState OldState = ItemState;
+	ItemState = State;
+	OnItemStateChanged(OldState);
+}
+
+void AItem::OnRep_ItemState(EItemState OldState)
+{
+	OnItemStateChanged(OldState);
+}
+
+void AItem::OnItemStateChanged(EItemState OldState)
+{
+	UpdateItemProperties(ItemState);
+	// Held and falling items tick every frame whatever their significance
+	SetSignificance(Significance);
+
+	// Let characters find the item if it can be picked up
+	UPickupIndexSubsystem* PickupIndex = GetWorld() -> GetSubsystem<UPickupIndexSubsystem>();
+	if(PickupIndex)
+	{
+		PickupIndex -> UpdateItem(this);
+	}
+
+	if(HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		// Items waiting to be picked up or in the pool don't change, they go dormant once the new state is sent.
+		// Any other state wakes them up, they move or follow their owner.
+		if(ItemState == EItemState::EIS_Pickup || ItemState == EItemState::EIS_Pooled)
+		{
+			// Going from one dormant state to the other, the new state and location still have to reach the clients
+			if(OldState == EItemState::EIS_Pickup || OldState == EItemState::EIS_Pooled)
+			{
+				FlushNetDormancy();
+			}
+			SetNetDormancy(ENetDormancy::DORM_DormantAll);
+		}
+		else
+		{
+			SetNetDormancy(ENetDormancy::DORM_Awake);
+			ForceNetUpdate();
+		}
+		UShooterReplicationGraph::NotifyItemStateChanged(this, OldState);
+	}
 }
\ No newline at end of file
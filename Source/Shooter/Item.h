@@ -1,167 +1,246 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/Actor.h"
-#include "Item.generated.h"
-
-UENUM(BlueprintType)
-enum class EItemRarity : uint8
-{
-	EIR_Damaged UMETA(DisplayName = "Damaged"),
-	EIR_Common UMETA(DisplayName = "Common"),
-	EIR_Uncommon UMETA(DisplayName = "Uncommon"),
-	EIR_Rare UMETA(DisplayName = "Rare"),
-	EIR_Legendary UMETA(DisplayName = "Legendary"),
-
-	EIR_Max UMETA(DisplayName = "DefaultMax")
-};
-
-UENUM(BlueprintType)
-enum class EItemState : uint8
-{
-	EIS_Pickup UMETA(DisplayName = "Pickup"),
-	EIS_EquipInterp UMETA(DisplayName = "EquipInterp"),
-	EIS_PickedUp UMETA(DisplayName = "PickedUp"),
-	EIS_Equipped UMETA(DisplayName = "Equipped"),
-	EIS_Falling UMETA(DisplayName = "Falling"),
-	
-	EIS_Max UMETA(DisplayName = "DefaultMax")
-};
-
-UCLASS()
-class SHOOTER_API AItem : public AActor
-{
-	GENERATED_BODY()
-	
-public:	
-	// Set default values for this actor's properties
-	AItem();
-
-protected:
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
-
-	/** Called when overlapping AreaSphere */
-	UFUNCTION()
-	void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult);
-
-	/** Called when overlapping AreaSphere ends */
-	UFUNCTION()
-	void OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex);
-
-	/** Set the ActiveStars array of bools based on the rarity */
-	void SetActiveStars();
-
-	/** Set properties for Item's components based on State */
-	void UpdateItemProperties(EItemState State);
-
-	/** Called when Curves are finished */
-	void FinishAnimCurves();
-
-	/** Handle item pickup interpolation when (bInterping = true) */
-	void PickupInterpHandler(float DeltaTime);
-	
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
-private:
-	/** Skeletal mesh for the item */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	USkeletalMeshComponent* ItemMesh;
-	
-	/** Collision box for line tracing */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	class UBoxComponent* CollisionBox;
-
-	/** Widget to show when player is looking at the item */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	class UWidgetComponent* PickupWidget;
-
-	/** Sphere to calculate overlaps when you are close to the item */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	class USphereComponent* AreaSphere;
-
-	/** The name which appears on the Pickup widget */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	FString ItemName;
-
-	/** Item count (ammo, ect.) */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	int32 ItemCount;
-
-	/** Item rarity - determines number of stars in Pickup widget */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	EItemRarity ItemRarity;
-
-	/** Shown stars in Pickup widget */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	TArray<bool> ActiveStars;
-
-	/** AItem states for interactions */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	EItemState ItemState;
-
-	/** The curve asset to use for item's z location when interpolating */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	class UCurveFloat* ItemZCurve;
-
-	/** The location item starts interpolating for pickup */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	FVector ItemInterpStartLocation;
-
-	/** The location item finished interpolation for pickup */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	FVector ItemInterpCameraTargetLocation;
-	
-	/** True when interpolating */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	bool bInterping;
-
-	/** Timer to handle item pickup interpolation */
-	FTimerHandle CurveTimer;
-	
-	/** The point in timeline where curves stop */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	float CurveDuration;
-	
-	/** Reference to AShooterCharacter to access its public functions */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	class AShooterCharacter* Character;
-
-	/** Initial yaw offset between the camera yaw and item yaw once the item is picked up*/
-	float InterpInitialYawOffset;
-
-	/** The curve asset to use for item's scale when interpolating (optional) */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	UCurveFloat* ItemScaleCurve;
-
-	/** Sound to play when picking item */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	class USoundCue* PickupSound;
-
-	/** Sound to play when equipping item */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	USoundCue* EquipSound;
-	
-public:	
-	FORCEINLINE UWidgetComponent* GetPickupWidget() const { return PickupWidget; }
-	FORCEINLINE UBoxComponent* GetCollisionBox() const { return CollisionBox; }
-	FORCEINLINE USphereComponent* GetAreaSphere() const { return AreaSphere; }
-	FORCEINLINE EItemState GetItemState() const { return ItemState; }
-	FORCEINLINE USkeletalMeshComponent* GetItemMesh() const { return ItemMesh; }
-	FORCEINLINE USoundCue* GetPickupSound() const { return PickupSound; }
-	FORCEINLINE USoundCue* GetEquipSound() const { return EquipSound; }
-	
-	/** Set new state for ItemState and calls UpdateItemProperties() */
-	void SetItemState(EItemState State);
-	
-	/** Play CurveTimer and call PickupInterpHandler() every frame
-	 *	to handle pickup interpolation based on the curve values
-	 *	@param Char This is a pointer to the player who is picking up the item */
-	void StartAnimCurves(AShooterCharacter* Char);
-};
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ActorPoolSubsystem.h"
+#include "ShooterSignificanceSubsystem.h"
+#include "Item.generated.h"
+
+UENUM(BlueprintType)
+enum class EItemRarity : uint8
+{
+	EIR_Damaged UMETA(DisplayName = "Damaged"),
+	EIR_Common UMETA(DisplayName = "Common"),
+	EIR_Uncommon UMETA(DisplayName = "Uncommon"),
+	EIR_Rare UMETA(DisplayName = "Rare"),
+	EIR_Legendary UMETA(DisplayName = "Legendary"),
+
+	EIR_Max UMETA(DisplayName = "DefaultMax")
+};
+
+UENUM(BlueprintType)
+enum class EItemState : uint8
+{
+	EIS_Pickup UMETA(DisplayName = "Pickup"),
+	EIS_EquipInterp UMETA(DisplayName = "EquipInterp"),
+	EIS_PickedUp UMETA(DisplayName = "PickedUp"),
+	EIS_Equipped UMETA(DisplayName = "Equipped"),
+	EIS_Falling UMETA(DisplayName = "Falling"),
+	EIS_Pooled UMETA(DisplayName = "Pooled"),
+	
+	EIS_Max UMETA(DisplayName = "DefaultMax")
+};
+
+/** Collision of one of the item's components in a given state */
+struct FItemComponentCollision
+{
+	ECollisionEnabled::Type CollisionEnabled;
+	FCollisionResponseContainer Responses;
+};
+
+/** Collision and physics of the item's components in a given state, see AItem::GetStateCollision */
+struct FItemStateCollision
+{
+	FItemComponentCollision ItemMesh;
+	FItemComponentCollision CollisionBox;
+	FItemComponentCollision AreaSphere;
+	bool bSimulatePhysics;
+	bool bEnableGravity;
+
+	/** False for states that keep the collision of the previous state */
+	bool bApply;
+};
+
+UCLASS()
+class SHOOTER_API AItem : public AActor, public IPooledActor
+{
+	GENERATED_BODY()
+	
+public:	
+	// Set default values for this actor's properties
+	AItem();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the item is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Back to Pickup, waiting at its new location */
+	virtual void OnAcquiredFromPool() override;
+
+	/** Hidden and without collision in the Pooled state */
+	virtual void OnReleasedToPool() override;
+
+	/** Set the ActiveStars array of bools based on the rarity */
+	void SetActiveStars();
+
+	/** Set properties for Item's components based on State, collision and physics are queued in UItemCollisionSubsystem */
+	void UpdateItemProperties(EItemState State);
+
+	/** Returns the collision profile of State, built once for all items */
+	static const FItemStateCollision* GetStateCollision(EItemState State);
+
+	/** Apply a component's collision profile, skipping the setters that wouldn't change anything */
+	static void ApplyComponentCollision(UPrimitiveComponent* Component, const FItemComponentCollision& Collision);
+
+	static void SetSimulatePhysicsIfChanged(UPrimitiveComponent* Component, bool bSimulate);
+
+	/** Called on clients when the server changes ItemState */
+	UFUNCTION()
+	void OnRep_ItemState(EItemState OldState);
+
+	/** Apply a new ItemState: components, pickup index, and on servers dormancy and replication routing */
+	void OnItemStateChanged(EItemState OldState);
+
+private:
+	/** Skeletal mesh for the item */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	USkeletalMeshComponent* ItemMesh;
+	
+	/** Collision box for line tracing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	class UBoxComponent* CollisionBox;
+
+	/** Widget to show when player is looking at the item. When the pickup widget is shared (see
+	 *	UItemPickupWidget::IsShared) it creates no widget, its settings are kept for the shared widget */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	class UWidgetComponent* PickupWidget;
+
+	/** Widget class of PickupWidget */
+	TSubclassOf<class UUserWidget> PickupWidgetClass;
+
+	/** Location of PickupWidget relative to the item */
+	FVector PickupWidgetLocation;
+
+	/** Draw size of PickupWidget */
+	FVector2D PickupWidgetDrawSize;
+
+	/** True if the local players' shared pickup widget shows this item instead of PickupWidget */
+	bool bSharedPickupWidget;
+
+	/** True if PickupWidget created its own widget */
+	bool bOwnsPickupWidget;
+
+	/** Significance to the local views, set by UShooterSignificanceSubsystem */
+	EShooterSignificance Significance;
+
+	/** Characters inside this sphere consider the item for pickup (see UPickupIndexSubsystem), it has no collision */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	class USphereComponent* AreaSphere;
+
+	/** The name which appears on the Pickup widget */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	FString ItemName;
+
+	/** Item count (ammo, ect.) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	int32 ItemCount;
+
+	/** Item rarity - determines number of stars in Pickup widget */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	EItemRarity ItemRarity;
+
+	/** Shown stars in Pickup widget */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	TArray<bool> ActiveStars;
+
+	/** AItem states for interactions */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_ItemState, Category = "Item Properties",
+		meta = (AllowPrivateAccess = "true"))
+	EItemState ItemState;
+
+	/** State whose collision profile was last applied to the components */
+	EItemState CommittedState;
+
+	/** The curve asset to use for item's z location when interpolating, streamed in by UItemAssetStreamer */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<class UCurveFloat> ItemZCurve;
+
+	/** The location item starts interpolating for pickup */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	FVector ItemInterpStartLocation;
+
+	/** The location item finished interpolation for pickup */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	FVector ItemInterpCameraTargetLocation;
+	
+	/** True when interpolating */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	bool bInterping;
+
+	/** The point in timeline where curves stop */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	float CurveDuration;
+	
+	/** Reference to AShooterCharacter to access its public functions */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	class AShooterCharacter* Character;
+
+	/** Initial yaw offset between the camera yaw and item yaw once the item is picked up*/
+	float InterpInitialYawOffset;
+
+	/** The curve asset to use for item's scale when interpolating (optional) */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UCurveFloat> ItemScaleCurve;
+
+	/** Sound to play when picking item */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<class USoundCue> PickupSound;
+
+	/** Sound to play when equipping item */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<USoundCue> EquipSound;
+	
+public:	
+	FORCEINLINE UWidgetComponent* GetPickupWidget() const { return PickupWidget; }
+	FORCEINLINE TSubclassOf<UUserWidget> GetPickupWidgetClass() const { return PickupWidgetClass; }
+	FORCEINLINE const FVector& GetPickupWidgetLocation() const { return PickupWidgetLocation; }
+	FORCEINLINE FVector2D GetPickupWidgetDrawSize() const { return PickupWidgetDrawSize; }
+	FORCEINLINE bool UsesSharedPickupWidget() const { return bSharedPickupWidget; }
+	FORCEINLINE const FString& GetItemName() const { return ItemName; }
+	FORCEINLINE int32 GetItemCount() const { return ItemCount; }
+	FORCEINLINE const TArray<bool>& GetActiveStars() const { return ActiveStars; }
+	FORCEINLINE UBoxComponent* GetCollisionBox() const { return CollisionBox; }
+	FORCEINLINE USphereComponent* GetAreaSphere() const { return AreaSphere; }
+	FORCEINLINE EItemState GetItemState() const { return ItemState; }
+	FORCEINLINE USkeletalMeshComponent* GetItemMesh() const { return ItemMesh; }
+	FORCEINLINE EShooterSignificance GetSignificance() const { return Significance; }
+	/** Tick ItemMesh less often the less significant the item is, while it waits for pickup */
+	void SetSignificance(EShooterSignificance NewSignificance);
+	/** The soft referenced assets return null until they are streamed in */
+	FORCEINLINE USoundCue* GetPickupSound() const { return PickupSound.Get(); }
+	FORCEINLINE USoundCue* GetEquipSound() const { return EquipSound.Get(); }
+	FORCEINLINE UCurveFloat* GetItemZCurve() const { return ItemZCurve.Get(); }
+	FORCEINLINE UCurveFloat* GetItemScaleCurve() const { return ItemScaleCurve.Get(); }
+	/** True once every curve the item has is streamed in */
+	FORCEINLINE bool AreAnimCurvesLoaded() const
+	{
+		return (ItemZCurve.IsNull() || ItemZCurve.IsValid()) && (ItemScaleCurve.IsNull() || ItemScaleCurve.IsValid());
+	}
+
+	/** Add the soft referenced assets of the item to OutPaths */
+	virtual void GetStreamedAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+	FORCEINLINE float GetCurveDuration() const { return CurveDuration; }
+	FORCEINLINE FVector GetItemInterpStartLocation() const { return ItemInterpStartLocation; }
+	FORCEINLINE float GetInterpInitialYawOffset() const { return InterpInitialYawOffset; }
+	
+	/** Set new state for ItemState and calls UpdateItemProperties() */
+	void SetItemState(EItemState State);
+	
+	/** Hand the item to UItemInterpSubsystem, which handles pickup interpolation
+	 *	based on the curve values every frame
+	 *	@param Char This is a pointer to the player who is picking up the item */
+	void StartAnimCurves(AShooterCharacter* Char);
+
+	/** Apply the collision profile of ItemState to the components, called by UItemCollisionSubsystem */
+	void CommitItemProperties();
+
+	/** Called by UItemInterpSubsystem when Curves are finished */
+	void FinishAnimCurves();
+};
@@ -0,0 +1,228 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ItemAssetStreamer.h"
+
+#include "Shooter.h"
+#include "Item.h"
+#include "ShooterCharacter.h"
+#include "PickupIndexSubsystem.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Asset Stream Requests"), STAT_AssetStreamRequests, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Asset Stream Handles"), STAT_AssetStreamHandles, STATGROUP_Shooter);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Asset Stream Load Time (ms)"), STAT_AssetStreamLoadTime, STATGROUP_Shooter);
+DECLARE_MEMORY_STAT(TEXT("Streamed Asset Memory"), STAT_StreamedAssetMemory, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarStreamingItemRadius(
+	TEXT("Shooter.Streaming.ItemRadius"),
+	3000.f,
+	TEXT("Items closer than this to a local player have their curves and sounds streamed in.\n")
+	TEXT("They are released once they are 25% further away."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarStreamingProximityInterval(
+	TEXT("Shooter.Streaming.ProximityInterval"),
+	0.5f,
+	TEXT("Seconds between two searches for the items around the local players."),
+	ECVF_Default);
+
+UItemAssetStreamer::UItemAssetStreamer():
+	ProximityCountdown(0.f)
+{
+
+}
+
+bool UItemAssetStreamer::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UItemAssetStreamer::Deinitialize()
+{
+	for(const TPair<TWeakObjectPtr<UObject>, TSharedPtr<FStreamableHandle>>& Pair : Handles)
+	{
+		OnHandleReleased(Pair.Value);
+		Pair.Value -> ReleaseHandle();
+	}
+	DEC_DWORD_STAT_BY(STAT_AssetStreamHandles, Handles.Num());
+	Handles.Empty();
+
+	Super::Deinitialize();
+}
+
+void UItemAssetStreamer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ProximityCountdown -= DeltaTime;
+	if(ProximityCountdown <= 0.f)
+	{
+		ProximityCountdown = CVarStreamingProximityInterval.GetValueOnGameThread();
+		UpdateProximity();
+	}
+}
+
+bool UItemAssetStreamer::IsTickable() const
+{
+	// Only local players look at items
+	return GetWorld() -> GetNetMode() != NM_DedicatedServer;
+}
+
+TStatId UItemAssetStreamer::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemAssetStreamer, STATGROUP_Tickables);
+}
+
+void UItemAssetStreamer::RequestItemAssets(AItem* Item)
+{
+	if(Item == nullptr || Handles.Contains(Item)) return;
+
+	TArray<FSoftObjectPath> Paths;
+	Item -> GetStreamedAssetPaths(Paths);
+	RequestAssets(Item, MoveTemp(Paths));
+}
+
+void UItemAssetStreamer::RequestCharacterAssets(AShooterCharacter* Character)
+{
+	if(Character == nullptr) return;
+
+	TArray<FSoftObjectPath> Paths;
+	Character -> GetCombatAssetPaths(Paths);
+	RequestAssets(Character, MoveTemp(Paths),
+		FStreamableDelegate::CreateUObject(Character, &AShooterCharacter::OnCombatAssetsLoaded));
+}
+
+void UItemAssetStreamer::ReleaseAssets(UObject* Requester)
+{
+	TSharedPtr<FStreamableHandle> Handle;
+	if(Handles.RemoveAndCopyValue(Requester, Handle))
+	{
+		OnHandleReleased(Handle);
+		Handle -> ReleaseHandle();
+		DEC_DWORD_STAT(STAT_AssetStreamHandles);
+	}
+}
+
+TSharedPtr<FStreamableHandle> UItemAssetStreamer::RequestAssets(UObject* Requester, TArray<FSoftObjectPath>&& Paths,
+	FStreamableDelegate OnLoaded)
+{
+	ReleaseAssets(Requester);
+
+	Paths.RemoveAll([](const FSoftObjectPath& Path) { return Path.IsNull(); });
+	if(Paths.Num() == 0)
+	{
+		OnLoaded.ExecuteIfBound();
+		return nullptr;
+	}
+
+	INC_DWORD_STAT(STAT_AssetStreamRequests);
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(MoveTemp(Paths));
+	if(!Handle.IsValid())
+	{
+		OnLoaded.ExecuteIfBound();
+		return nullptr;
+	}
+	Handles.Add(Requester, Handle);
+	INC_DWORD_STAT(STAT_AssetStreamHandles);
+
+	const double RequestTime = FPlatformTime::Seconds();
+	const TWeakPtr<FStreamableHandle> WeakHandle{ Handle };
+	auto OnComplete = [this, WeakHandle, RequestTime, OnLoaded]()
+	{
+		if(TSharedPtr<FStreamableHandle> LoadedHandle = WeakHandle.Pin())
+		{
+			OnHandleLoaded(LoadedHandle, RequestTime);
+		}
+		OnLoaded.ExecuteIfBound();
+	};
+	// Assets already in memory complete right away
+	if(Handle -> HasLoadCompleted() ||
+		!Handle -> BindCompleteDelegate(FStreamableDelegate::CreateWeakLambda(this, OnComplete)))
+	{
+		OnComplete();
+	}
+	return Handle;
+}
+
+void UItemAssetStreamer::OnHandleLoaded(TSharedPtr<FStreamableHandle> Handle, double RequestTime)
+{
+	SET_FLOAT_STAT(STAT_AssetStreamLoadTime, (FPlatformTime::Seconds() - RequestTime) * 1000.0);
+	if(Handle -> WasCanceled() || CountedHandles.Contains(Handle.Get())) return;
+	CountedHandles.Add(Handle.Get());
+
+	TArray<FSoftObjectPath> Paths;
+	Handle -> GetRequestedAssets(Paths);
+	for(const FSoftObjectPath& Path : Paths)
+	{
+		FAssetUsage& Usage = AssetUsages.FindOrAdd(Path, FAssetUsage{ 0, 0 });
+		if(Usage.NumHandles++ == 0)
+		{
+			const UObject* Asset = Path.ResolveObject();
+			Usage.Bytes = Asset ? Asset -> GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) : 0;
+			INC_MEMORY_STAT_BY(STAT_StreamedAssetMemory, Usage.Bytes);
+		}
+	}
+}
+
+void UItemAssetStreamer::OnHandleReleased(const TSharedPtr<FStreamableHandle>& Handle)
+{
+	if(CountedHandles.Remove(Handle.Get()) == 0) return;
+
+	TArray<FSoftObjectPath> Paths;
+	Handle -> GetRequestedAssets(Paths);
+	for(const FSoftObjectPath& Path : Paths)
+	{
+		FAssetUsage* Usage = AssetUsages.Find(Path);
+		if(Usage && --Usage -> NumHandles == 0)
+		{
+			DEC_MEMORY_STAT_BY(STAT_StreamedAssetMemory, Usage -> Bytes);
+			AssetUsages.Remove(Path);
+		}
+	}
+}
+
+void UItemAssetStreamer::UpdateProximity()
+{
+	const UPickupIndexSubsystem* PickupIndex = GetWorld() -> GetSubsystem<UPickupIndexSubsystem>();
+	if(PickupIndex == nullptr) return;
+
+	const float StreamInRadius = CVarStreamingItemRadius.GetValueOnGameThread();
+	const float ReleaseRadius = StreamInRadius * 1.25f;
+
+	// Items within ReleaseRadius keep their assets, the ones within StreamInRadius get them
+	NearbyItems.Reset();
+	for(FConstPlayerControllerIterator Iterator = GetWorld() -> GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator -> Get();
+		const APawn* Pawn = PlayerController ? PlayerController -> GetPawn() : nullptr;
+		if(Pawn == nullptr || !PlayerController -> IsLocalController()) continue;
+
+		const int32 FirstItem = NearbyItems.Num();
+		PickupIndex -> GatherItems(Pawn -> GetActorLocation(), ReleaseRadius, NearbyItems);
+		for(int32 Index = FirstItem; Index < NearbyItems.Num(); Index++)
+		{
+			if(FVector::DistSquared(NearbyItems[Index] -> GetActorLocation(), Pawn -> GetActorLocation()) <=
+				FMath::Square(StreamInRadius))
+			{
+				RequestItemAssets(NearbyItems[Index]);
+			}
+		}
+	}
+
+	// Release items left behind, unless a character is holding them
+	NearbyItemSet.Reset();
+	NearbyItemSet.Append(NearbyItems);
+	for(auto Iterator = Handles.CreateIterator(); Iterator; ++Iterator)
+	{
+		const AItem* Item = Cast<AItem>(Iterator -> Key.Get());
+		if(Iterator -> Key.IsValid() && (Item == nullptr || NearbyItemSet.Contains(Item) ||
+			(Item -> GetItemState() != EItemState::EIS_Pickup &&
+			Item -> GetItemState() != EItemState::EIS_Pooled))) continue;
+
+		OnHandleReleased(Iterator -> Value);
+		Iterator -> Value -> ReleaseHandle();
+		Iterator.RemoveCurrent();
+		DEC_DWORD_STAT(STAT_AssetStreamHandles);
+	}
+}
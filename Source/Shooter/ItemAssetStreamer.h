@@ -0,0 +1,84 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "ItemAssetStreamer.generated.h"
+
+class AItem;
+class AShooterCharacter;
+
+/**
+ * Streams in the soft referenced assets of items and characters, and releases them once they aren't needed.
+ * Items are requested by proximity to the local players (Shooter.Streaming.ItemRadius) or by need when they are
+ * picked up, characters request their combat assets when they begin play, UActorPoolSubsystem the classes it
+ * prewarms. Every requester holds a streamable handle, assets shared by several requesters stay loaded until the last
+ * handle is released.
+ */
+UCLASS()
+class SHOOTER_API UItemAssetStreamer : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UItemAssetStreamer();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Stream in the curves and sounds of Item */
+	void RequestItemAssets(AItem* Item);
+
+	/** Stream in the combat assets of Character, calls Character's OnCombatAssetsLoaded once they are loaded */
+	void RequestCharacterAssets(AShooterCharacter* Character);
+
+	/** Request Paths for Requester, replacing any handle it had. OnLoaded is called once they are loaded, right away
+	 *	if they are in memory already */
+	TSharedPtr<FStreamableHandle> RequestAssets(UObject* Requester, TArray<FSoftObjectPath>&& Paths,
+		FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	/** Release the assets requested for Requester, they unload once nothing else holds them */
+	void ReleaseAssets(UObject* Requester);
+
+	FORCEINLINE int32 GetNumHandles() const { return Handles.Num(); }
+
+private:
+	/** Count the memory of the assets a handle just loaded */
+	void OnHandleLoaded(TSharedPtr<FStreamableHandle> Handle, double RequestTime);
+
+	/** Drop the memory of a handle's assets once the last handle holding them is released */
+	void OnHandleReleased(const TSharedPtr<FStreamableHandle>& Handle);
+
+	/** Request the items around the local players, release the ones left behind */
+	void UpdateProximity();
+
+	FStreamableManager StreamableManager;
+
+	/** Handles by requester */
+	TMap<TWeakObjectPtr<UObject>, TSharedPtr<FStreamableHandle>> Handles;
+
+	/** Handles whose assets are counted in AssetUsages */
+	TSet<const FStreamableHandle*> CountedHandles;
+
+	/** Number of handles holding each loaded asset, and its size */
+	struct FAssetUsage
+	{
+		int32 NumHandles;
+		SIZE_T Bytes;
+	};
+	TMap<FSoftObjectPath, FAssetUsage> AssetUsages;
+
+	/** Items around the local players, reused every proximity update */
+	TArray<AItem*> NearbyItems;
+
+	/** NearbyItems as a set, to release the handles of the other items */
+	TSet<const AItem*> NearbyItemSet;
+
+	/** Time left until the next proximity update */
+	float ProximityCountdown;
+};
@@ -0,0 +1,54 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ItemCollisionSubsystem.h"
+
+#include "Shooter.h"
+#include "Item.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item Collision Commits"), STAT_ItemCollisionCommits, STATGROUP_Shooter);
+
+bool UItemCollisionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UItemCollisionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	INC_DWORD_STAT_BY(STAT_ItemCollisionCommits, PendingItems.Num());
+	for(const TWeakObjectPtr<AItem>& Item : PendingItems)
+	{
+		if(Item.IsValid())
+		{
+			Item -> CommitItemProperties();
+		}
+	}
+	PendingItems.Reset();
+}
+
+bool UItemCollisionSubsystem::IsTickable() const
+{
+	return PendingItems.Num() > 0;
+}
+
+TStatId UItemCollisionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemCollisionSubsystem, STATGROUP_Tickables);
+}
+
+void UItemCollisionSubsystem::QueueCommit(AItem* Item)
+{
+	PendingItems.AddUnique(Item);
+}
+
+void UItemCollisionSubsystem::FlushCommit(AItem* Item)
+{
+	if(PendingItems.RemoveSwap(Item) > 0)
+	{
+		INC_DWORD_STAT(STAT_ItemCollisionCommits);
+		Item -> CommitItemProperties();
+	}
+}
@@ -0,0 +1,36 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemCollisionSubsystem.generated.h"
+
+class AItem;
+
+/**
+ * Applies the collision profile of items' states once per frame.
+ * AItem::SetItemState only queues the item, so an item changing state several times in a frame
+ * (drop, swap, pick up) ends up with a single commit of the final state per component.
+ */
+UCLASS()
+class SHOOTER_API UItemCollisionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Commit Item's collision profile at the end of the frame */
+	void QueueCommit(AItem* Item);
+
+	/** Commit Item's collision profile now, for callers that need its physics right away */
+	void FlushCommit(AItem* Item);
+
+private:
+	/** Items waiting for their collision profile, each item is queued once */
+	TArray<TWeakObjectPtr<AItem>> PendingItems;
+};
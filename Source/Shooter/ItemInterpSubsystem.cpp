@@ -0,0 +1,139 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ItemInterpSubsystem.h"
+
+#include "Shooter.h"
+#include "Item.h"
+#include "ShooterCharacter.h"
+#include "Curves/CurveFloat.h"
+#include "GameFramework/SpringArmComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Interp Update"), STAT_ItemInterpUpdate, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interping Items"), STAT_InterpingItems, STATGROUP_Shooter);
+
+bool UItemInterpSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UItemInterpSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ItemInterpUpdate);
+	CSV_SCOPED_TIMING_STAT(Shooter, ItemInterpTick);
+
+	SET_DWORD_STAT(STAT_InterpingItems, Entries.Num());
+
+	for(int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+	{
+		FItemInterpEntry& Entry = Entries[Index];
+		Entry.ElapsedTime += DeltaTime;
+
+		AItem* Item = Entry.Item.Get();
+		if(Item == nullptr)
+		{
+			Entries.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+		if(Entry.ElapsedTime >= Entry.Duration)
+		{
+			FinishedItems.Add(Item);
+			Entries.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if(!Entry.bCurvesLoaded && Item -> AreAnimCurvesLoaded())
+		{
+			Entry.ZCurve = Item -> GetItemZCurve();
+			Entry.ScaleCurve = Item -> GetItemScaleCurve();
+			Entry.bCurvesLoaded = true;
+		}
+
+		AShooterCharacter* Character = Entry.Character.Get();
+		if(Character && (Entry.ZCurve || !Entry.bCurvesLoaded))
+		{
+			UpdateEntry(Entry, Item, Character, DeltaTime);
+		}
+	}
+
+	// Finishing can hand the item to the character, do it once we are done with Entries
+	for(AItem* Item : FinishedItems)
+	{
+		Item -> FinishAnimCurves();
+	}
+	FinishedItems.Reset();
+}
+
+bool UItemInterpSubsystem::IsTickable() const
+{
+	return Entries.Num() > 0;
+}
+
+TStatId UItemInterpSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemInterpSubsystem, STATGROUP_Tickables);
+}
+
+void UItemInterpSubsystem::StartInterp(AItem* Item, AShooterCharacter* Character)
+{
+	if(Item == nullptr) return;
+
+	// Restart the interpolation if the item is already interpolating
+	Entries.RemoveAllSwap([Item](const FItemInterpEntry& Entry) { return Entry.Item == Item; });
+
+	FItemInterpEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Item = Item;
+	Entry.Character = Character;
+	Entry.ZCurve = Item -> GetItemZCurve();
+	Entry.ScaleCurve = Item -> GetItemScaleCurve();
+	Entry.bCurvesLoaded = Item -> AreAnimCurvesLoaded();
+	Entry.StartLocation = Item -> GetItemInterpStartLocation();
+	Entry.YawOffset = Item -> GetInterpInitialYawOffset();
+	Entry.ElapsedTime = 0.f;
+	Entry.Duration = Item -> GetCurveDuration();
+}
+
+void UItemInterpSubsystem::UpdateEntry(const FItemInterpEntry& Entry, AItem* Item, AShooterCharacter* Character,
+	float DeltaTime)
+{
+	// Straight to the camera while the curve is streaming in
+	const float ZCurveValue = Entry.ZCurve ? Entry.ZCurve -> GetFloatValue(Entry.ElapsedTime) :
+		FMath::Clamp(Entry.ElapsedTime / Entry.Duration, 0.f, 1.f);
+
+	FVector ItemCurrentLocation = Entry.StartLocation;
+	const FVector TargetInterpLocation{ Character -> GetPickupInterpTargetLocation() };
+
+	// Vector from item to camera, X and Y are zeroed out
+	const FVector ItemToCameraDeltaZ{ FVector(0.f, 0.f, (TargetInterpLocation - ItemCurrentLocation).Z ) };
+	// Scale factor to multiply with the CurveValue
+	const float DeltaZSize = ItemToCameraDeltaZ.Size();
+
+	const FVector ItemFirstLocation{ Item -> GetActorLocation() };
+	const float InterpXValue = FMath::FInterpTo(ItemFirstLocation.X, TargetInterpLocation.X,
+		DeltaTime, 30.f);
+	const float InterpYValue = FMath::FInterpTo(ItemFirstLocation.Y, TargetInterpLocation.Y,
+		DeltaTime, 30.f);
+
+	// Set X and Y location of item to interpolated values
+	ItemCurrentLocation.X = InterpXValue;
+	ItemCurrentLocation.Y = InterpYValue;
+
+	// Adding to the Z component of item location based on the CurveValue multiplied by DeltaZSize(Scale)
+	ItemCurrentLocation.Z += ZCurveValue * DeltaZSize;
+
+	// Camera's yaw this frame
+	const float CurrentCameraYaw = Character -> GetCameraBoom() -> GetComponentRotation().Yaw;
+	// Keeping the OffsetYaw between the item and camera constant
+	const FRotator ItemRotation{ 0.f, CurrentCameraYaw + Entry.YawOffset, 0.f };
+
+	Item -> SetActorLocationAndRotation(ItemCurrentLocation, ItemRotation, false, nullptr,
+		ETeleportType::TeleportPhysics);
+
+	if(Entry.ScaleCurve) // Applying a ScaleCurve is optional
+	{
+		const float ScaleCurveValue = Entry.ScaleCurve -> GetFloatValue(Entry.ElapsedTime);
+		Item -> SetActorScale3D(FVector(ScaleCurveValue));
+	}
+}
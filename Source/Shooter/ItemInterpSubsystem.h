@@ -0,0 +1,74 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemInterpSubsystem.generated.h"
+
+class AItem;
+class AShooterCharacter;
+class UCurveFloat;
+
+/** Pickup interpolation state of a single item */
+struct FItemInterpEntry
+{
+	TWeakObjectPtr<AItem> Item;
+
+	/** Character picking up the item, the item moves towards its camera */
+	TWeakObjectPtr<AShooterCharacter> Character;
+
+	/** Curve for the item's z location, the item doesn't move without it */
+	UCurveFloat* ZCurve;
+
+	/** False while the item's curves are streaming in, the z location is interpolated linearly meanwhile */
+	bool bCurvesLoaded;
+
+	/** Curve for the item's scale (optional) */
+	UCurveFloat* ScaleCurve;
+
+	/** Location of the item when the interpolation started */
+	FVector StartLocation;
+
+	/** Yaw offset between the camera and the item kept during the interpolation */
+	float YawOffset;
+
+	/** Time since the interpolation started */
+	float ElapsedTime;
+
+	/** The point in timeline where curves stop */
+	float Duration;
+};
+
+/**
+ * Runs the pickup interpolation of every item in the world in a single loop, so items don't need to tick.
+ * Items are added by AItem::StartAnimCurves and AItem::FinishAnimCurves is called once their curves are done.
+ * An item picked up before its curves are streamed in rises linearly and picks up the curves once they are loaded,
+ * the pickup never waits on the loading.
+ */
+UCLASS()
+class SHOOTER_API UItemInterpSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start interpolating Item towards Character's camera */
+	void StartInterp(AItem* Item, AShooterCharacter* Character);
+
+	FORCEINLINE int32 GetNumInterpingItems() const { return Entries.Num(); }
+
+private:
+	/** Move, rotate and scale the item of Entry based on the curve values */
+	static void UpdateEntry(const FItemInterpEntry& Entry, AItem* Item, AShooterCharacter* Character, float DeltaTime);
+
+	/** Items currently interpolating */
+	TArray<FItemInterpEntry> Entries;
+
+	/** Items whose curves finished this tick */
+	TArray<AItem*> FinishedItems;
+};
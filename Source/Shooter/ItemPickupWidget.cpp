@@ -0,0 +1,31 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ItemPickupWidget.h"
+
+#include "Item.h"
+
+static TAutoConsoleVariable<int32> CVarSharedPickupWidget(
+	TEXT("Shooter.Pickup.SharedWidget"),
+	0,
+	TEXT("0: Every item keeps its own pickup widget component.\n")
+	TEXT("1: Each local player has a single pickup widget, moved to the item it looks at. Only items whose widget\n")
+	TEXT("   derives from UItemPickupWidget use it. Read when items begin play."),
+	ECVF_Default);
+
+bool UItemPickupWidget::IsShared()
+{
+	return CVarSharedPickupWidget.GetValueOnGameThread() != 0;
+}
+
+void UItemPickupWidget::SetItem(AItem* NewItem)
+{
+	Item = NewItem;
+	if(Item)
+	{
+		ItemName = Item -> GetItemName();
+		ItemCount = Item -> GetItemCount();
+		ActiveStars = Item -> GetActiveStars();
+	}
+	OnItemChanged();
+}
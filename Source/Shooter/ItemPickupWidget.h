@@ -0,0 +1,46 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "ItemPickupWidget.generated.h"
+
+class AItem;
+
+/**
+ * Base class for the pickup widget.
+ * A single instance per local player is retargeted to the focused item (see AShooterPlayerController),
+ * SetItem fills it with the item's values and lets the Blueprint redraw.
+ */
+UCLASS()
+class SHOOTER_API UItemPickupWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/** Returns true if local players share one pickup widget, and items drop their own widget components */
+	static bool IsShared();
+
+	/** Show Item's name, count and stars */
+	void SetItem(AItem* Item);
+
+protected:
+	/** Called after SetItem changed the values below */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Pickup")
+	void OnItemChanged();
+
+private:
+	/** Item currently shown */
+	UPROPERTY(BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	AItem* Item;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	FString ItemName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	int32 ItemCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pickup", meta = (AllowPrivateAccess = "true"))
+	TArray<bool> ActiveStars;
+};
@@ -0,0 +1,234 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "LagCompensationSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "Components/CapsuleComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Sample"), STAT_LagCompensationSample, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Rewind Trace"), STAT_LagCompensationRewindTrace, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rewound Shots"), STAT_RewoundShots, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rewound Hits"), STAT_RewoundHits, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rewind Hitbox Tests"), STAT_RewindHitboxTests, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lag Compensated Characters"), STAT_LagCompensatedCharacters, STATGROUP_Shooter);
+DECLARE_MEMORY_STAT(TEXT("Lag Compensation History"), STAT_LagCompensationMemory, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarLagCompensationMaxRewindTime(
+	TEXT("Shooter.LagCompensation.MaxRewindTime"),
+	0.4f,
+	TEXT("How far back in time, in seconds, the server rewinds characters to validate a client's shot."),
+	ECVF_Default);
+
+bool ULagCompensationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void ULagCompensationSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_LagCompensatedCharacters, Histories.Num());
+	DEC_MEMORY_STAT_BY(STAT_LagCompensationMemory, Histories.Num() * GetHistoryBytesPerCharacter());
+	Histories.Empty();
+	CompensatedActors.Empty();
+
+	Super::Deinitialize();
+}
+
+void ULagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_LagCompensationSample);
+	CSV_SCOPED_TIMING_STAT(Shooter, LagCompensationSample);
+
+	const float Now = GetWorld() -> GetTimeSeconds();
+	for(FHitboxHistory& History : Histories)
+	{
+		SampleHistory(History, Now);
+	}
+}
+
+bool ULagCompensationSubsystem::IsTickable() const
+{
+	return Histories.Num() > 0;
+}
+
+TStatId ULagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void ULagCompensationSubsystem::RegisterCharacter(AShooterCharacter* Character)
+{
+	// Only servers validate hits
+	const ENetMode NetMode = GetWorld() -> GetNetMode();
+	if(NetMode == NM_Standalone || NetMode == NM_Client) return;
+	if(Character == nullptr || CompensatedActors.Contains(Character)) return;
+
+	FHitboxHistory& History = Histories.AddZeroed_GetRef();
+	History.Character = Character;
+	History.NewestFrame = -1;
+
+	// Without configured hitboxes, the capsule is the only hitbox
+	const TArray<FLagCompensationHitbox>& Hitboxes = Character -> GetLagCompensationHitboxes();
+	const UCapsuleComponent* Capsule = Character -> GetCapsuleComponent();
+	const FVector CapsuleExtent{ Capsule -> GetScaledCapsuleRadius(), Capsule -> GetScaledCapsuleRadius(),
+		Capsule -> GetScaledCapsuleHalfHeight() };
+	History.NumHitboxes = FMath::Clamp(Hitboxes.Num(), 1, MaxHitboxes);
+
+	for(int32 Index = 0; Index < History.NumHitboxes; Index++)
+	{
+		const bool bCapsule = !Hitboxes.IsValidIndex(Index) || Hitboxes[Index].BoneName.IsNone();
+		History.BoneNames[Index] = bCapsule ? NAME_None : Hitboxes[Index].BoneName;
+		History.HalfExtents[Index] = FVector3f(bCapsule ? CapsuleExtent : Hitboxes[Index].HalfExtent);
+	}
+	// Bones stay within the capsule give or take the size of their box, the capsule's box is centered on it
+	History.BoundsRadius = CapsuleExtent.Size();
+	for(int32 Index = 0; Index < History.NumHitboxes; Index++)
+	{
+		if(History.BoneNames[Index].IsNone()) continue;
+		History.BoundsRadius = FMath::Max(History.BoundsRadius, CapsuleExtent.Z + History.HalfExtents[Index].Size());
+	}
+
+	CompensatedActors.Add(Character);
+	INC_DWORD_STAT(STAT_LagCompensatedCharacters);
+	INC_MEMORY_STAT_BY(STAT_LagCompensationMemory, GetHistoryBytesPerCharacter());
+}
+
+void ULagCompensationSubsystem::UnregisterCharacter(AShooterCharacter* Character)
+{
+	const int32 Index = CompensatedActors.Find(Character);
+	if(Index == INDEX_NONE) return;
+
+	Histories.RemoveAtSwap(Index);
+	CompensatedActors.RemoveAtSwap(Index);
+	DEC_DWORD_STAT(STAT_LagCompensatedCharacters);
+	DEC_MEMORY_STAT_BY(STAT_LagCompensationMemory, GetHistoryBytesPerCharacter());
+}
+
+bool ULagCompensationSubsystem::RewindTrace(const FVector& Start, const FVector& End, float Time,
+	const AShooterCharacter* IgnoreCharacter, FRewindHit& OutHit) const
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_LagCompensationRewindTrace);
+	INC_DWORD_STAT(STAT_RewoundShots);
+
+	const FVector Delta{ End - Start };
+	float ClosestHitTime = 2.f;
+
+	for(const FHitboxHistory& History : Histories)
+	{
+		if(History.Character == IgnoreCharacter || History.NumFrames == 0) continue;
+
+		int32 HitboxIndex = 0;
+		const float HitTime = RewindTraceHistory(History, Start, Delta, Time, HitboxIndex);
+		if(HitTime >= 0.f && HitTime < ClosestHitTime)
+		{
+			ClosestHitTime = HitTime;
+			OutHit.Character = History.Character;
+			OutHit.Location = Start + Delta * HitTime;
+			OutHit.HitboxIndex = HitboxIndex;
+		}
+	}
+
+	if(ClosestHitTime <= 1.f)
+	{
+		INC_DWORD_STAT(STAT_RewoundHits);
+		return true;
+	}
+	return false;
+}
+
+float ULagCompensationSubsystem::ClampRewindTime(float Time) const
+{
+	const float Now = GetWorld() -> GetTimeSeconds();
+	return FMath::Clamp(Time, Now - CVarLagCompensationMaxRewindTime.GetValueOnGameThread(), Now);
+}
+
+void ULagCompensationSubsystem::SampleHistory(FHitboxHistory& History, float Time)
+{
+	History.NewestFrame = (History.NewestFrame + 1) % MaxFrames;
+	History.NumFrames = FMath::Min(History.NumFrames + 1, MaxFrames);
+
+	FHitboxFrame& Frame = History.Frames[History.NewestFrame];
+	Frame.Time = Time;
+
+	const AShooterCharacter* Character = History.Character;
+	const FTransform ActorTransform{ Character -> GetActorTransform() };
+	Frame.CapsuleCenter = FVector3f(ActorTransform.GetLocation());
+	for(int32 Index = 0; Index < History.NumHitboxes; Index++)
+	{
+		const FTransform HitboxTransform{ History.BoneNames[Index].IsNone() ? ActorTransform :
+			Character -> GetMesh() -> GetSocketTransform(History.BoneNames[Index]) };
+		Frame.Centers[Index] = FVector3f(HitboxTransform.GetLocation());
+		Frame.Rotations[Index] = FQuat4f(HitboxTransform.GetRotation());
+	}
+}
+
+float ULagCompensationSubsystem::RewindTraceHistory(const FHitboxHistory& History, const FVector& Start,
+	const FVector& Delta, float Time, int32& OutHitboxIndex)
+{
+	// Find the two samples around Time, walking back from the newest one
+	int32 NewerIndex = History.NewestFrame;
+	int32 OlderIndex = History.NewestFrame;
+	for(int32 Step = 1; Step < History.NumFrames; Step++)
+	{
+		if(History.Frames[OlderIndex].Time <= Time) break;
+		NewerIndex = OlderIndex;
+		OlderIndex = (OlderIndex - 1 + MaxFrames) % MaxFrames;
+	}
+	const FHitboxFrame& Older = History.Frames[OlderIndex];
+	const FHitboxFrame& Newer = History.Frames[NewerIndex];
+	const float FrameSpan = Newer.Time - Older.Time;
+	const float Alpha = FrameSpan > 0.f ? FMath::Clamp((Time - Older.Time) / FrameSpan, 0.f, 1.f) : 1.f;
+
+	// Skip the hitboxes if the segment doesn't come close to the character
+	const FVector CapsuleCenter{ FMath::Lerp(FVector(Older.CapsuleCenter), FVector(Newer.CapsuleCenter), Alpha) };
+	const FVector ClosestPoint{ FMath::ClosestPointOnSegment(CapsuleCenter, Start, Start + Delta) };
+	if(FVector::DistSquared(ClosestPoint, CapsuleCenter) > FMath::Square(History.BoundsRadius)) return -1.f;
+
+	float ClosestHitTime = -1.f;
+	for(int32 Index = 0; Index < History.NumHitboxes; Index++)
+	{
+		INC_DWORD_STAT(STAT_RewindHitboxTests);
+		const FVector Center{ FMath::Lerp(FVector(Older.Centers[Index]), FVector(Newer.Centers[Index]), Alpha) };
+		const FQuat Rotation{ FQuat::Slerp(FQuat(Older.Rotations[Index]), FQuat(Newer.Rotations[Index]), Alpha) };
+
+		const float HitTime = IntersectSegmentBox(Start, Delta, Center, Rotation, FVector(History.HalfExtents[Index]));
+		if(HitTime >= 0.f && (ClosestHitTime < 0.f || HitTime < ClosestHitTime))
+		{
+			ClosestHitTime = HitTime;
+			OutHitboxIndex = Index;
+		}
+	}
+	return ClosestHitTime;
+}
+
+float ULagCompensationSubsystem::IntersectSegmentBox(const FVector& Start, const FVector& Delta,
+	const FVector& Center, const FQuat& Rotation, const FVector& HalfExtent)
+{
+	// Slab test in the box's local space
+	const FVector LocalStart{ Rotation.UnrotateVector(Start - Center) };
+	const FVector LocalDelta{ Rotation.UnrotateVector(Delta) };
+
+	float EnterTime = 0.f;
+	float ExitTime = 1.f;
+	for(int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if(FMath::IsNearlyZero(LocalDelta[Axis]))
+		{
+			// Parallel to the slab, it has to start inside it
+			if(FMath::Abs(LocalStart[Axis]) > HalfExtent[Axis]) return -1.f;
+			continue;
+		}
+		float SlabEnter = (-HalfExtent[Axis] - LocalStart[Axis]) / LocalDelta[Axis];
+		float SlabExit = (HalfExtent[Axis] - LocalStart[Axis]) / LocalDelta[Axis];
+		if(SlabEnter > SlabExit) Swap(SlabEnter, SlabExit);
+
+		EnterTime = FMath::Max(EnterTime, SlabEnter);
+		ExitTime = FMath::Min(ExitTime, SlabExit);
+		if(EnterTime > ExitTime) return -1.f;
+	}
+	return EnterTime;
+}
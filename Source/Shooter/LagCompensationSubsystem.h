@@ -0,0 +1,134 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LagCompensationSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** A box following a bone of the character, used to validate hits on the server */
+USTRUCT(BlueprintType)
+struct FLagCompensationHitbox
+{
+	GENERATED_BODY()
+
+	/** Bone the box follows, NAME_None follows the capsule */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName BoneName;
+
+	/** Half size of the box, ignored when following the capsule */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector HalfExtent{ 10.f };
+};
+
+/** Character hit by a rewound trace */
+struct FRewindHit
+{
+	AShooterCharacter* Character = nullptr;
+
+	/** Where the trace entered the hitbox */
+	FVector Location{ 0.f };
+
+	/** Index of the hitbox in the character's LagCompensationHitboxes, 0 for the capsule */
+	int32 HitboxIndex = 0;
+};
+
+/**
+ * Server-side rewind for hit validation.
+ * Every server tick it samples the hitboxes of each registered character into a fixed-size ring buffer.
+ * RewindTrace then traces a segment against the poses the characters had at a past time, interpolated
+ * between the two closest samples, without moving the actual actors.
+ */
+UCLASS()
+class SHOOTER_API ULagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Most hitboxes sampled per character */
+	static constexpr int32 MaxHitboxes = 8;
+
+	/** Samples kept per character, a bit over a second at 60Hz */
+	static constexpr int32 MaxFrames = 64;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start recording the hitboxes of Character, only on servers */
+	void RegisterCharacter(AShooterCharacter* Character);
+
+	/** Stop recording the hitboxes of Character */
+	void UnregisterCharacter(AShooterCharacter* Character);
+
+	/** Trace a segment against the hitboxes of every registered character as they were at Time
+	 *	@param IgnoreCharacter Usually the shooter
+	 *	@param OutHit Closest hitbox hit along the segment
+	 *	@return True if a hitbox was hit */
+	bool RewindTrace(const FVector& Start, const FVector& End, float Time, const AShooterCharacter* IgnoreCharacter,
+		FRewindHit& OutHit) const;
+
+	/** Clamp a time claimed by a client to the span the history covers */
+	float ClampRewindTime(float Time) const;
+
+	/** Characters with a history, world traces of rewound shots ignore them */
+	FORCEINLINE const TArray<AActor*>& GetCompensatedActors() const { return CompensatedActors; }
+
+	/** Memory used by the history of a single character */
+	static constexpr SIZE_T GetHistoryBytesPerCharacter() { return sizeof(FHitboxHistory); }
+
+private:
+	/** Pose of the hitboxes of a character at one server tick */
+	struct FHitboxFrame
+	{
+		float Time;
+
+		/** Center of the capsule, the hitboxes' bones stay around it */
+		FVector3f CapsuleCenter;
+
+		FVector3f Centers[MaxHitboxes];
+		FQuat4f Rotations[MaxHitboxes];
+	};
+
+	/** Ring buffer of hitbox poses of a single character */
+	struct FHitboxHistory
+	{
+		AShooterCharacter* Character;
+
+		int32 NumHitboxes;
+		FName BoneNames[MaxHitboxes];
+		FVector3f HalfExtents[MaxHitboxes];
+
+		/** Radius around the capsule center containing all the hitboxes, for early outs */
+		float BoundsRadius;
+
+		FHitboxFrame Frames[MaxFrames];
+
+		/** Index of the latest sample in Frames */
+		int32 NewestFrame;
+
+		/** Number of valid samples in Frames */
+		int32 NumFrames;
+	};
+
+	/** Record the current pose of a character's hitboxes */
+	static void SampleHistory(FHitboxHistory& History, float Time);
+
+	/** Trace against a single character's history, returns the hit time along the segment (0 to 1) or -1 */
+	static float RewindTraceHistory(const FHitboxHistory& History, const FVector& Start, const FVector& Delta,
+		float Time, int32& OutHitboxIndex);
+
+	/** Returns the segment time (0 to 1) where it enters the box, or -1 if it misses */
+	static float IntersectSegmentBox(const FVector& Start, const FVector& Delta, const FVector& Center,
+		const FQuat& Rotation, const FVector& HalfExtent);
+
+	TArray<FHitboxHistory> Histories;
+
+	/** Actors of Histories, in the same order */
+	UPROPERTY()
+	TArray<AActor*> CompensatedActors;
+};
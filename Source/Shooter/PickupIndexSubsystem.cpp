@@ -0,0 +1,142 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "PickupIndexSubsystem.h"
+
+#include "Shooter.h"
+#include "Item.h"
+#include "Components/SphereComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Candidates Tested"), STAT_PickupCandidatesTested, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pickup Indexed Items"), STAT_PickupIndexedItems, STATGROUP_Shooter);
+
+UPickupIndexSubsystem::UPickupIndexSubsystem():
+	CellSize(500.f),
+	MaxItemRadius(0.f)
+{
+
+}
+
+bool UPickupIndexSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UPickupIndexSubsystem::UpdateItem(AItem* Item)
+{
+	if(Item == nullptr) return;
+
+	RemoveItem(Item);
+	if(Item -> GetItemState() != EItemState::EIS_Pickup) return;
+
+	FPickupIndexEntry Entry;
+	Entry.Item = Item;
+	Entry.Location = Item -> GetActorLocation();
+	Entry.Radius = Item -> GetAreaSphere() ? Item -> GetAreaSphere() -> GetScaledSphereRadius() : 0.f;
+	MaxItemRadius = FMath::Max(MaxItemRadius, Entry.Radius);
+
+	const FIntVector Cell{ GetCell(Entry.Location) };
+	Cells.FindOrAdd(Cell).Add(Entry);
+	ItemCells.Add(Item, Cell);
+	INC_DWORD_STAT(STAT_PickupIndexedItems);
+}
+
+void UPickupIndexSubsystem::RemoveItem(AItem* Item)
+{
+	FIntVector Cell;
+	if(!ItemCells.RemoveAndCopyValue(Item, Cell)) return;
+
+	TArray<FPickupIndexEntry>* CellEntries = Cells.Find(Cell);
+	if(CellEntries)
+	{
+		CellEntries -> RemoveAllSwap([Item](const FPickupIndexEntry& Entry) { return Entry.Item == Item; }, false);
+		if(CellEntries -> Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+	DEC_DWORD_STAT(STAT_PickupIndexedItems);
+}
+
+AItem* UPickupIndexSubsystem::FindBestCandidate(const FVector& QueryLocation, float QueryRadius,
+	const FVector& ViewLocation, const FVector& ViewDirection, float CosViewConeHalfAngle) const
+{
+	if(ItemCells.Num() == 0) return nullptr;
+
+	const float Reach = MaxItemRadius + QueryRadius;
+	const FIntVector MinCell{ GetCell(QueryLocation - FVector(Reach)) };
+	const FIntVector MaxCell{ GetCell(QueryLocation + FVector(Reach)) };
+
+	AItem* BestCandidate = nullptr;
+	float BestViewDot = CosViewConeHalfAngle;
+	int32 NumTested = 0;
+
+	for(int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for(int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for(int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				const TArray<FPickupIndexEntry>* CellEntries = Cells.Find(FIntVector(X, Y, Z));
+				if(CellEntries == nullptr) continue;
+
+				for(const FPickupIndexEntry& Entry : *CellEntries)
+				{
+					++NumTested;
+					// Is the character close enough? (this used to be the AreaSphere overlap)
+					const float EntryReach = Entry.Radius + QueryRadius;
+					if(FVector::DistSquared(QueryLocation, Entry.Location) > EntryReach * EntryReach) continue;
+
+					// Is the item inside the view cone, and closer to its center than the best one so far?
+					const FVector ViewToItem{ (Entry.Location - ViewLocation).GetSafeNormal() };
+					const float ViewDot = FVector::DotProduct(ViewToItem, ViewDirection);
+					if(ViewDot >= BestViewDot)
+					{
+						BestViewDot = ViewDot;
+						BestCandidate = Entry.Item;
+					}
+				}
+			}
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_PickupCandidatesTested, NumTested);
+	return BestCandidate;
+}
+
+void UPickupIndexSubsystem::GatherItems(const FVector& Location, float Radius, TArray<AItem*>& OutItems) const
+{
+	if(ItemCells.Num() == 0) return;
+
+	const FIntVector MinCell{ GetCell(Location - FVector(Radius)) };
+	const FIntVector MaxCell{ GetCell(Location + FVector(Radius)) };
+	const float RadiusSquared = Radius * Radius;
+
+	for(int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for(int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for(int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				const TArray<FPickupIndexEntry>* CellEntries = Cells.Find(FIntVector(X, Y, Z));
+				if(CellEntries == nullptr) continue;
+
+				for(const FPickupIndexEntry& Entry : *CellEntries)
+				{
+					if(FVector::DistSquared(Location, Entry.Location) <= RadiusSquared)
+					{
+						OutItems.Add(Entry.Item);
+					}
+				}
+			}
+		}
+	}
+}
+
+FIntVector UPickupIndexSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
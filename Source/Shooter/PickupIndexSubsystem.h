@@ -0,0 +1,74 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickupIndexSubsystem.generated.h"
+
+class AItem;
+
+/** An item waiting to be picked up, stored in a cell of UPickupIndexSubsystem */
+struct FPickupIndexEntry
+{
+	AItem* Item;
+
+	/** Location of the item when it was indexed, items don't move while in EIS_Pickup */
+	FVector Location;
+
+	/** Distance at which characters start considering the item for pickup */
+	float Radius;
+};
+
+/**
+ * Spatial hash of every item in EIS_Pickup state.
+ * Characters query it for the best pickup candidate in their view cone, instead of counting AreaSphere overlaps
+ * and tracing from the crosshair every frame.
+ */
+UCLASS()
+class SHOOTER_API UPickupIndexSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPickupIndexSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Add Item to the index if it can be picked up, remove it otherwise. Called when the item state changes */
+	void UpdateItem(AItem* Item);
+
+	/** Remove Item from the index */
+	void RemoveItem(AItem* Item);
+
+	/** Find the item closest to the center of a view cone among the items in reach
+	 *	@param QueryLocation Location of the character looking for items
+	 *	@param QueryRadius Added to the item radius, usually the radius of the character's capsule
+	 *	@param ViewLocation Apex of the view cone
+	 *	@param ViewDirection Normalized direction of the view cone
+	 *	@param CosViewConeHalfAngle Cosine of the half angle of the view cone
+	 *	@return The best candidate, or nullptr if no item is in reach and in the view cone */
+	AItem* FindBestCandidate(const FVector& QueryLocation, float QueryRadius, const FVector& ViewLocation,
+		const FVector& ViewDirection, float CosViewConeHalfAngle) const;
+
+	/** Add every indexed item within Radius of Location to OutItems */
+	void GatherItems(const FVector& Location, float Radius, TArray<AItem*>& OutItems) const;
+
+	FORCEINLINE int32 GetNumIndexedItems() const { return ItemCells.Num(); }
+
+private:
+	/** Returns the cell containing Location */
+	FIntVector GetCell(const FVector& Location) const;
+
+	/** Items in pickup state mapped by cell */
+	TMap<FIntVector, TArray<FPickupIndexEntry>> Cells;
+
+	/** Cell of each indexed item, to find it again when it's removed */
+	TMap<AItem*, FIntVector> ItemCells;
+
+	/** Size of a cell, in cm */
+	float CellSize;
+
+	/** Largest radius of the items added so far, bounds the cells visited by a query */
+	float MaxItemRadius;
+};
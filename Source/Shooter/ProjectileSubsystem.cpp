@@ -0,0 +1,216 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ProjectileSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "Weapon.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectiles Resolve Sweeps"), STAT_ProjectilesResolveSweeps, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Projectiles Integrate"), STAT_ProjectilesIntegrate, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Projectiles Submit Sweeps"), STAT_ProjectilesSubmitSweeps, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Projectiles"), STAT_LiveProjectiles, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Sweeps"), STAT_ProjectileSweeps, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Lost Sweeps"), STAT_ProjectileLostSweeps, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Impacts"), STAT_ProjectileImpacts, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarProjectilesMaxSweepsPerFrame(
+	TEXT("Shooter.Projectiles.MaxSweepsPerFrame"),
+	2048,
+	TEXT("Collision sweeps submitted per frame, the other projectiles sweep a longer segment on a later frame."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarProjectilesMaxLive(
+	TEXT("Shooter.Projectiles.MaxLive"),
+	10'000,
+	TEXT("Projectiles simulated at once, shots fired past it are dropped."),
+	ECVF_Default);
+
+/** Projectiles integrated by one task, small enough to spread over the workers, large enough to amortize the task */
+static constexpr int32 IntegrationBatchSize = 1024;
+
+void FProjectileBuffer::Add(const FVector& Position, const FVector& Velocity, float Lifetime, float Gravity,
+	AShooterCharacter* Shooter)
+{
+	Positions.Add(Position);
+	Velocities.Add(Velocity);
+	Ages.Add(0.f);
+	Lifetimes.Add(Lifetime);
+	GravityZ.Add(Gravity);
+	SweepStarts.Add(Position);
+	SweepEnds.Add(Position);
+	TraceHandles.AddDefaulted();
+	Shooters.Add(Shooter);
+}
+
+void FProjectileBuffer::RemoveAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	Ages.RemoveAtSwap(Index, 1, false);
+	Lifetimes.RemoveAtSwap(Index, 1, false);
+	GravityZ.RemoveAtSwap(Index, 1, false);
+	SweepStarts.RemoveAtSwap(Index, 1, false);
+	SweepEnds.RemoveAtSwap(Index, 1, false);
+	TraceHandles.RemoveAtSwap(Index, 1, false);
+	Shooters.RemoveAtSwap(Index, 1, false);
+}
+
+void FProjectileBuffer::Reserve(int32 Number)
+{
+	Positions.Reserve(Number);
+	Velocities.Reserve(Number);
+	Ages.Reserve(Number);
+	Lifetimes.Reserve(Number);
+	GravityZ.Reserve(Number);
+	SweepStarts.Reserve(Number);
+	SweepEnds.Reserve(Number);
+	TraceHandles.Reserve(Number);
+	Shooters.Reserve(Number);
+}
+
+UProjectileSubsystem::UProjectileSubsystem():
+	SweepCursor(0)
+{
+
+}
+
+bool UProjectileSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UProjectileSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	CSV_SCOPED_TIMING_STAT(Shooter, ProjectileTick);
+
+	// The sweeps submitted last frame cover the segments travelled until then, resolve them before moving on
+	ResolveSweeps();
+	Integrate(DeltaTime);
+	SubmitSweeps();
+	SET_DWORD_STAT(STAT_LiveProjectiles, Projectiles.Num());
+}
+
+bool UProjectileSubsystem::IsTickable() const
+{
+	return Projectiles.Num() > 0;
+}
+
+TStatId UProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UProjectileSubsystem::FireProjectiles(const TArray<FShotRequest>& Shots, const AWeapon& Weapon)
+{
+	const int32 NumShots = FMath::Min(Shots.Num(), CVarProjectilesMaxLive.GetValueOnGameThread() - Projectiles.Num());
+	if(NumShots <= 0) return;
+
+	const float Gravity = GetWorld() -> GetGravityZ() * Weapon.GetProjectileGravityScale();
+	Projectiles.Reserve(Projectiles.Num() + NumShots);
+	for(int32 ShotIndex = 0; ShotIndex < NumShots; ShotIndex++)
+	{
+		// Aim at the far end of the crosshair trace, the projectile drops on its way there
+		const FShotRequest& Shot = Shots[ShotIndex];
+		const FVector MuzzleLocation{ Shot.MuzzleTransform.GetLocation() };
+		const FVector Direction{ (Shot.CrosshairTraceEnd - MuzzleLocation).GetSafeNormal() };
+		Projectiles.Add(MuzzleLocation, Direction * Weapon.GetMuzzleVelocity(), Weapon.GetProjectileLifetime(),
+			Gravity, Shot.Shooter.Get());
+	}
+}
+
+void UProjectileSubsystem::ResolveSweeps()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ProjectilesResolveSweeps);
+
+	for(int32 Index = Projectiles.Num() - 1; Index >= 0; Index--)
+	{
+		FTraceHandle& Handle = Projectiles.TraceHandles[Index];
+		if(Handle.IsValid())
+		{
+			FTraceDatum TraceDatum;
+			const bool bSweepDone = GetWorld() -> QueryTraceData(Handle, TraceDatum);
+			const FHitResult* Hit = bSweepDone ?
+				TraceDatum.OutHits.FindByPredicate([](const FHitResult& Result) { return Result.bBlockingHit; }) :
+				nullptr;
+			Handle.Invalidate();
+			// The result is lost, e.g. the frame's trace data was reset. Keep the start, so the next sweep covers
+			// the whole segment again
+			if(!bSweepDone)
+			{
+				INC_DWORD_STAT(STAT_ProjectileLostSweeps);
+				continue;
+			}
+			if(Hit)
+			{
+				INC_DWORD_STAT(STAT_ProjectileImpacts);
+				if(AShooterCharacter* Shooter = Projectiles.Shooters[Index].Get())
+				{
+					Shooter -> SpawnImpactParticles(Hit -> Location);
+				}
+				Projectiles.RemoveAtSwap(Index);
+				continue;
+			}
+			Projectiles.SweepStarts[Index] = Projectiles.SweepEnds[Index];
+		}
+
+		// Expired projectiles go once the sweep of their last segment came back empty
+		if(Projectiles.Ages[Index] >= Projectiles.Lifetimes[Index] &&
+			Projectiles.SweepStarts[Index] == Projectiles.Positions[Index])
+		{
+			Projectiles.RemoveAtSwap(Index);
+		}
+	}
+}
+
+void UProjectileSubsystem::Integrate(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ProjectilesIntegrate);
+
+	// Semi-implicit Euler, velocity first so the drop matches the time step
+	FVector* Positions = Projectiles.Positions.GetData();
+	FVector* Velocities = Projectiles.Velocities.GetData();
+	float* Ages = Projectiles.Ages.GetData();
+	const float* GravityZ = Projectiles.GravityZ.GetData();
+	const int32 NumProjectiles = Projectiles.Num();
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumProjectiles, IntegrationBatchSize);
+	ParallelFor(NumBatches, [=](int32 Batch)
+	{
+		const int32 End = FMath::Min((Batch + 1) * IntegrationBatchSize, NumProjectiles);
+		for(int32 Index = Batch * IntegrationBatchSize; Index < End; Index++)
+		{
+			Velocities[Index].Z += GravityZ[Index] * DeltaTime;
+			Positions[Index] += Velocities[Index] * DeltaTime;
+			Ages[Index] += DeltaTime;
+		}
+	}, NumBatches == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UProjectileSubsystem::SubmitSweeps()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ProjectilesSubmitSweeps);
+
+	const int32 NumProjectiles = Projectiles.Num();
+	if(NumProjectiles == 0) return;
+
+	// Round robin from where the last frame stopped
+	const int32 MaxSweeps = FMath::Min(FMath::Max(CVarProjectilesMaxSweepsPerFrame.GetValueOnGameThread(), 1),
+		NumProjectiles);
+	SweepCursor %= NumProjectiles;
+	for(int32 Sweep = 0; Sweep < MaxSweeps; Sweep++)
+	{
+		const int32 Index = (SweepCursor + Sweep) % NumProjectiles;
+		FCollisionQueryParams TraceParams{ SCENE_QUERY_STAT(ProjectileSweep) };
+		TraceParams.AddIgnoredActor(Projectiles.Shooters[Index].Get());
+		Projectiles.SweepEnds[Index] = Projectiles.Positions[Index];
+		Projectiles.TraceHandles[Index] = GetWorld() -> AsyncLineTraceByChannel(EAsyncTraceType::Single,
+			Projectiles.SweepStarts[Index], Projectiles.SweepEnds[Index], ECollisionChannel::ECC_Visibility,
+			TraceParams);
+	}
+	SweepCursor = (SweepCursor + MaxSweeps) % NumProjectiles;
+	INC_DWORD_STAT_BY(STAT_ProjectileSweeps, MaxSweeps);
+}
@@ -0,0 +1,88 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "HitscanSubsystem.h"
+#include "ProjectileSubsystem.generated.h"
+
+class AShooterCharacter;
+class AWeapon;
+
+/**
+ * Live projectiles stored as a structure of arrays, one element per projectile in every array.
+ * Integration only reads and writes the tightly packed Positions, Velocities and Ages.
+ */
+struct FProjectileBuffer
+{
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+
+	/** Seconds since the projectile was fired */
+	TArray<float> Ages;
+	TArray<float> Lifetimes;
+
+	/** World gravity multiplied by the weapon's gravity scale */
+	TArray<float> GravityZ;
+
+	/** Start of the next collision sweep, the end of the last one */
+	TArray<FVector> SweepStarts;
+
+	/** End of the sweep in flight */
+	TArray<FVector> SweepEnds;
+
+	/** Handle of the sweep in flight, invalid if there is none */
+	TArray<FTraceHandle> TraceHandles;
+
+	/** Character who fired the projectile, it spawns the impact */
+	TArray<TWeakObjectPtr<AShooterCharacter>> Shooters;
+
+	FORCEINLINE int32 Num() const { return Positions.Num(); }
+
+	void Add(const FVector& Position, const FVector& Velocity, float Lifetime, float Gravity, AShooterCharacter* Shooter);
+	void RemoveAtSwap(int32 Index);
+	void Reserve(int32 Number);
+};
+
+/**
+ * Simulates the projectiles of the weapons that fire them (AWeapon::FiresProjectiles) without spawning actors.
+ * Every frame the projectiles are integrated in parallel, then up to Shooter.Projectiles.MaxSweepsPerFrame of
+ * them sweep the segment they travelled since their last sweep, as one batch of async traces read back the next
+ * frame. Past the budget the remaining projectiles sweep a longer segment later, so none go through walls, their
+ * impacts just come a few frames later.
+ */
+UCLASS()
+class SHOOTER_API UProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UProjectileSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Launch a projectile from the muzzle toward the crosshair of each shot, with Weapon's ballistics */
+	void FireProjectiles(const TArray<FShotRequest>& Shots, const AWeapon& Weapon);
+
+	FORCEINLINE int32 GetNumProjectiles() const { return Projectiles.Num(); }
+
+private:
+	/** Read back last frame's sweeps, spawn the impacts and remove the projectiles that hit or expired */
+	void ResolveSweeps();
+
+	/** Move the projectiles forward by DeltaTime */
+	void Integrate(float DeltaTime);
+
+	/** Submit the sweeps of the projectiles next in line, within the frame's budget */
+	void SubmitSweeps();
+
+	FProjectileBuffer Projectiles;
+
+	/** Projectile the next SubmitSweeps starts from, so every projectile gets its turn */
+	int32 SweepCursor;
+};
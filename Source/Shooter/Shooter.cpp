@@ -1,6 +1,43 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#include "Shooter.h"
-#include "Modules/ModuleManager.h"
-
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Shooter, "Shooter" );
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Shooter.h"
+#include "Modules/ModuleManager.h"
+#include "Engine/NetDriver.h"
+#include "Engine/ReplicationDriver.h"
+#include "Engine/World.h"
+#include "ShooterReplicationGraph.h"
+
+DEFINE_LOG_CATEGORY(LogShooter);
+CSV_DEFINE_CATEGORY(Shooter, true);
+
+static TAutoConsoleVariable<int32> CVarUseReplicationGraph(
+	TEXT("Shooter.Net.ReplicationGraph"),
+	1,
+	TEXT("Use UShooterReplicationGraph on servers, read when a net driver is created."),
+	ECVF_Default);
+
+class FShooterModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// Game net drivers get the replication graph, unless it's disabled
+		UReplicationDriver::CreateReplicationDriverDelegate().BindLambda(
+			[](UNetDriver* ForNetDriver, const FURL& URL, UWorld* World) -> UReplicationDriver*
+			{
+				if(CVarUseReplicationGraph.GetValueOnGameThread() == 0) return nullptr;
+				if(World == nullptr || !World -> IsGameWorld() || ForNetDriver -> NetDriverName != NAME_GameNetDriver)
+				{
+					return nullptr;
+				}
+				return NewObject<UShooterReplicationGraph>(GetTransientPackage());
+			});
+	}
+
+	virtual void ShutdownModule() override
+	{
+		UReplicationDriver::CreateReplicationDriverDelegate().Unbind();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FShooterModule, Shooter, "Shooter" );
@@ -1,6 +1,20 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogShooter, Log, All);
+
+/** Gameplay timings and values recorded in CSV profiles, e.g. by the -ShooterBenchmark run */
+CSV_DECLARE_CATEGORY_EXTERN(Shooter);
+
+/** Gameplay counters and timers, visible in game with "stat Shooter" */
+DECLARE_STATS_GROUP(TEXT("Shooter"), STATGROUP_Shooter, STATCAT_Advanced);
+
+/** Times the enclosing scope with a cycle stat of STATGROUP_Shooter, and as a CPU event in Unreal Insights */
+#define SHOOTER_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
@@ -1,56 +1,203 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-
-#include "ShooterAnimInstance.h"
-#include "ShooterCharacter.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "Kismet/KismetMathLibrary.h"
-
-void UShooterAnimInstance::UpdateAnimationProperties(float DeltaTime)
-{
-	if(ShooterCharacter == nullptr)
-	{
-		ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
-	}
-
-	if(ShooterCharacter)
-	{
-		// Getting the lateral speed of the character from velocity
-		FVector Velocity = { ShooterCharacter -> GetVelocity() };
-		Velocity.Z = 0;
-		speed = Velocity.Size();
-
-		// Is the character in the air?
-		bIsInAir = ShooterCharacter -> GetCharacterMovement() -> IsFalling();
-
-		// Is the character accelerating?
-		if(ShooterCharacter -> GetCharacterMovement() -> GetCurrentAcceleration().Size() > 0.f)
-		{
-			bIsAccelerating = true;
-		}
-		else
-		{
-			bIsAccelerating = false;
-		}
-
-		// Calculating MovementOffsetYaw for strafing
-		FRotator AimRotation = ShooterCharacter -> GetBaseAimRotation();
-		FRotator MovementRotation = UKismetMathLibrary::MakeRotFromX(ShooterCharacter -> GetVelocity());
-		MovementOffsetYaw = UKismetMathLibrary::NormalizedDeltaRotator(MovementRotation, AimRotation).Yaw;
-
-		if(ShooterCharacter -> GetVelocity().Size() > 0.f)
-		{
-			LastMovementOffsetYaw = MovementOffsetYaw;
-		}
-
-		bAiming = ShooterCharacter -> GetAiming();
-	}
-}
-
-void UShooterAnimInstance::NativeInitializeAnimation()
-{
-	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
-}
-
-
-
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterAnimInstance.h"
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Misc/ScopeExit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Anim Snapshot (Game Thread)"), STAT_AnimSnapshot, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Anim Update (Worker Thread)"), STAT_AnimThreadSafeUpdate, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Fire Recoil Update"), STAT_FireRecoilUpdate, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Fire Recoil Apply"), STAT_FireRecoilApply, STATGROUP_Shooter);
+
+UShooterAnimInstance::UShooterAnimInstance():
+	RecoilRotation(FRotator::ZeroRotator),
+	RecoilOffset(FVector::ZeroVector),
+	FireAlpha(0.f),
+	RecoilPitchPerShot(1.5f),
+	RecoilKickbackPerShot(3.f),
+	MaxRecoilPitch(8.f),
+	MaxRecoilKickback(10.f),
+	RecoilRecoverySpeed(12.f),
+	FireRecoilDuration(0.1f),
+	RecoilBoneName(TEXT("spine_03")),
+	LastFireShotCount(0),
+	NativeUpdateCycles(0)
+{
+
+}
+
+void UShooterAnimInstance::UpdateAnimationProperties(float DeltaTime)
+{
+	// Kept for the animation blueprints still calling it, NativeThreadSafeUpdateAnimation does the work
+}
+
+void UShooterAnimInstance::NativeInitializeAnimation()
+{
+	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+	// Shots fired before the animation started don't recoil
+	LastFireShotCount = ShooterCharacter ? ShooterCharacter -> GetFireShotCount() : 0;
+	GetProxyOnGameThread<FShooterAnimInstanceProxy>().RecoilBoneName = RecoilBoneName;
+}
+
+void UShooterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_AnimSnapshot);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	ON_SCOPE_EXIT { NativeUpdateCycles += FPlatformTime::Cycles64() - StartCycles; };
+
+	if(ShooterCharacter == nullptr)
+	{
+		ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+	}
+
+	Snapshot.bValid = ShooterCharacter != nullptr;
+	if(ShooterCharacter)
+	{
+		// Read everything from the character once, on the game thread
+		const UCharacterMovementComponent* CharacterMovement = ShooterCharacter -> GetCharacterMovement();
+		Snapshot.Velocity = ShooterCharacter -> GetVelocity();
+		Snapshot.AimRotation = ShooterCharacter -> GetBaseAimRotation();
+		Snapshot.bIsInAir = CharacterMovement -> IsFalling();
+		Snapshot.bIsAccelerating = CharacterMovement -> GetCurrentAcceleration().SizeSquared() > 0.f;
+		Snapshot.bAiming = ShooterCharacter -> GetAiming();
+		Snapshot.FireShotCount = ShooterCharacter -> GetFireShotCount();
+		Snapshot.TimeSinceLastShot = Snapshot.FireShotCount > 0 ?
+			ShooterCharacter -> GetWorld() -> GetTimeSeconds() - ShooterCharacter -> GetLastFireTime() : MAX_flt;
+	}
+}
+
+void UShooterAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_AnimThreadSafeUpdate);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	ON_SCOPE_EXIT { NativeUpdateCycles += FPlatformTime::Cycles64() - StartCycles; };
+
+	if(!Snapshot.bValid) return;
+
+	// Getting the lateral speed of the character from velocity
+	speed = Snapshot.Velocity.Size2D();
+
+	// Is the character in the air?
+	bIsInAir = Snapshot.bIsInAir;
+
+	// Is the character accelerating?
+	bIsAccelerating = Snapshot.bIsAccelerating;
+
+	// Calculating MovementOffsetYaw for strafing
+	const FRotator MovementRotation = UKismetMathLibrary::MakeRotFromX(Snapshot.Velocity);
+	MovementOffsetYaw = UKismetMathLibrary::NormalizedDeltaRotator(MovementRotation, Snapshot.AimRotation).Yaw;
+
+	if(!Snapshot.Velocity.IsZero())
+	{
+		LastMovementOffsetYaw = MovementOffsetYaw;
+	}
+
+	bAiming = Snapshot.bAiming;
+
+	UpdateFireRecoil(DeltaSeconds);
+}
+
+void UShooterAnimInstance::UpdateFireRecoil(float DeltaSeconds)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_FireRecoilUpdate);
+	CSV_SCOPED_TIMING_STAT(Shooter, FireRecoilUpdate);
+
+	// Recover first, so a shot this update kicks from where the recoil is now. The decay depends on the time elapsed
+	// only, characters updated at a reduced rate by the animation budget recover at the same speed
+	const float Recovery = FMath::Exp(-RecoilRecoverySpeed * DeltaSeconds);
+	float Pitch = RecoilRotation.Pitch * Recovery;
+	float Kickback = -RecoilOffset.X * Recovery;
+
+	// Unsigned difference, the count may wrap around
+	const uint32 NewShots = Snapshot.FireShotCount - LastFireShotCount;
+	LastFireShotCount = Snapshot.FireShotCount;
+	if(NewShots > 0)
+	{
+		Pitch = FMath::Min(Pitch + NewShots * RecoilPitchPerShot, MaxRecoilPitch);
+		Kickback = FMath::Min(Kickback + NewShots * RecoilKickbackPerShot, MaxRecoilKickback);
+	}
+
+	RecoilRotation = FRotator(Pitch, 0.f, 0.f);
+	RecoilOffset = FVector(-Kickback, 0.f, 0.f);
+	FireAlpha = FireRecoilDuration > 0.f ?
+		FMath::Clamp(1.f - Snapshot.TimeSinceLastShot / FireRecoilDuration, 0.f, 1.f) : 0.f;
+
+	// Evaluated right after this update, on the same thread
+	FShooterAnimInstanceProxy& Proxy = GetProxyOnAnyThread<FShooterAnimInstanceProxy>();
+	Proxy.RecoilRotation = RecoilRotation;
+	Proxy.RecoilOffset = RecoilOffset;
+}
+
+float UShooterAnimInstance::ConsumeUpdateCostMs(int32& OutNumUpdates)
+{
+	FShooterAnimInstanceProxy& Proxy = GetProxyOnGameThread<FShooterAnimInstanceProxy>();
+	const uint64 Cycles = NativeUpdateCycles + Proxy.GraphCycles;
+	OutNumUpdates = Proxy.NumGraphUpdates;
+
+	NativeUpdateCycles = 0;
+	Proxy.GraphCycles = 0;
+	Proxy.NumGraphUpdates = 0;
+	return static_cast<float>(FPlatformTime::ToMilliseconds64(Cycles));
+}
+
+FAnimInstanceProxy* UShooterAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FShooterAnimInstanceProxy(this);
+}
+
+void UShooterAnimInstance::DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy)
+{
+	delete static_cast<FShooterAnimInstanceProxy*>(InProxy);
+}
+
+void FShooterAnimInstanceProxy::UpdateAnimationNode(const FAnimationUpdateContext& InContext)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	FAnimInstanceProxy::UpdateAnimationNode(InContext);
+	GraphCycles += FPlatformTime::Cycles64() - StartCycles;
+	NumGraphUpdates++;
+}
+
+void FShooterAnimInstanceProxy::EvaluateAnimationNode(FPoseContext& Output)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	FAnimInstanceProxy::EvaluateAnimationNode(Output);
+	ApplyFireRecoil(Output);
+	GraphCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void FShooterAnimInstanceProxy::ApplyFireRecoil(FPoseContext& Output) const
+{
+	if(RecoilBoneName.IsNone() || (RecoilRotation.IsNearlyZero() && RecoilOffset.IsNearlyZero())) return;
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_FireRecoilApply);
+
+	const FBoneContainer& RequiredBones = Output.Pose.GetBoneContainer();
+	const int32 MeshBoneIndex = RequiredBones.GetPoseBoneIndexForBoneName(RecoilBoneName);
+	if(MeshBoneIndex == INDEX_NONE) return;
+	const FCompactPoseBoneIndex BoneIndex = RequiredBones.MakeCompactPoseIndex(FMeshPoseBoneIndex(MeshBoneIndex));
+	if(!BoneIndex.IsValid()) return;
+
+	// Component space transform of the parent, only the bones above the recoil bone are needed
+	FTransform ParentTransform{ FTransform::Identity };
+	for(FCompactPoseBoneIndex Index = Output.Pose.GetParentBoneIndex(BoneIndex); Index.IsValid();
+		Index = Output.Pose.GetParentBoneIndex(Index))
+	{
+		ParentTransform = ParentTransform * Output.Pose[Index];
+	}
+
+	// The recoil is in the actor's space, the pose in the mesh's, which is usually turned to face the actor's forward
+	const FQuat MeshRotation{ GetComponentRelativeTransform().GetRotation() };
+	const FQuat Recoil{ MeshRotation.Inverse() * FQuat(RecoilRotation) * MeshRotation };
+	FTransform BoneTransform{ Output.Pose[BoneIndex] * ParentTransform };
+	BoneTransform.SetRotation(Recoil * BoneTransform.GetRotation());
+	BoneTransform.AddToTranslation(MeshRotation.UnrotateVector(RecoilOffset));
+
+	Output.Pose[BoneIndex] = BoneTransform.GetRelativeTransform(ParentTransform);
+	Output.Pose[BoneIndex].NormalizeRotation();
+}
@@ -1,47 +1,164 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Animation/AnimInstance.h"
-#include "ShooterAnimInstance.generated.h"
-
-/**
- * 
- */
-UCLASS()
-class SHOOTER_API UShooterAnimInstance : public UAnimInstance
-{
-	GENERATED_BODY()
-public:
-	UFUNCTION(BlueprintCallable)
-	void UpdateAnimationProperties(float DeltaTime);
-
-    virtual void NativeInitializeAnimation() override;
-private:
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	class AShooterCharacter* ShooterCharacter;
-
-	/** The speed of the character */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	float speed;
-
-	/** Whether or not the character is in the air */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	bool bIsInAir;
-
-	/** Whether or not the character is moving */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	bool bIsAccelerating;
-
-	/** Offset yaw used for strafing */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	float MovementOffsetYaw;
-
-	/** Offset yaw the frame before me stopped moving */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	float LastMovementOffsetYaw;
-	
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
-	bool bAiming;
-};
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "ShooterAnimInstance.generated.h"
+
+/** Character values read on the game thread, for the animation update on the worker thread */
+struct FShooterAnimSnapshot
+{
+	FVector Velocity{ FVector::ZeroVector };
+	FRotator AimRotation{ FRotator::ZeroRotator };
+	bool bIsInAir{ false };
+	bool bIsAccelerating{ false };
+	bool bAiming{ false };
+	bool bValid{ false };
+
+	/** Shots fired by the character so far, and seconds since the last one */
+	uint32 FireShotCount{ 0 };
+	float TimeSinceLastShot{ 0.f };
+};
+
+/** Times the anim graph of UShooterAnimInstance on the worker thread, for UAnimBudgetSubsystem */
+struct FShooterAnimInstanceProxy : public FAnimInstanceProxy
+{
+	FShooterAnimInstanceProxy() = default;
+	FShooterAnimInstanceProxy(UAnimInstance* Instance):
+		FAnimInstanceProxy(Instance)
+	{
+
+	}
+
+	virtual void UpdateAnimationNode(const FAnimationUpdateContext& InContext) override;
+	virtual void EvaluateAnimationNode(FPoseContext& Output) override;
+
+	/** Cycles spent in the graph, and graph updates, since UShooterAnimInstance::ConsumeUpdateCostMs last read them */
+	uint64 GraphCycles{ 0 };
+	int32 NumGraphUpdates{ 0 };
+
+	/** Recoil of the last update, in the actor's space, and the bone it is applied to */
+	FRotator RecoilRotation{ FRotator::ZeroRotator };
+	FVector RecoilOffset{ FVector::ZeroVector };
+	FName RecoilBoneName;
+
+private:
+	/** Rotate and push back RecoilBoneName in the pose the graph evaluated */
+	void ApplyFireRecoil(FPoseContext& Output) const;
+};
+
+/**
+ * Animation instance of AShooterCharacter.
+ * NativeUpdateAnimation takes a snapshot of the character on the game thread, the movement properties are then
+ * computed from the snapshot in NativeThreadSafeUpdateAnimation, during the parallel animation update.
+ * With Shooter.Anim.ProceduralFireRecoil, firing doesn't play a montage per shot: every new shot of the character
+ * kicks a procedural recoil that recovers on its own. It is applied to RecoilBoneName once the graph evaluated, so it
+ * needs no graph changes, and the graph may read it too (RecoilRotation, RecoilOffset, FireAlpha to blend an
+ * additive fire pose).
+ * Every update is timed, native code and graph, so UAnimBudgetSubsystem budgets with the measured cost.
+ */
+UCLASS()
+class SHOOTER_API UShooterAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+public:
+	UShooterAnimInstance();
+
+	/** The properties are updated natively now, remove the call from the event graph */
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction,
+		DeprecationMessage = "Updated in NativeThreadSafeUpdateAnimation, the call can be removed"))
+	void UpdateAnimationProperties(float DeltaTime);
+
+    virtual void NativeInitializeAnimation() override;
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+	/** Milliseconds spent updating and evaluating the animation since the last call, over OutNumUpdates updates.
+	 *	Call on the game thread once the animation of the frame is done */
+	float ConsumeUpdateCostMs(int32& OutNumUpdates);
+
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override;
+
+private:
+	/** Turn the shots fired since the last update into recoil, and let the recoil recover */
+	void UpdateFireRecoil(float DeltaSeconds);
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	class AShooterCharacter* ShooterCharacter;
+
+	/** The speed of the character */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	float speed;
+
+	/** Whether or not the character is in the air */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	bool bIsInAir;
+
+	/** Whether or not the character is moving */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	bool bIsAccelerating;
+
+	/** Offset yaw used for strafing */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	float MovementOffsetYaw;
+
+	/** Offset yaw the frame before me stopped moving */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	float LastMovementOffsetYaw;
+	
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	bool bAiming;
+
+	/** Recoil of the aim, pitching the weapon up */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FRotator RecoilRotation;
+
+	/** Recoil of the weapon, pushing it back toward the shoulder */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FVector RecoilOffset;
+
+	/** 1 right after a shot, down to 0 after FireRecoilDuration */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float FireAlpha;
+
+	/** Pitch added by each shot, in degrees */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float RecoilPitchPerShot;
+
+	/** Kickback added by each shot */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float RecoilKickbackPerShot;
+
+	/** Most pitch sustained fire accumulates, in degrees */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float MaxRecoilPitch;
+
+	/** Most kickback sustained fire accumulates */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float MaxRecoilKickback;
+
+	/** How fast the recoil recovers, higher is faster */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float RecoilRecoverySpeed;
+
+	/** Seconds FireAlpha takes to fade out after a shot */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float FireRecoilDuration;
+
+	/** Bone the recoil is applied to after the graph, the arms and weapon follow it. None leaves it to the graph */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FName RecoilBoneName;
+
+	/** Shots already turned into recoil */
+	uint32 LastFireShotCount;
+
+	/** Written on the game thread, read on the worker thread once the game thread update is done */
+	FShooterAnimSnapshot Snapshot;
+
+	/** Cycles spent in NativeUpdateAnimation and NativeThreadSafeUpdateAnimation since ConsumeUpdateCostMs */
+	uint64 NativeUpdateCycles;
+};
@@ -0,0 +1,267 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterBenchmarkSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "Weapon.h"
+#include "Animation/AnimInstance.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/** Seed of the random streams, so two runs spread their shots the same way */
+static constexpr int32 BenchmarkSeed = 0x5EED;
+
+UShooterBenchmarkSubsystem::UShooterBenchmarkSubsystem():
+	NumCharacters(32),
+	NumItems(100),
+	Duration(60.f),
+	ElapsedTime(0.f),
+	LastFrameTime(0.0),
+	TotalShotsFired(0),
+	bPreviousUseFixedTimeStep(false),
+	PreviousFixedDeltaTime(0.0),
+	bQuitWhenFinished(true),
+	bRunning(false),
+	bFinished(false)
+{
+
+}
+
+bool UShooterBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UShooterBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	if(!FParse::Param(FCommandLine::Get(), TEXT("ShooterBenchmark"))) return;
+
+	FShooterBenchmarkSettings Settings;
+	FParse::Value(FCommandLine::Get(), TEXT("BenchCharacters="), Settings.NumCharacters);
+	FParse::Value(FCommandLine::Get(), TEXT("BenchItems="), Settings.NumItems);
+	FParse::Value(FCommandLine::Get(), TEXT("BenchDuration="), Settings.Duration);
+	FParse::Value(FCommandLine::Get(), TEXT("BenchFPS="), Settings.FrameRate);
+	FParse::Value(FCommandLine::Get(), TEXT("BenchCSV="), Settings.CSVPath);
+	StartBenchmark(Settings);
+}
+
+void UShooterBenchmarkSubsystem::StartBenchmark(const FShooterBenchmarkSettings& Settings)
+{
+	if(bRunning) return;
+
+	NumCharacters = Settings.NumCharacters;
+	NumItems = Settings.NumItems;
+	Duration = Settings.Duration;
+	const float FrameRate = Settings.FrameRate;
+	CSVPath = Settings.CSVPath.IsEmpty() ? FPaths::ProfilingDir() / TEXT("ShooterBenchmark.csv") : Settings.CSVPath;
+	bQuitWhenFinished = Settings.bQuitWhenFinished;
+	ElapsedTime = 0.f;
+	TotalShotsFired = 0;
+	bFinished = false;
+
+	// Simulated time doesn't depend on how long frames take, nor randomness on the run
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FMath::Max(FrameRate, 1.f));
+	FMath::RandInit(BenchmarkSeed);
+	FMath::SRandInit(BenchmarkSeed);
+
+	SpawnActors();
+
+	// Compare the fire animation paths with -dpcvars=Shooter.Anim.ProceduralFireRecoil=0
+	const IConsoleVariable* ProceduralFireRecoil =
+		IConsoleManager::Get().FindConsoleVariable(TEXT("Shooter.Anim.ProceduralFireRecoil"));
+	UE_LOG(LogShooter, Display,
+		TEXT("Benchmark started: %d characters, %d items, %.1fs at %.0f fps, %s fire animation"),
+		Characters.Num(), NumItems, Duration, FrameRate,
+		ProceduralFireRecoil && ProceduralFireRecoil -> GetInt() == 0 ? TEXT("montage") : TEXT("procedural"));
+	Rows.Reserve(FMath::CeilToInt(Duration * FrameRate) + 1);
+	Rows.Add(TEXT("Frame,Time,FrameMs,GameThreadMs,UsedPhysicalMB,ShotsFired,Characters,Items,MontageInstances"));
+#if CSV_PROFILER
+	FCsvProfiler::Get() -> BeginCapture();
+#endif
+	LastFrameTime = FPlatformTime::Seconds();
+	bRunning = true;
+}
+
+void UShooterBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = (Now - LastFrameTime) * 1000.0;
+	LastFrameTime = Now;
+	ElapsedTime += DeltaTime;
+
+	const int32 ShotsFired = GatherShots();
+	TotalShotsFired += ShotsFired;
+	KeepCharactersFiring();
+	const int32 MontageInstances = CountMontageInstances();
+	const float UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+	CSV_CUSTOM_STAT(Shooter, UsedPhysicalMB, UsedPhysicalMB, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Shooter, ShotsFired, ShotsFired, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Shooter, MontageInstances, MontageInstances, ECsvCustomStatOp::Set);
+
+	// GGameThreadTime is the game thread time of the previous frame
+	Rows.Add(FString::Printf(TEXT("%llu,%.4f,%.3f,%.3f,%.1f,%d,%d,%d,%d"), GFrameCounter, ElapsedTime, FrameMs,
+		FPlatformTime::ToMilliseconds(GGameThreadTime), UsedPhysicalMB, ShotsFired, Characters.Num(), NumItems,
+		MontageInstances));
+
+	if(ElapsedTime >= Duration)
+	{
+		FinishBenchmark();
+	}
+}
+
+bool UShooterBenchmarkSubsystem::IsTickable() const
+{
+	return bRunning;
+}
+
+TStatId UShooterBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterBenchmarkSubsystem::SpawnActors()
+{
+	const AGameModeBase* GameMode = GetWorld() -> GetAuthGameMode();
+	UClass* CharacterClass = GameMode ? GameMode -> DefaultPawnClass.Get() : nullptr;
+	if(CharacterClass == nullptr || !CharacterClass -> IsChildOf(AShooterCharacter::StaticClass()))
+	{
+		UE_LOG(LogShooter, Error, TEXT("Benchmark needs a game mode whose default pawn is a shooter character"));
+		return;
+	}
+
+	// Grids around the player start, characters in the middle facing outward, items in a ring around them
+	const APawn* PlayerPawn = GetWorld() -> GetFirstPlayerController() ?
+		GetWorld() -> GetFirstPlayerController() -> GetPawn() : nullptr;
+	const FVector Origin = PlayerPawn ? PlayerPawn -> GetActorLocation() : FVector::ZeroVector;
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	const int32 CharacterColumns = FMath::Max(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumCharacters))), 1);
+	for(int32 Index = 0; Index < NumCharacters; Index++)
+	{
+		const FVector Offset{ (Index % CharacterColumns - CharacterColumns / 2) * 300.f,
+			(Index / CharacterColumns - CharacterColumns / 2) * 300.f, 0.f };
+		const FRotator Rotation{ 0.f, Offset.IsNearlyZero() ? 0.f : Offset.Rotation().Yaw, 0.f };
+		AShooterCharacter* Character = GetWorld() -> SpawnActor<AShooterCharacter>(CharacterClass,
+			Origin + Offset + FVector(300.f, 0.f, 0.f), Rotation, SpawnParameters);
+		if(Character == nullptr) continue;
+
+		Character -> SpawnDefaultController();
+		Character -> SetFireButtonPressed(true);
+		Characters.Add(Character);
+	}
+	LastAmmo.Init(0, Characters.Num());
+
+	UClass* ItemClass = GetDefault<AShooterCharacter>(CharacterClass) -> GetDefaultWeaponClass().LoadSynchronous();
+	if(ItemClass == nullptr)
+	{
+		NumItems = 0;
+		return;
+	}
+	const int32 ItemColumns = FMath::Max(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumItems))), 1);
+	const float ItemRingOffset = (CharacterColumns / 2 + 2) * 300.f;
+	for(int32 Index = 0; Index < NumItems; Index++)
+	{
+		const FVector Offset{ ItemRingOffset + (Index % ItemColumns) * 200.f, (Index / ItemColumns) * 200.f, 0.f };
+		GetWorld() -> SpawnActor<AItem>(ItemClass, Origin + Offset, FRotator::ZeroRotator, SpawnParameters);
+	}
+}
+
+int32 UShooterBenchmarkSubsystem::GatherShots()
+{
+	int32 ShotsFired = 0;
+	for(int32 Index = 0; Index < Characters.Num(); Index++)
+	{
+		AWeapon* Weapon = IsValid(Characters[Index]) ? Characters[Index] -> GetEquippedWeapon() : nullptr;
+		if(Weapon == nullptr) continue;
+
+		ShotsFired += FMath::Max(LastAmmo[Index] - Weapon -> GetAmmo(), 0);
+		Weapon -> SetAmmo(Weapon -> GetMagazineCapacity());
+		LastAmmo[Index] = Weapon -> GetAmmo();
+	}
+	return ShotsFired;
+}
+
+void UShooterBenchmarkSubsystem::KeepCharactersFiring()
+{
+	// The default weapon is equipped once the combat assets are streamed in, after the button was pressed
+	for(AShooterCharacter* Character : Characters)
+	{
+		if(IsValid(Character) && Character -> IsFireButtonPressed() && Character -> GetEquippedWeapon() &&
+			Character -> GetCombatState() == ECombatState::ECS_Unoccupied)
+		{
+			Character -> SetFireButtonPressed(false);
+			Character -> SetFireButtonPressed(true);
+		}
+	}
+}
+
+int32 UShooterBenchmarkSubsystem::CountMontageInstances() const
+{
+	int32 MontageInstances = 0;
+	for(const AShooterCharacter* Character : Characters)
+	{
+		const UAnimInstance* AnimInstance = IsValid(Character) ? Character -> GetMesh() -> GetAnimInstance() : nullptr;
+		if(AnimInstance)
+		{
+			MontageInstances += AnimInstance -> MontageInstances.Num();
+		}
+	}
+	return MontageInstances;
+}
+
+void UShooterBenchmarkSubsystem::FinishBenchmark()
+{
+	bRunning = false;
+	bFinished = true;
+#if CSV_PROFILER
+	FCsvProfiler::Get() -> EndCapture();
+#endif
+
+	if(FFileHelper::SaveStringArrayToFile(Rows, *CSVPath))
+	{
+		UE_LOG(LogShooter, Display, TEXT("Benchmark finished, %d frames written to %s"), Rows.Num() - 1, *CSVPath);
+	}
+	else
+	{
+		UE_LOG(LogShooter, Error, TEXT("Benchmark finished, but %s couldn't be written"), *CSVPath);
+	}
+	Rows.Empty();
+
+	if(TotalShotsFired == 0)
+	{
+		UE_LOG(LogShooter, Error, TEXT("Benchmark failed, no shots were fired"));
+	}
+	else
+	{
+		UE_LOG(LogShooter, Display, TEXT("Benchmark fired %d shots"), TotalShotsFired);
+	}
+
+	if(!bQuitWhenFinished)
+	{
+		FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+		return;
+	}
+	// A run where nobody fired measured nothing, scripts checking the exit code must not take its numbers
+	if(TotalShotsFired == 0)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+	}
+	else
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
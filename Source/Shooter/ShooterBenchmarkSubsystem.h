@@ -0,0 +1,112 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterBenchmarkSubsystem.generated.h"
+
+class AShooterCharacter;
+class AItem;
+
+/** Setup of a benchmark run */
+struct FShooterBenchmarkSettings
+{
+	int32 NumCharacters{ 32 };
+	int32 NumItems{ 100 };
+
+	/** Simulated seconds to run for, and simulated frames per second */
+	float Duration{ 60.f };
+	float FrameRate{ 30.f };
+
+	/** Where the CSV rows are written, Saved/Profiling/ShooterBenchmark.csv if empty */
+	FString CSVPath;
+
+	/** Quit once the benchmark is finished, otherwise the world keeps running with its usual time step */
+	bool bQuitWhenFinished{ true };
+};
+
+/**
+ * Headless benchmark, started when the game runs with -ShooterBenchmark, e.g.
+ *	Shooter /Game/Maps/Benchmark -game -nullrhi -unattended -ShooterBenchmark -BenchCharacters=64 -BenchItems=200
+ * Spawns characters firing continuously and items waiting for pickup on a fixed grid, then steps the world with a
+ * fixed time step and a fixed random seed for -BenchDuration simulated seconds. Writes one CSV row per frame to
+ * Saved/Profiling/ShooterBenchmark.csv (or -BenchCSV=), captures the engine's CSV profile alongside it, then quits,
+ * with exit code 1 if no character fired.
+ * Add -dpcvars=Shooter.Anim.ProceduralFireRecoil=0 to measure the per-shot montages against the procedural fire recoil,
+ * the CSV profile times both (PlayFireAnimation, FireRecoilUpdate) next to the montage instances they leave alive.
+ * Automation tests start shorter runs with StartBenchmark.
+ */
+UCLASS()
+class SHOOTER_API UShooterBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UShooterBenchmarkSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Spawn the characters and the items of Settings in this world and start measuring */
+	void StartBenchmark(const FShooterBenchmarkSettings& Settings);
+
+	FORCEINLINE bool IsRunning() const { return bRunning; }
+	FORCEINLINE bool HasFinished() const { return bFinished; }
+	FORCEINLINE int32 GetTotalShotsFired() const { return TotalShotsFired; }
+	FORCEINLINE const FString& GetCSVPath() const { return CSVPath; }
+
+private:
+	/** Spawn the firing characters and the items on their grids */
+	void SpawnActors();
+
+	/** Count the shots fired since last frame, and refill the magazines so the characters never stop to reload */
+	int32 GatherShots();
+
+	/** Press the fire button again for the characters holding it but not firing, e.g. armed after the first press */
+	void KeepCharactersFiring();
+
+	/** Returns the montage instances alive on the characters, the fire animation's allocations */
+	int32 CountMontageInstances() const;
+
+	/** Write the CSV rows, and quit if asked to */
+	void FinishBenchmark();
+
+	/** Characters firing during the benchmark */
+	UPROPERTY()
+	TArray<AShooterCharacter*> Characters;
+
+	/** Ammo of each character's weapon at the end of last frame */
+	TArray<int32> LastAmmo;
+
+	/** One line per frame, written when the benchmark ends */
+	TArray<FString> Rows;
+
+	int32 NumCharacters;
+	int32 NumItems;
+
+	/** Simulated seconds to run for */
+	float Duration;
+
+	/** Simulated seconds since the benchmark started */
+	float ElapsedTime;
+
+	/** Real time of the previous frame */
+	double LastFrameTime;
+
+	/** Shots fired by all the characters since the benchmark started, a run without any failed */
+	int32 TotalShotsFired;
+
+	FString CSVPath;
+
+	/** Fixed time step of the engine before the benchmark, restored when it doesn't quit */
+	bool bPreviousUseFixedTimeStep;
+	double PreviousFixedDeltaTime;
+
+	bool bQuitWhenFinished;
+	bool bRunning;
+	bool bFinished;
+};
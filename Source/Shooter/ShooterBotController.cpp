@@ -0,0 +1,281 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterBotController.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "ShooterBotSubsystem.h"
+#include "PickupIndexSubsystem.h"
+#include "Item.h"
+#include "Weapon.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Think"), STAT_BotThink, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Bot Act"), STAT_BotAct, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarBotsThinkInterval(
+	TEXT("Shooter.Bots.ThinkInterval"),
+	0.5f,
+	TEXT("Seconds between two target searches of a bot."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotsEngageRange(
+	TEXT("Shooter.Bots.EngageRange"),
+	4000.f,
+	TEXT("Combat bots shoot at characters closer than this."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotsLootRange(
+	TEXT("Shooter.Bots.LootRange"),
+	3000.f,
+	TEXT("Loot bots walk to items closer than this."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotsTurnRate(
+	TEXT("Shooter.Bots.TurnRate"),
+	8.f,
+	TEXT("Interpolation speed of the bots' aim."),
+	ECVF_Default);
+
+/** Distance combat bots try to keep from their target */
+static constexpr float CombatDistance = 800.f;
+
+/** Radius around the spawn that wandering bots walk in */
+static constexpr float WanderRadius = 2000.f;
+
+AShooterBotController::AShooterBotController():
+	ShooterCharacter(nullptr),
+	Behavior(EBotBehavior::EBB_Combat),
+	HomeLocation(FVector::ZeroVector),
+	MoveGoal(FVector::ZeroVector),
+	ThinkCountdown(0.f),
+	StrafeCountdown(0.f),
+	StrafeDirection(1.f)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// The bot turns the control rotation itself, the pawn's orientation follows it
+	bSetControlRotationFromPawnOrientation = false;
+}
+
+void AShooterBotController::SetBehavior(EBotBehavior NewBehavior, int32 Seed)
+{
+	Behavior = NewBehavior;
+	Random.Initialize(Seed);
+	// Spread the searches of the bots over the think interval
+	ThinkCountdown = Random.FRand() * CVarBotsThinkInterval.GetValueOnGameThread();
+	TargetCharacter = nullptr;
+	TargetItem = nullptr;
+}
+
+void AShooterBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	ShooterCharacter = Cast<AShooterCharacter>(InPawn);
+	HomeLocation = InPawn -> GetActorLocation();
+	MoveGoal = HomeLocation;
+	SetControlRotation(InPawn -> GetActorRotation());
+}
+
+void AShooterBotController::OnUnPossess()
+{
+	if(ShooterCharacter)
+	{
+		ShooterCharacter -> SetFireButtonPressed(false);
+	}
+	ShooterCharacter = nullptr;
+	TargetCharacter = nullptr;
+	TargetItem = nullptr;
+
+	Super::OnUnPossess();
+}
+
+void AShooterBotController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if(ShooterCharacter == nullptr) return;
+
+	ThinkCountdown -= DeltaTime;
+	if(ThinkCountdown <= 0.f)
+	{
+		ThinkCountdown += FMath::Max(CVarBotsThinkInterval.GetValueOnGameThread(), 0.05f);
+		Think();
+	}
+	Act(DeltaTime);
+}
+
+void AShooterBotController::Think()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_BotThink);
+
+	switch(Behavior)
+	{
+	case EBotBehavior::EBB_Combat:
+		ThinkCombat(); break;
+	case EBotBehavior::EBB_Loot:
+		ThinkLoot(); break;
+	default:
+		break;
+	}
+	if(FVector::DistSquared2D(ShooterCharacter -> GetActorLocation(), MoveGoal) < FMath::Square(200.f))
+	{
+		PickWanderGoal();
+	}
+}
+
+void AShooterBotController::ThinkCombat()
+{
+	TargetCharacter = FindClosestCharacter(CVarBotsEngageRange.GetValueOnGameThread());
+}
+
+void AShooterBotController::ThinkLoot()
+{
+	if(!TargetItem.IsValid() || TargetItem -> GetItemState() != EItemState::EIS_Pickup)
+	{
+		TargetItem = FindClosestItem(CVarBotsLootRange.GetValueOnGameThread());
+	}
+
+	// Make room for the item about to be picked up, like a player swapping a weapon for a better one
+	const AItem* Item = TargetItem.Get();
+	const TArray<AWeapon*>& Inventory = ShooterCharacter -> GetInventory();
+	if(Item == nullptr || Item -> GetItemState() != EItemState::EIS_Pickup ||
+		Inventory.Num() == 0 || Inventory.Contains(nullptr)) return;
+
+	const float PickupRange = Item -> GetAreaSphere() -> GetScaledSphereRadius() +
+		ShooterCharacter -> GetCapsuleComponent() -> GetScaledCapsuleRadius();
+	if(FVector::DistSquared(Item -> GetActorLocation(), ShooterCharacter -> GetActorLocation()) <=
+		FMath::Square(PickupRange))
+	{
+		ShooterCharacter -> DropButtonPressed();
+	}
+}
+
+void AShooterBotController::PickWanderGoal()
+{
+	const float Angle = Random.FRandRange(0.f, 2.f * PI);
+	const float Distance = Random.FRandRange(0.f, WanderRadius);
+	MoveGoal = HomeLocation + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Distance;
+}
+
+void AShooterBotController::Act(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_BotAct);
+
+	AShooterCharacter* Target = TargetCharacter.Get();
+	AItem* Item = TargetItem.Get();
+	if(Target && Behavior == EBotBehavior::EBB_Combat)
+	{
+		// Keep some distance and strafe around the target while shooting at it
+		const float AimError = AimAt(Target -> GetActorLocation(), DeltaTime);
+		const float Distance = FVector::Dist2D(ShooterCharacter -> GetActorLocation(), Target -> GetActorLocation());
+		ShooterCharacter -> MoveForward(Distance > CombatDistance ? 1.f : -0.5f);
+
+		StrafeCountdown -= DeltaTime;
+		if(StrafeCountdown <= 0.f)
+		{
+			StrafeCountdown = Random.FRandRange(1.f, 3.f);
+			StrafeDirection = Random.FRand() < 0.5f ? -1.f : 1.f;
+		}
+		ShooterCharacter -> MoveRight(StrafeDirection);
+
+		const AWeapon* Weapon = ShooterCharacter -> GetEquippedWeapon();
+		if(Weapon && Weapon -> GetAmmo() == 0)
+		{
+			ShooterCharacter -> FireButtonReleased();
+			ShooterCharacter -> ReloadButtonPressed();
+		}
+		else if(AimError < 10.f)
+		{
+			if(!ShooterCharacter -> bFireButtonPressed)
+			{
+				ShooterCharacter -> FireButtonPressed();
+			}
+		}
+		else if(ShooterCharacter -> bFireButtonPressed)
+		{
+			ShooterCharacter -> FireButtonReleased();
+		}
+		return;
+	}
+	if(ShooterCharacter -> bFireButtonPressed)
+	{
+		ShooterCharacter -> FireButtonReleased();
+	}
+
+	if(Item && Behavior == EBotBehavior::EBB_Loot && Item -> GetItemState() == EItemState::EIS_Pickup)
+	{
+		// Look at the item until the pickup trace finds it, then pick it up
+		AimAt(Item -> GetActorLocation(), DeltaTime);
+		if(ShooterCharacter -> PickupTraceHitItem == Item)
+		{
+			ShooterCharacter -> SelectButtonPressed();
+			TargetItem = nullptr;
+		}
+		else
+		{
+			ShooterCharacter -> MoveForward(1.f);
+		}
+		return;
+	}
+
+	AimAt(MoveGoal + FVector(0.f, 0.f, ShooterCharacter -> BaseEyeHeight), DeltaTime);
+	ShooterCharacter -> MoveForward(1.f);
+}
+
+float AShooterBotController::AimAt(const FVector& Location, float DeltaTime)
+{
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	ShooterCharacter -> GetActorEyesViewPoint(ViewLocation, ViewRotation);
+	const FRotator DesiredRotation = (Location - ViewLocation).Rotation();
+	SetControlRotation(FMath::RInterpTo(GetControlRotation(), DesiredRotation, DeltaTime,
+		CVarBotsTurnRate.GetValueOnGameThread()));
+	return FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(
+		GetControlRotation().Vector() | DesiredRotation.Vector(), -1.f, 1.f)));
+}
+
+AShooterCharacter* AShooterBotController::FindClosestCharacter(float Range) const
+{
+	const UShooterBotSubsystem* Bots = GetWorld() -> GetSubsystem<UShooterBotSubsystem>();
+	if(Bots == nullptr) return nullptr;
+
+	AShooterCharacter* Closest = nullptr;
+	float ClosestDistanceSquared = FMath::Square(Range);
+	for(AShooterCharacter* Character : Bots -> GetCombatants())
+	{
+		if(Character == nullptr || Character == ShooterCharacter) continue;
+
+		const float DistanceSquared = FVector::DistSquared(Character -> GetActorLocation(),
+			ShooterCharacter -> GetActorLocation());
+		if(DistanceSquared < ClosestDistanceSquared)
+		{
+			Closest = Character;
+			ClosestDistanceSquared = DistanceSquared;
+		}
+	}
+	return Closest;
+}
+
+AItem* AShooterBotController::FindClosestItem(float Range) const
+{
+	const UPickupIndexSubsystem* PickupIndex = GetWorld() -> GetSubsystem<UPickupIndexSubsystem>();
+	if(PickupIndex == nullptr) return nullptr;
+
+	TArray<AItem*> Items;
+	PickupIndex -> GatherItems(ShooterCharacter -> GetActorLocation(), Range, Items);
+	AItem* Closest = nullptr;
+	float ClosestDistanceSquared = MAX_flt;
+	for(AItem* Item : Items)
+	{
+		const float DistanceSquared = FVector::DistSquared(Item -> GetActorLocation(),
+			ShooterCharacter -> GetActorLocation());
+		if(DistanceSquared < ClosestDistanceSquared)
+		{
+			Closest = Item;
+			ClosestDistanceSquared = DistanceSquared;
+		}
+	}
+	return Closest;
+}
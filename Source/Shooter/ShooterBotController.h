@@ -0,0 +1,100 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "ShooterBotController.generated.h"
+
+class AShooterCharacter;
+class AItem;
+
+UENUM(BlueprintType)
+enum class EBotBehavior : uint8
+{
+	/** Strafe around the closest character in range and shoot at it */
+	EBB_Combat UMETA(DisplayName = "Combat"),
+	/** Walk to the closest item, pick it up, drop a weapon for it when the inventory is full */
+	EBB_Loot UMETA(DisplayName = "Loot"),
+	/** Walk between random points around the spawn */
+	EBB_Wander UMETA(DisplayName = "Wander"),
+
+	EBB_Max UMETA(DisplayName = "DefaultMax")
+};
+
+/**
+ * Drives a shooter character through the same functions its input bindings call (MoveForward, MoveRight,
+ * FireButtonPressed, ReloadButtonPressed, SelectButtonPressed, DropButtonPressed), so bots load the game
+ * thread the way players do. Spawned by UShooterBotSubsystem.
+ */
+UCLASS()
+class SHOOTER_API AShooterBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AShooterBotController();
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Set the behavior, and the seed of the bot's random decisions */
+	void SetBehavior(EBotBehavior NewBehavior, int32 Seed);
+
+	FORCEINLINE EBotBehavior GetBehavior() const { return Behavior; }
+
+protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+
+private:
+	/** Pick a new target and move goal, every ThinkInterval */
+	void Think();
+
+	void ThinkCombat();
+	void ThinkLoot();
+
+	/** Pick a random point around HomeLocation to walk to */
+	void PickWanderGoal();
+
+	/** Turn, move and press the buttons toward the current target, every frame */
+	void Act(float DeltaTime);
+
+	/** Turn the control rotation toward Location, returns the remaining angle in degrees */
+	float AimAt(const FVector& Location, float DeltaTime);
+
+	/** Returns the closest other character within Range, or nullptr */
+	AShooterCharacter* FindClosestCharacter(float Range) const;
+
+	/** Returns the closest item waiting for pickup within Range, or nullptr */
+	AItem* FindClosestItem(float Range) const;
+
+	/** Character possessed by this bot */
+	UPROPERTY()
+	AShooterCharacter* ShooterCharacter;
+
+	/** Character shot at in combat */
+	TWeakObjectPtr<AShooterCharacter> TargetCharacter;
+
+	/** Item walked to when looting */
+	TWeakObjectPtr<AItem> TargetItem;
+
+	EBotBehavior Behavior;
+
+	/** Random decisions of this bot, seeded by the spawner so runs repeat */
+	FRandomStream Random;
+
+	/** Where the bot spawned, it wanders around it */
+	FVector HomeLocation;
+
+	/** Point the bot walks to when it has no target */
+	FVector MoveGoal;
+
+	/** Seconds until the next Think */
+	float ThinkCountdown;
+
+	/** Seconds until the strafing direction changes */
+	float StrafeCountdown;
+
+	/** Current strafing input, -1 or 1 */
+	float StrafeDirection;
+};
@@ -0,0 +1,236 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterBotSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "ActorPoolSubsystem.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bots"), STAT_Bots, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot Respawns"), STAT_BotRespawns, STATGROUP_Shooter);
+
+/** Distance between two bots spawned around the same origin */
+static constexpr float BotSpacing = 250.f;
+
+UShooterBotSubsystem::UShooterBotSubsystem():
+	CharacterClass(nullptr),
+	NumBots(0),
+	BotLifetime(0.f),
+	NumSpawns(0)
+{
+
+}
+
+bool UShooterBotSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	int32 Count = 0;
+	return World && World -> IsGameWorld() && FParse::Value(FCommandLine::Get(), TEXT("ShooterBots="), Count);
+}
+
+void UShooterBotSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Bots live on the server, clients see them as any other character
+	const AGameModeBase* GameMode = InWorld.GetAuthGameMode();
+	CharacterClass = GameMode ? GameMode -> DefaultPawnClass.Get() : nullptr;
+	if(CharacterClass == nullptr || !CharacterClass -> IsChildOf(AShooterCharacter::StaticClass()))
+	{
+		UE_LOG(LogShooter, Error, TEXT("Bots need a game mode whose default pawn is a shooter character"));
+		return;
+	}
+
+	TArray<float> BehaviorWeights;
+	ParseCommandLine(BehaviorWeights);
+	float TotalWeight = 0.f;
+	for(const float Weight : BehaviorWeights)
+	{
+		TotalWeight += Weight;
+	}
+
+	for(TActorIterator<APlayerStart> Iterator(&InWorld); Iterator; ++Iterator)
+	{
+		SpawnOrigins.Add(Iterator -> GetActorTransform());
+	}
+	if(SpawnOrigins.Num() == 0)
+	{
+		SpawnOrigins.Add(FTransform::Identity);
+	}
+
+	int32 BehaviorCounts[static_cast<int32>(EBotBehavior::EBB_Max)] = {};
+	Bots.Reserve(NumBots);
+	for(int32 Index = 0; Index < NumBots; Index++)
+	{
+		// Weighted pick of the behavior
+		int32 Behavior = 0;
+		float Pick = Random.FRand() * TotalWeight;
+		while(Behavior < BehaviorWeights.Num() - 1 && Pick >= BehaviorWeights[Behavior])
+		{
+			Pick -= BehaviorWeights[Behavior];
+			Behavior++;
+		}
+		BehaviorCounts[Behavior]++;
+
+		FShooterBotEntry& Entry = Bots.AddDefaulted_GetRef();
+		Entry.Behavior = static_cast<EBotBehavior>(Behavior);
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		Entry.Controller = InWorld.SpawnActor<AShooterBotController>(SpawnParameters);
+		SpawnBotCharacter(Entry);
+	}
+	SET_DWORD_STAT(STAT_Bots, Bots.Num());
+
+	UE_LOG(LogShooter, Display, TEXT("Spawned %d bots: %d combat, %d loot, %d wander, lifetime %.0fs"), Bots.Num(),
+		BehaviorCounts[static_cast<int32>(EBotBehavior::EBB_Combat)],
+		BehaviorCounts[static_cast<int32>(EBotBehavior::EBB_Loot)],
+		BehaviorCounts[static_cast<int32>(EBotBehavior::EBB_Wander)], BotLifetime);
+}
+
+void UShooterBotSubsystem::ParseCommandLine(TArray<float>& OutBehaviorWeights)
+{
+	FParse::Value(FCommandLine::Get(), TEXT("ShooterBots="), NumBots);
+	NumBots = FMath::Max(NumBots, 0);
+	FParse::Value(FCommandLine::Get(), TEXT("BotLifetime="), BotLifetime);
+	int32 Seed = 0x5EED;
+	FParse::Value(FCommandLine::Get(), TEXT("BotSeed="), Seed);
+	Random.Initialize(Seed);
+
+	// -BotMix=Combat:3,Loot:1,Wander:1, missing behaviors get no bots, every bot fights without it
+	OutBehaviorWeights.Init(0.f, static_cast<int32>(EBotBehavior::EBB_Max));
+	FString Mix;
+	if(!FParse::Value(FCommandLine::Get(), TEXT("BotMix="), Mix, false))
+	{
+		OutBehaviorWeights[static_cast<int32>(EBotBehavior::EBB_Combat)] = 1.f;
+		return;
+	}
+	const UEnum* BehaviorEnum = StaticEnum<EBotBehavior>();
+	TArray<FString> Parts;
+	Mix.ParseIntoArray(Parts, TEXT(","));
+	for(const FString& Part : Parts)
+	{
+		FString Name, Weight;
+		if(!Part.Split(TEXT(":"), &Name, &Weight))
+		{
+			Name = Part;
+			Weight = TEXT("1");
+		}
+		const int64 Value = BehaviorEnum -> GetValueByNameString(TEXT("EBB_") + Name.TrimStartAndEnd());
+		if(Value == INDEX_NONE || Value >= static_cast<int64>(EBotBehavior::EBB_Max))
+		{
+			UE_LOG(LogShooter, Warning, TEXT("Unknown bot behavior %s in -BotMix"), *Name);
+			continue;
+		}
+		OutBehaviorWeights[Value] = FMath::Max(FCString::Atof(*Weight), 0.f);
+	}
+	float TotalWeight = 0.f;
+	for(const float BehaviorWeight : OutBehaviorWeights)
+	{
+		TotalWeight += BehaviorWeight;
+	}
+	if(TotalWeight <= 0.f)
+	{
+		OutBehaviorWeights[static_cast<int32>(EBotBehavior::EBB_Combat)] = 1.f;
+	}
+}
+
+void UShooterBotSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float Now = GetWorld() -> GetTimeSeconds();
+	Combatants.Reset();
+	for(FShooterBotEntry& Entry : Bots)
+	{
+		if(BotLifetime > 0.f && Entry.Controller.IsValid() && Now - Entry.SpawnTime >= BotLifetime)
+		{
+			RespawnBot(Entry);
+		}
+		if(Entry.Character.IsValid())
+		{
+			Combatants.Add(Entry.Character.Get());
+		}
+	}
+	for(FConstPlayerControllerIterator Iterator = GetWorld() -> GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		AShooterCharacter* Character = Iterator -> Get() ? Iterator -> Get() -> GetPawn<AShooterCharacter>() : nullptr;
+		if(Character)
+		{
+			Combatants.Add(Character);
+		}
+	}
+}
+
+bool UShooterBotSubsystem::IsTickable() const
+{
+	return Bots.Num() > 0;
+}
+
+TStatId UShooterBotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterBotSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterBotSubsystem::SpawnBotCharacter(FShooterBotEntry& Entry)
+{
+	AShooterBotController* Controller = Entry.Controller.Get();
+	if(Controller == nullptr) return;
+
+	const FTransform SpawnTransform = GetNextSpawnTransform();
+	AShooterCharacter* Character;
+	UActorPoolSubsystem* ActorPool = GetWorld() -> GetSubsystem<UActorPoolSubsystem>();
+	if(ActorPool)
+	{
+		Character = ActorPool -> AcquireActor<AShooterCharacter>(CharacterClass, SpawnTransform);
+	}
+	else
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		Character = GetWorld() -> SpawnActor<AShooterCharacter>(CharacterClass, SpawnTransform, SpawnParameters);
+	}
+	if(Character == nullptr) return;
+
+	Controller -> Possess(Character);
+	Controller -> SetBehavior(Entry.Behavior, static_cast<int32>(Random.GetUnsignedInt()));
+	Entry.Character = Character;
+	Entry.SpawnTime = GetWorld() -> GetTimeSeconds();
+}
+
+void UShooterBotSubsystem::RespawnBot(FShooterBotEntry& Entry)
+{
+	AShooterCharacter* Character = Entry.Character.Get();
+	if(Character)
+	{
+		Entry.Controller -> UnPossess();
+		UActorPoolSubsystem* ActorPool = GetWorld() -> GetSubsystem<UActorPoolSubsystem>();
+		if(ActorPool)
+		{
+			ActorPool -> ReleaseActor(Character);
+		}
+		else
+		{
+			Character -> Destroy();
+		}
+	}
+	Entry.Character = nullptr;
+	SpawnBotCharacter(Entry);
+	INC_DWORD_STAT(STAT_BotRespawns);
+}
+
+FTransform UShooterBotSubsystem::GetNextSpawnTransform()
+{
+	// Fill rings around each origin in turn, facing outward, so bots don't spawn inside each other.
+	// Respawns reuse the slots once every bot has one
+	const int32 Spawn = NumSpawns++ % FMath::Max(NumBots, 1);
+	const FTransform& Origin = SpawnOrigins[Spawn % SpawnOrigins.Num()];
+	const int32 Slot = Spawn / SpawnOrigins.Num() + 1;
+	const int32 Ring = FMath::CeilToInt((FMath::Sqrt(1.f + 8.f * Slot / 6.f) - 1.f) / 2.f);
+	const float Angle = Slot * 2.f * PI / (6 * Ring) + Random.FRandRange(-0.1f, 0.1f);
+	const FVector Direction{ FMath::Cos(Angle), FMath::Sin(Angle), 0.f };
+	return FTransform(Direction.Rotation(), Origin.GetLocation() + Direction * Ring * BotSpacing);
+}
@@ -0,0 +1,85 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterBotController.h"
+#include "ShooterBotSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** A bot spawned by UShooterBotSubsystem */
+struct FShooterBotEntry
+{
+	TWeakObjectPtr<AShooterBotController> Controller;
+	TWeakObjectPtr<AShooterCharacter> Character;
+	EBotBehavior Behavior{ EBotBehavior::EBB_Wander };
+
+	/** World time the current character spawned at */
+	float SpawnTime{ 0.f };
+};
+
+/**
+ * Load generator, created only when the game runs with -ShooterBots=, e.g. headless on Linux:
+ *	Shooter /Game/Maps/Arena -game -nullrhi -nosound -unattended -ShooterBots=500 -BotMix=Combat:3,Loot:1,Wander:1
+ * Spawns bots of the game mode's default pawn class around the player starts, each possessed by an
+ * AShooterBotController with a behavior picked from the -BotMix weights (Combat, Loot, Wander). With -BotLifetime=
+ * bots respawn elsewhere after that many seconds, through UActorPoolSubsystem. -BotSeed= changes their decisions.
+ * Add -ShooterBenchmark -BenchCharacters=0 to record the frame times to CSV.
+ */
+UCLASS()
+class SHOOTER_API UShooterBotSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UShooterBotSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Characters bots can fight: the bots and the players. Refreshed every frame */
+	FORCEINLINE const TArray<AShooterCharacter*>& GetCombatants() const { return Combatants; }
+
+private:
+	/** Read the bot count and behavior weights from the command line */
+	void ParseCommandLine(TArray<float>& OutBehaviorWeights);
+
+	/** Spawn a character for Entry at the next spawn location and possess it */
+	void SpawnBotCharacter(FShooterBotEntry& Entry);
+
+	/** Send the character of Entry back to the pool, and spawn a new one */
+	void RespawnBot(FShooterBotEntry& Entry);
+
+	/** Returns the next spawn location, spread on rings around the player starts */
+	FTransform GetNextSpawnTransform();
+
+	/** Bots spawned by the subsystem */
+	TArray<FShooterBotEntry> Bots;
+
+	/** See GetCombatants */
+	UPROPERTY()
+	TArray<AShooterCharacter*> Combatants;
+
+	/** Default pawn class of the game mode */
+	UPROPERTY()
+	UClass* CharacterClass;
+
+	/** Locations of the player starts, or the world origin */
+	TArray<FTransform> SpawnOrigins;
+
+	/** Decisions of the spawner, seeded so runs repeat */
+	FRandomStream Random;
+
+	int32 NumBots;
+
+	/** Seconds before a bot respawns, 0 keeps it forever */
+	float BotLifetime;
+
+	/** Number of spawns so far, spreads the bots around the spawn origins */
+	int32 NumSpawns;
+};
@@ -1,718 +1,1588 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-
-#include "ShooterCharacter.h"
-
-#include "Item.h"
-#include "Weapon.h"
-#include "GameFramework/SpringArmComponent.h"
-#include "Camera/CameraComponent.h"
-#include "Components/WidgetComponent.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "Kismet/GameplayStatics.h"
-#include "Sound/SoundCue.h"
-#include "Engine/SkeletalMeshSocket.h"
-#include "Particles/ParticleSystemComponent.h"
-
-// Sets default values
-AShooterCharacter::AShooterCharacter():
-	// Base rates for turning/looking up
-	BaseTurnRate(45.f),
-	BaseLookUpRate(41.f),
-	// Turn rates for aiming/not aiming
-	HipTurnRate(BaseTurnRate),
-	HipLookUpRate(BaseLookUpRate),
-	AimingTurnRate(20.f),
-	AimingLookUpRate(20.f),
-	// Mouse look sensitivity scale factors
-	MouseHipTurnRate(1.f),
-	MouseHipLookUpRate(1.f),
-	MouseAimingTurnRate(0.6f),
-	MouseAimingLookUpRate(0.6f),
-	// Aiming
-	bAiming(false),
-	// Camera field of view values
-	CameraDefaultFOV(0.f), // Set in BeginPlay
-	CameraZoomedFOV(35.f),
-	CameraCurrentFOV(0.f),
-	ZoomInterpSpeed(22.f),
-	// Crosshair spread factors
-	CrosshairSpreadingMultiplier(0.f),
-	CrosshairVelocityFactor(0.f),
-	CrosshairInAirFactor(0.f),
-	CrosshairAimingFactor(0.f),
-	CrosshairShootingFactor(0.f),
-	// Bullet fire variables
-	bFireButtonPressed(false),
-	bShouldFire(true),
-	bFiringBullet(false),
-    AutomaticFireRate(0.1f),
-	CrosshairShootingDuration(0.05f),
-	// Item trace variables
-	bShouldTraceForItems(false),
-	OverlappedItemCount(0),
-	// Camera pickup interpolation variables
-	CameraPickupInterpDistance(250.f),
-	CameraPickupInterpElevation(65.f),
-	// Starting ammo amounts
-	Starting9mmAmmo(80),
-	StartingARAmmo(120),
-	// Combat state
-	CombatState(ECombatState::ECS_Unoccupied)
-	
-{
-	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
-	// Create a CameraBoom (pulls in towards the character if there is a collision)
-	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
-	CameraBoom -> SetupAttachment(RootComponent);
-	CameraBoom -> TargetArmLength = 180.f; // The camera follows at this distance behind the character
-	CameraBoom -> bUsePawnControlRotation = true; // Rotate the arm based on the controller
-	CameraBoom -> SocketOffset = FVector{ 0.f, 50.f, 70.f };
-
-	// Create a FollowCamera
-	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
-	FollowCamera -> SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
-	FollowCamera -> bUsePawnControlRotation = false;
-
-	// Don't rotate when the controller rotates. Let the controller only affect camera.
-	bUseControllerRotationPitch = false;
-	bUseControllerRotationRoll = true;
-	bUseControllerRotationYaw = false;
-
-	// Configure character movement
-	GetCharacterMovement() -> bOrientRotationToMovement = false; // Character moves at the direction of input...
-	GetCharacterMovement() -> RotationRate = FRotator(0.f, 540.f, 0.f); //... at this rate
-	GetCharacterMovement() -> JumpZVelocity = 600.f;
-	GetCharacterMovement() -> AirControl = 0.1f;
-
-	// Create a ClipSceneComponent
-	ClipSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("ClipSceneComponent"));
-}
-
-void AShooterCharacter::BeginPlay()
-{
-	Super::BeginPlay();
-
-	if(FollowCamera)
-	{
-		CameraDefaultFOV = GetFollowCamera() -> FieldOfView;
-		CameraCurrentFOV = CameraDefaultFOV;
-	}
-	// Spawn the default Weapon and equip it
-	EquipWeapon(SpawnDefaultWeapon());
-	// Initialize AmmoMap with starting values
-	InitializeAmmoMap();
-}
-
-void AShooterCharacter::MoveForward(float Value)
-{
-	if((Controller != nullptr) && (Value != 0.0f))
-	{
-		// find out which way is forward
-		FRotator Rotation{ Controller -> GetControlRotation() };
-		FRotator YawRotation{ 0, Rotation.Yaw, 0 };
-
-		FVector Direction{ FRotationMatrix{YawRotation}.GetUnitAxis(EAxis::X) };
-		AddMovementInput(Direction, Value);
-	}
-}
-
-void AShooterCharacter::MoveRight(float Value)
-{
-	if((Controller != nullptr) && (Value != 0.0f))
-	{
-		// find out which way is right
-		FRotator Rotation{ Controller -> GetControlRotation() };
-		FRotator YawRotation{ 0, Rotation.Yaw, 0 };
-
-		FVector Direction{ FRotationMatrix{ YawRotation }.GetUnitAxis(EAxis::Y) };
-		AddMovementInput(Direction, Value);
-	}
-}
-
-void AShooterCharacter::TurnAtRate(float Rate)
-{
-	// Calculate delta for this frame from the rate information
-	AddControllerYawInput(Rate * BaseTurnRate * GetWorld() -> GetDeltaSeconds()); // deg/sec * sec/frame
-}
-
-
-void AShooterCharacter::LookUpRate(float Rate)
-{
-	// Calculate delta for this frame from the rate information
-	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld() -> GetDeltaSeconds()); // deg/sec * sec/frame
-}
-
-void AShooterCharacter::Turn(float Value)
-{
-	const float TurnScaleFactor = bAiming ? MouseAimingTurnRate : MouseHipTurnRate;
-	AddControllerYawInput(Value * TurnScaleFactor);
-}
-
-void AShooterCharacter::LookUp(float Value)
-{
-	const float LookUpScaleFactor = bAiming ? MouseAimingLookUpRate : MouseHipLookUpRate;
-	AddControllerPitchInput(Value * LookUpScaleFactor);
-}
-
-void AShooterCharacter::FireWeapon()
-{
-	if(EquippedWeapon == nullptr) return; // if we are holding a weapon
-	if(CombatState != ECombatState::ECS_Unoccupied) return; // if the weapon is available for firing
-
-	if(WeaponHasAmmo())
-	{
-		// Visuals
-		PlayFireSound();
-		SendBullet();
-		PlayHipFireMontage();
-		
-		// Decrement ammo
-		EquippedWeapon -> DecrementAmmo();
-
-		// Start bullet fire timer for crosshairs
-		StartCrosshairBulletFire();
-		
-		// Start FireRateTimer to kill of weapon, in order to simulate its fire rate
-		StartFireRateTimer();
-	}
-}
-
-bool AShooterCharacter::LineTraceFromCrosshair(FHitResult &OutHitResult)
-{
-	// Get current size of the viewport
-	FVector2D ViewportSize;
-	if(GEngine && GEngine -> GameViewport)
-	{
-		GEngine -> GameViewport -> GetViewportSize(ViewportSize);
-	}
-
-	// Get screen space location of crosshair
-	FVector2D CrosshairLocation(ViewportSize.X / 2.f, ViewportSize.Y / 2.f);
-	CrosshairLocation.Y -= 50.f;
-	FVector CrosshairWorldPosition;
-	FVector CrosshairWorldDirection;
-
-	// Get world position and direction of crosshair
-	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld
-	(UGameplayStatics::GetPlayerController(this, 0),
-	 CrosshairLocation, CrosshairWorldPosition, CrosshairWorldDirection);
-
-	if(!bScreenToWorld) return false; // Was deprojection successful?
-
-	const FVector Start{ CrosshairWorldPosition };
-	const FVector End{ CrosshairWorldPosition + CrosshairWorldDirection * 50'000.f };
-
-	// Trace outward from crosshairs world location
-	GetWorld() -> LineTraceSingleByChannel(OutHitResult, Start, End, ECollisionChannel::ECC_Visibility);
-	
-	if(OutHitResult.bBlockingHit) return true;
-	
-	OutHitResult.Location = End; // Mutating location
-	return false;
-}
-
-bool AShooterCharacter::LineTraceFromGunBarrel(const FVector& MuzzleSocketLocation, FVector& OutBeamLocation)
-{
-	FHitResult CrosshairHitResult;
-	LineTraceFromCrosshair(CrosshairHitResult);
-	OutBeamLocation = CrosshairHitResult.Location;
-	
-	/* If Crosshair's lineTrace hit something, OutBeamLocation will be set to
-	 * the location of the hit,
-	 * If it don't hit anything OutBeamLocation will be set to the point where lineTrace ends.
-	 * However we still need another trace from the gun barrel:
-	 */
-
-	// Performs a second line trace, this time from the gun barrel
-	FHitResult WeaponTraceHit;
-	const FVector WeaponTraceStart{ MuzzleSocketLocation };
-	const FVector StartToEnd{ OutBeamLocation - MuzzleSocketLocation };
-	const FVector WeaponTraceEnd{ MuzzleSocketLocation + StartToEnd * 1.25 };
-
-	GetWorld() -> LineTraceSingleByChannel(WeaponTraceHit, WeaponTraceStart, WeaponTraceEnd,
-	                                     ECollisionChannel::ECC_Visibility);
-	if(WeaponTraceHit.bBlockingHit) // Is there something between the barrel and the BeamEnd?
-	{
-		OutBeamLocation = WeaponTraceHit.Location;
-		return true;
-	}
-	return false;
-}
-
-void AShooterCharacter::FireButtonPressed()
-{
-	bFireButtonPressed = true;
-	FireWeapon();
-}
-
-void AShooterCharacter::FireButtonReleased()
-{
-	bFireButtonPressed = false;	
-}
-
-void AShooterCharacter::AimingButtonPressed()
-{
-	if(EquippedWeapon) // We can only aim when holding a Weapon
-	{
-		bAiming = true;
-	}
-}
-
-void AShooterCharacter::AimingButtonReleased()
-{
-	bAiming = false;
-}
-
-void AShooterCharacter::SelectButtonPressed()
-{
-	if(PickupTraceHitItem)
-	{
-		PickupTraceHitItem -> StartAnimCurves(this);
-		if(PickupTraceHitItem -> GetPickupSound())
-		{
-			UGameplayStatics::PlaySound2D(this, PickupTraceHitItem -> GetPickupSound());
-		}
-		
-		PickupTraceHitItem = nullptr;
-		PreviousPickupTraceHitItem = nullptr;
-	}
-}
-
-void AShooterCharacter::SelectButtonReleased()
-{
-	
-}
-
-void AShooterCharacter::DropButtonPressed()
-{
-	DropWeapon();
-}
-
-void AShooterCharacter::DropButtonReleased()
-{
-	
-}
-
-void AShooterCharacter::CameraInterpZoom(float DeltaTime)
-{
-	// Set current camera field of view
-	if(bAiming)
-	{
-		// Interpolate to zoomed FOV
-		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraZoomedFOV, DeltaTime, ZoomInterpSpeed);
-	}
-	else
-	{
-		// Interpolate to default FOV
-		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraDefaultFOV, DeltaTime, ZoomInterpSpeed);
-	}
-	GetFollowCamera() -> SetFieldOfView(CameraCurrentFOV);
-}
-
-void AShooterCharacter::SetLookRates()
-{
-	if(bAiming)
-	{
-		BaseTurnRate = AimingTurnRate;
-		BaseLookUpRate = AimingLookUpRate;
-	}
-	else
-	{
-		BaseTurnRate = HipTurnRate;
-		BaseLookUpRate = HipLookUpRate;
-	}
-}
-
-void AShooterCharacter::CalculateCrosshairSpread(float DeltaTime)
-{
-	FVector2D WalkingSpeedRange { 0.f , 600.f };
-	FVector2D VelocityMultiplierRange { 0.f, 1.f };
-	FVector Velocity { GetVelocity() };
-	Velocity.Z = 0;
-
-	if(GetCharacterMovement() -> IsFalling())
-	{
-		// Spread the crosshair slowly while in air
-		CrosshairInAirFactor = FMath::FInterpTo(CrosshairInAirFactor, 2.25f, DeltaTime, 2.25f);	
-	}
-	else
-	{
-		// Shrink the crosshair rapidly while on ground
-		CrosshairInAirFactor = FMath::FInterpTo(CrosshairInAirFactor, 0.f, DeltaTime, 35.f);	
-	}
-
-	// Calculate crosshair aim factor
-	if(bAiming)
-	{
-		// Shrink the crosshair while aiming
-		CrosshairAimingFactor = FMath::FInterpTo(CrosshairAimingFactor, 0.5f, DeltaTime, 30.f);
-	}
-	else
-	{
-		// Spread the crosshair while not aiming
-		CrosshairAimingFactor = FMath::FInterpTo(CrosshairAimingFactor, 0.f, DeltaTime, 30.f);
-	}
-
-	// Calculate crosshair shoot factor
-	if(bFiringBullet)
-	{
-		CrosshairShootingFactor = FMath::FInterpTo(CrosshairShootingFactor, 0.3f, DeltaTime, 60.f);
-	}
-	else
-	{
-		CrosshairShootingFactor = FMath::FInterpTo(CrosshairShootingFactor, 0.0f, DeltaTime, 60.f);
-	}
-	
-	// Calculate crosshair velocity factor
-	CrosshairVelocityFactor = FMath::GetMappedRangeValueClamped(
-		WalkingSpeedRange, VelocityMultiplierRange, Velocity.Size());
-	CrosshairSpreadingMultiplier = 0.5f + CrosshairVelocityFactor + CrosshairInAirFactor - CrosshairAimingFactor
-	+ CrosshairShootingFactor;	
-}
-
-void AShooterCharacter::StartCrosshairBulletFire()
-{
-	bFiringBullet = true;
-	GetWorldTimerManager().SetTimer(CrosshairShootTimer, this, &AShooterCharacter::FinishCrosshairBulletFire,
-		CrosshairShootingDuration);
-}
-
-void AShooterCharacter::FinishCrosshairBulletFire()
-{
-	bFiringBullet = false;
-}
-
-void AShooterCharacter::StartFireRateTimer()
-{
-	CombatState = ECombatState::ECS_FireRateTimerInProgress;
-	GetWorldTimerManager().SetTimer(AutomaticFireRateTimer, this, &AShooterCharacter::FireRateTimerReset, AutomaticFireRate);
-}
-
-void AShooterCharacter::FireRateTimerReset()
-{
-	CombatState = ECombatState::ECS_Unoccupied;
-
-	if(WeaponHasAmmo())
-	{
-		if(bFireButtonPressed)
-		{
-			FireWeapon();
-		}
-	}
-	else // Weapon is empty
-	{
-		ReloadWeapon();
-	}
-}
-
-void AShooterCharacter::PickupTrace()
-{
-	if(bShouldTraceForItems)
-	{
-		FHitResult ItemTraceResult;
-		LineTraceFromCrosshair(ItemTraceResult);
-		
-		if(ItemTraceResult.bBlockingHit)
-		{
-			PickupTraceHitItem = Cast<AItem>(ItemTraceResult.GetActor());
-			if(PickupTraceHitItem && PickupTraceHitItem -> GetPickupWidget())
-			{
-				// Show Item pickup widget
-				PickupTraceHitItem -> GetPickupWidget() -> SetVisibility(true);
-			}
-
-			// If linetrace hit an item last frame
-			if(PreviousPickupTraceHitItem)
-			{
-				if(PickupTraceHitItem != PreviousPickupTraceHitItem) // If linetrace hit a new item this frame
-				{
-					PreviousPickupTraceHitItem -> GetPickupWidget() -> SetVisibility(false);
-				}
-			}
-			
-			// Saving a reference to the item linetrace hit, last frame. or either null ptr.
-			PreviousPickupTraceHitItem = PickupTraceHitItem;
-		}
-	}
-	else if(PreviousPickupTraceHitItem) // If character no longer overlap items, and the last item isn't null.
-	{
-		PreviousPickupTraceHitItem -> GetPickupWidget() -> SetVisibility(false);
-	}
-}
-
-AWeapon* AShooterCharacter::SpawnDefaultWeapon()
-{
-	if(DefaultWeaponClass)
-	{
-		return GetWorld() -> SpawnActor<AWeapon>(DefaultWeaponClass);
-	}
-	return nullptr;
-}
-
-void AShooterCharacter::EquipWeapon(AWeapon* WeaponToEquip)
-{
-	if(WeaponToEquip)
-	{
-		const USkeletalMeshSocket* HandSocket = GetMesh() -> GetSocketByName(FName("righthand_socket"));
-		
-		if(HandSocket)
-		{
-			HandSocket -> AttachActor(WeaponToEquip, GetMesh());
-		}
-		EquippedWeapon = WeaponToEquip;
-		EquippedWeapon -> SetItemState(EItemState::EIS_Equipped);
-	}
-}
-
-void AShooterCharacter::DropWeapon()
-{
-	if(EquippedWeapon)
-	{
-		FDetachmentTransformRules DetachmentTransformRule(EDetachmentRule::KeepWorld, true);
-		EquippedWeapon -> GetItemMesh() -> DetachFromComponent(DetachmentTransformRule);
-		
-		EquippedWeapon -> SetItemState(EItemState::EIS_Falling);
-		EquippedWeapon -> ThrowWeapon();
-		EquippedWeapon = nullptr;
-	}
-}
-
-void AShooterCharacter::SwapWeapon(AWeapon* WeaponToSwap)
-{
-	DropWeapon();
-	EquipWeapon(WeaponToSwap);
-}
-
-void AShooterCharacter::InitializeAmmoMap()
-{
-	AmmoMap.Add(EAmmoType::EAT_9mm, Starting9mmAmmo);	
-	AmmoMap.Add(EAmmoType::EAT_AR, StartingARAmmo);	
-}
-
-bool AShooterCharacter::WeaponHasAmmo()
-{
-	if(EquippedWeapon == nullptr) return false; // If we aren't holding a weapon
-	return EquippedWeapon -> GetAmmo() > 0;
-}
-
-void AShooterCharacter::PlayFireSound()
-{
-	if(FireSound)
-	{
-		UGameplayStatics::PlaySound2D(this, FireSound);
-	}
-}
-
-void AShooterCharacter::SendBullet()
-{
-	const USkeletalMeshSocket* BarrelSocket = EquippedWeapon -> GetItemMesh() -> GetSocketByName("BarrelSocket");
-	if(BarrelSocket)
-	{
-		const FTransform SocketTransform = BarrelSocket -> GetSocketTransform(EquippedWeapon -> GetItemMesh());
-		if(MuzzleFlash)
-		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MuzzleFlash, SocketTransform);
-		}
-
-		FVector BeamEndLocation;
-		bool bBeamEnd = LineTraceFromGunBarrel(SocketTransform.GetLocation(), BeamEndLocation);
-		if(bBeamEnd)
-		{
-			if(ImpactParticles)
-			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, BeamEndLocation);
-			}
-
-			if(BeamParticles)
-			{
-				UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
-					GetWorld(), BeamParticles, SocketTransform);
-				if(Beam)
-				{
-					Beam -> SetVectorParameter(FName("Target"), BeamEndLocation);
-				}
-			}
-		}
-	}
-}
-
-void AShooterCharacter::PlayHipFireMontage()
-{
-	UAnimInstance* AnimInstance = GetMesh() -> GetAnimInstance();
-	if(AnimInstance && HipFireMontage)
-	{
-		AnimInstance -> Montage_Play(HipFireMontage);
-		AnimInstance -> Montage_JumpToSection(FName("StartFire"));
-	}
-}
-
-void AShooterCharacter::ReloadButtonPressed()
-{
-	ReloadWeapon();
-}
-
-void AShooterCharacter::ReloadWeapon()
-{
-	if(CombatState != ECombatState::ECS_Unoccupied) return;
-	if(EquippedWeapon == nullptr) return;
-	
-	if(CarryingAmmo()) // are we carrying the correct type of ammo?
-	{
-		CombatState = ECombatState::ECS_Reloading;
-		UAnimInstance* AnimInstance = GetMesh() -> GetAnimInstance();
-		if(AnimInstance && ReloadMontage)
-		{
-			AnimInstance ->	Montage_Play(ReloadMontage);
-			AnimInstance -> Montage_JumpToSection(EquippedWeapon -> GetReloadMontageSection());
-		}
-	}
-}
-
-void AShooterCharacter::FinishReloading()
-{
-	CombatState = ECombatState::ECS_Unoccupied;
-	if(EquippedWeapon == nullptr) return;
-	const auto AmmoType = EquippedWeapon -> GetAmmoType();
-	
-	if(AmmoMap.Contains(AmmoType))
-	{
-		int32 CarriedAmmo = AmmoMap[AmmoType];
-		const int32 MagEmptySpace = EquippedWeapon -> GetMagazineCapacity() - EquippedWeapon -> GetAmmo();
-
-		if(CarriedAmmo < MagEmptySpace)
-		{
-			// Reload the magazine with all the ammo we are carrying
-			EquippedWeapon -> ReloadAmmo(CarriedAmmo);
-			CarriedAmmo = 0;
-		}
-		else
-		{
-			// Fully fill the magazine
-			EquippedWeapon -> ReloadAmmo(MagEmptySpace);
-			CarriedAmmo -= MagEmptySpace;
-		}
-		// Assign the value to AmmoMap
-		AmmoMap.Add(AmmoType, CarriedAmmo);
-	}
-}
-
-bool AShooterCharacter::CarryingAmmo()
-{
-	if(EquippedWeapon == nullptr) return false;
-
-	auto AmmoType = EquippedWeapon -> GetAmmoType();
-	if(AmmoMap.Contains(AmmoType))
-	{
-		return AmmoMap[AmmoType] > 0;
-	}
-	return false;
-}
-
-void AShooterCharacter::GrabClip()
-{
-	if(EquippedWeapon == nullptr) return;
-	if(ClipSceneComponent == nullptr) return;
-	
-	const int32 ClipBoneIndex{ EquippedWeapon -> GetItemMesh() -> GetBoneIndex(EquippedWeapon -> GetClipBoneName()) };
-	// Initial transform of the clip when hand first touches the clip
-	ClipTransform = EquippedWeapon -> GetItemMesh() -> GetBoneTransform(ClipBoneIndex);
-	
-	const FAttachmentTransformRules AttachmentRules{ EAttachmentRule::KeepRelative, true };
-	ClipSceneComponent -> AttachToComponent(GetMesh(), AttachmentRules, FName(TEXT("hand_l")));
-	ClipSceneComponent -> SetWorldTransform(ClipTransform);
-
-	EquippedWeapon -> SetMovingClip(true);
-}
-
-void AShooterCharacter::ReleaseClip()
-{
-	if(EquippedWeapon == nullptr) return;
-
-	EquippedWeapon -> SetMovingClip(false);
-}
-
-// Called every frame
-void AShooterCharacter::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-	
-	// Handle interpolation for zoom when aiming
-	CameraInterpZoom(DeltaTime);
-	// Change look sensitivity based on aiming state
-	SetLookRates();
-	// Calculate crosshair spread multiplier
-	CalculateCrosshairSpread(DeltaTime);
-	// Trace for items while overlapping items
-	PickupTrace();
-}
-
-// Called to bind functionality to input
-void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
-{
-	Super::SetupPlayerInputComponent(PlayerInputComponent);
-	check(PlayerInputComponent);
-
-	PlayerInputComponent->BindAxis("Move Forward / Backward", this, &AShooterCharacter::MoveForward);
-	PlayerInputComponent->BindAxis("Move Right / Left", this, &AShooterCharacter::MoveRight);
-	PlayerInputComponent->BindAxis("TurnRate", this, &AShooterCharacter::TurnAtRate);
-	PlayerInputComponent->BindAxis("LookUpRate", this, &AShooterCharacter::LookUpRate);
-	PlayerInputComponent->BindAxis("Turn Right / Left", this, &AShooterCharacter::Turn);
-	PlayerInputComponent->BindAxis("Look Up / Down", this, &AShooterCharacter::LookUp);
-
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
-	PlayerInputComponent->BindAction("FireButton", IE_Pressed, this, &AShooterCharacter::FireButtonPressed);
-	PlayerInputComponent->BindAction("FireButton", IE_Released, this, &AShooterCharacter::FireButtonReleased);
-	PlayerInputComponent->BindAction("AimingButton", IE_Pressed, this, &AShooterCharacter::AimingButtonPressed);
-	PlayerInputComponent->BindAction("AimingButton", IE_Released, this, &AShooterCharacter::AimingButtonReleased);
-	PlayerInputComponent->BindAction("Select", IE_Pressed, this, &AShooterCharacter::SelectButtonPressed);
-	PlayerInputComponent->BindAction("Select", IE_Released, this, &AShooterCharacter::SelectButtonReleased);
-	PlayerInputComponent->BindAction("Drop", IE_Pressed, this, &AShooterCharacter::DropButtonPressed);
-	PlayerInputComponent->BindAction("Drop", IE_Released, this, &AShooterCharacter::DropButtonReleased);
-	PlayerInputComponent->BindAction("Reload", IE_Pressed, this, &AShooterCharacter::ReloadButtonPressed);
-}
-
-float AShooterCharacter::GetCrosshairSpreadMultiplier() const
-{
-	return CrosshairSpreadingMultiplier;
-}
-
-void AShooterCharacter::IncrementOverlappedItemCount(int8 Value)
-{
-	if(OverlappedItemCount + Value <= 0)
-	{
-		OverlappedItemCount = 0;
-		bShouldTraceForItems = false;
-	}
-	else
-	{
-		OverlappedItemCount += Value;
-		bShouldTraceForItems = true;
-	}
-}
-
-FVector AShooterCharacter::GetPickupInterpTargetLocation()
-{
-	const FVector CameraWorldLocation{ FollowCamera -> GetComponentLocation() };
-	const FVector CameraForward{ FollowCamera -> GetForwardVector() };
-	// Desired location = Camera location + (Forward * A) + (Up * B)
-	return CameraWorldLocation + (CameraForward * CameraPickupInterpDistance) + FVector(0.f, 0.f,
-		CameraPickupInterpElevation);
-}
-
-void AShooterCharacter::PickupItem(AItem* Item)
-{
-	if(Item -> GetEquipSound())
-	{
-		UGameplayStatics::PlaySound2D(this, Item -> GetEquipSound());
-	}
-	
-	auto Weapon = Cast<AWeapon>(Item);
-	if(Weapon)
-	{
-		SwapWeapon(Weapon);
-	}
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterCharacter.h"
+
+#include "Item.h"
+#include "Weapon.h"
+#include "HitscanSubsystem.h"
+#include "ProjectileSubsystem.h"
+#include "FXPoolSubsystem.h"
+#include "PickupIndexSubsystem.h"
+#include "ShooterHUDViewModel.h"
+#include "ShooterPlayerController.h"
+#include "LagCompensationSubsystem.h"
+#include "ItemAssetStreamer.h"
+#include "AnimBudgetSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "GunfireAudioSubsystem.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "Camera/CameraComponent.h"
+#include "Components/WidgetComponent.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundCue.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "Net/UnrealNetwork.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fire Weapon"), STAT_FireWeapon, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Fire Shots"), STAT_FireShots, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Send Bullets"), STAT_SendBullets, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Line Trace From Crosshair"), STAT_LineTraceFromCrosshair, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Pickup Trace"), STAT_PickupTrace, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Calculate Crosshair Spread"), STAT_CalculateCrosshairSpread, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Play Fire Animation"), STAT_PlayFireAnimation, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shots Fired"), STAT_ShotsFired, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Montages Played"), STAT_FireMontagesPlayed, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair Traces"), STAT_CrosshairTraces, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Occlusion Traces"), STAT_PickupOcclusionTraces, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shot Packet Bits"), STAT_ShotPacketBits, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shot Packet Shots"), STAT_ShotPacketShots, STATGROUP_Shooter);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Shot Packet Bytes Per Shot"), STAT_ShotPacketBytesPerShot, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarLogShotPackets(
+	TEXT("Shooter.Net.LogShotPackets"),
+	0,
+	TEXT("Log the size of every shot packet sent to the server, in bits and bytes per shot."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarProceduralFireRecoil(
+	TEXT("Shooter.Anim.ProceduralFireRecoil"),
+	1,
+	TEXT("1: shots drive the procedural recoil of UShooterAnimInstance, applied to its RecoilBoneName.\n")
+	TEXT("0: every shot plays the HipFire montage."),
+	ECVF_Default);
+
+// Sets default values
+AShooterCharacter::AShooterCharacter():
+	// Base rates for turning/looking up
+	BaseTurnRate(45.f),
+	BaseLookUpRate(41.f),
+	// Turn rates for aiming/not aiming
+	HipTurnRate(BaseTurnRate),
+	HipLookUpRate(BaseLookUpRate),
+	AimingTurnRate(20.f),
+	AimingLookUpRate(20.f),
+	// Mouse look sensitivity scale factors
+	MouseHipTurnRate(1.f),
+	MouseHipLookUpRate(1.f),
+	MouseAimingTurnRate(0.6f),
+	MouseAimingLookUpRate(0.6f),
+	// Aiming
+	bAiming(false),
+	// Camera field of view values
+	CameraDefaultFOV(0.f), // Set in BeginPlay
+	CameraZoomedFOV(35.f),
+	CameraCurrentFOV(0.f),
+	ZoomInterpSpeed(22.f),
+	// Crosshair spread factors
+	CrosshairSpreadingMultiplier(0.f),
+	CrosshairVelocityFactor(0.f),
+	CrosshairInAirFactor(0.f),
+	CrosshairAimingFactor(0.f),
+	CrosshairShootingFactor(0.f),
+	// Bullet fire variables
+	bFireButtonPressed(false),
+	bShouldFire(true),
+	bFiringBullet(false),
+    AutomaticFireRate(0.1f),
+	CrosshairShootingDuration(0.05f),
+	FireCooldown(0.f),
+	FireCadenceStartFrame(0),
+	// Network firing
+	NextShotSequence(1),
+	LastConfirmedShotSequence(0),
+	LastServerShotSequence(0),
+	ServerFireBudget(3.f),
+	ServerFireBurst(3.f),
+	ServerLastFireTime(0.f),
+	ServerMaxShotOriginDistance(500.f),
+	ShotPacketShotsSent(0),
+	ShotPacketBitsSent(0),
+	ServerShotsAccepted(0),
+	bFireLoopPlaying(false),
+	FireShotCount(0),
+	LastFireTime(0.f),
+	// Item trace variables
+	PickupViewConeHalfAngle(10.f),
+	// Camera pickup interpolation variables
+	CameraPickupInterpDistance(250.f),
+	CameraPickupInterpElevation(65.f),
+	// Inventory
+	WeaponSlots(3),
+	ActiveSlot(0),
+	bInActorPool(false),
+	Significance(EShooterSignificance::ESS_High),
+	// Starting ammo amounts
+	Starting9mmAmmo(80),
+	StartingARAmmo(120),
+	// Combat state
+	CombatState(ECombatState::ECS_Unoccupied)
+	
+{
+	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Create a CameraBoom (pulls in towards the character if there is a collision)
+	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
+	CameraBoom -> SetupAttachment(RootComponent);
+	CameraBoom -> TargetArmLength = 180.f; // The camera follows at this distance behind the character
+	CameraBoom -> bUsePawnControlRotation = true; // Rotate the arm based on the controller
+	CameraBoom -> SocketOffset = FVector{ 0.f, 50.f, 70.f };
+
+	// Create a FollowCamera
+	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
+	FollowCamera -> SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
+	FollowCamera -> bUsePawnControlRotation = false;
+
+	// Don't rotate when the controller rotates. Let the controller only affect camera.
+	bUseControllerRotationPitch = false;
+	bUseControllerRotationRoll = true;
+	bUseControllerRotationYaw = false;
+
+	// Configure character movement
+	GetCharacterMovement() -> bOrientRotationToMovement = false; // Character moves at the direction of input...
+	GetCharacterMovement() -> RotationRate = FRotator(0.f, 540.f, 0.f); //... at this rate
+	GetCharacterMovement() -> JumpZVelocity = 600.f;
+	GetCharacterMovement() -> AirControl = 0.1f;
+
+	// Create a ClipSceneComponent
+	ClipSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("ClipSceneComponent"));
+}
+
+void AShooterCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if(FollowCamera)
+	{
+		CameraDefaultFOV = GetFollowCamera() -> FieldOfView;
+		CameraCurrentFOV = CameraDefaultFOV;
+	}
+	// Characters prewarmed before the world began play are pooled already, OnAcquiredFromPool registers them
+	if(!bInActorPool)
+	{
+		RegisterWithSubsystems();
+	}
+	// Empty weapon slots, the server's inventory replicates to the owner
+	if(HasAuthority())
+	{
+		Inventory.Init(nullptr, FMath::Max(WeaponSlots, 1));
+	}
+	// Initialize CarriedAmmo with starting values
+	InitializeAmmo();
+	// Stream in the combat assets, OnCombatAssetsLoaded pools the effects and equips the default weapon
+	UItemAssetStreamer* AssetStreamer = GetWorld() -> GetSubsystem<UItemAssetStreamer>();
+	if(AssetStreamer)
+	{
+		AssetStreamer -> RequestCharacterAssets(this);
+	}
+	else
+	{
+		OnCombatAssetsLoaded();
+	}
+}
+
+void AShooterCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopFireLoop(false);
+	UnregisterFromSubsystems();
+	UItemAssetStreamer* AssetStreamer = GetWorld() -> GetSubsystem<UItemAssetStreamer>();
+	if(AssetStreamer)
+	{
+		AssetStreamer -> ReleaseAssets(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AShooterCharacter::RegisterWithSubsystems()
+{
+	// Record the hitboxes on the server, so shots from clients are checked against what they saw
+	if(HasAuthority())
+	{
+		ULagCompensationSubsystem* LagCompensation = GetWorld() -> GetSubsystem<ULagCompensationSubsystem>();
+		if(LagCompensation)
+		{
+			LagCompensation -> RegisterCharacter(this);
+		}
+	}
+	// Let the animation budget decide how often the mesh updates
+	UAnimBudgetSubsystem* AnimBudget = GetWorld() -> GetSubsystem<UAnimBudgetSubsystem>();
+	if(AnimBudget)
+	{
+		AnimBudget -> RegisterCharacter(this);
+	}
+	// And the significance how often the character ticks
+	UShooterSignificanceSubsystem* SignificanceSubsystem =
+		GetWorld() -> GetSubsystem<UShooterSignificanceSubsystem>();
+	if(SignificanceSubsystem)
+	{
+		SignificanceSubsystem -> RegisterCharacter(this);
+	}
+}
+
+void AShooterCharacter::UnregisterFromSubsystems()
+{
+	ULagCompensationSubsystem* LagCompensation = GetWorld() -> GetSubsystem<ULagCompensationSubsystem>();
+	if(LagCompensation)
+	{
+		LagCompensation -> UnregisterCharacter(this);
+	}
+	UAnimBudgetSubsystem* AnimBudget = GetWorld() -> GetSubsystem<UAnimBudgetSubsystem>();
+	if(AnimBudget)
+	{
+		AnimBudget -> UnregisterCharacter(this);
+	}
+	UShooterSignificanceSubsystem* SignificanceSubsystem =
+		GetWorld() -> GetSubsystem<UShooterSignificanceSubsystem>();
+	if(SignificanceSubsystem)
+	{
+		SignificanceSubsystem -> UnregisterCharacter(this);
+	}
+	SetSignificance(EShooterSignificance::ESS_High);
+}
+
+void AShooterCharacter::OnAcquiredFromPool()
+{
+	bInActorPool = false;
+	RegisterWithSubsystems();
+	GetCharacterMovement() -> SetDefaultMovementMode();
+	InitializeAmmo();
+	// The default weapon class is loaded unless the character was pooled before its assets streamed in,
+	// OnCombatAssetsLoaded equips it then
+	if(HasAuthority() && EquippedWeapon == nullptr)
+	{
+		AddWeapon(SpawnDefaultWeapon());
+	}
+}
+
+void AShooterCharacter::OnReleasedToPool()
+{
+	bInActorPool = true;
+	UnregisterFromSubsystems();
+
+	// Stop whatever the character was doing
+	SetFireButtonPressed(false);
+	StopFireLoop(false);
+	bAiming = false;
+	FireCooldown = 0.f;
+	GetWorldTimerManager().ClearTimer(CrosshairShootTimer);
+	bFiringBullet = false;
+	if(UAnimInstance* AnimInstance = GetMesh() -> GetAnimInstance())
+	{
+		AnimInstance -> StopAllMontages(0.f);
+	}
+	SetCombatState(ECombatState::ECS_Unoccupied);
+	GetCharacterMovement() -> StopMovementImmediately();
+	GetCharacterMovement() -> DisableMovement();
+
+	// The weapons go back to the pool on their own, the next character gets fresh ones
+	UActorPoolSubsystem* ActorPool = GetWorld() -> GetSubsystem<UActorPoolSubsystem>();
+	for(AWeapon*& Weapon : Inventory)
+	{
+		if(Weapon && ActorPool && HasAuthority())
+		{
+			ActorPool -> ReleaseActor(Weapon);
+		}
+		else if(Weapon && HasAuthority())
+		{
+			Weapon -> Destroy();
+		}
+		Weapon = nullptr;
+	}
+	EquippedWeapon = nullptr;
+	ActiveSlot = 0;
+	PushHUDAmmo();
+}
+
+void AShooterCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AShooterCharacter, EquippedWeapon);
+	DOREPLIFETIME_CONDITION(AShooterCharacter, Inventory, COND_OwnerOnly);
+}
+
+void AShooterCharacter::MoveForward(float Value)
+{
+	if((Controller != nullptr) && (Value != 0.0f))
+	{
+		// find out which way is forward
+		FRotator Rotation{ Controller -> GetControlRotation() };
+		FRotator YawRotation{ 0, Rotation.Yaw, 0 };
+
+		FVector Direction{ FRotationMatrix{YawRotation}.GetUnitAxis(EAxis::X) };
+		AddMovementInput(Direction, Value);
+	}
+}
+
+void AShooterCharacter::MoveRight(float Value)
+{
+	if((Controller != nullptr) && (Value != 0.0f))
+	{
+		// find out which way is right
+		FRotator Rotation{ Controller -> GetControlRotation() };
+		FRotator YawRotation{ 0, Rotation.Yaw, 0 };
+
+		FVector Direction{ FRotationMatrix{ YawRotation }.GetUnitAxis(EAxis::Y) };
+		AddMovementInput(Direction, Value);
+	}
+}
+
+void AShooterCharacter::TurnAtRate(float Rate)
+{
+	// Calculate delta for this frame from the rate information
+	AddControllerYawInput(Rate * BaseTurnRate * GetWorld() -> GetDeltaSeconds()); // deg/sec * sec/frame
+}
+
+
+void AShooterCharacter::LookUpRate(float Rate)
+{
+	// Calculate delta for this frame from the rate information
+	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld() -> GetDeltaSeconds()); // deg/sec * sec/frame
+}
+
+void AShooterCharacter::Turn(float Value)
+{
+	const float TurnScaleFactor = bAiming ? MouseAimingTurnRate : MouseHipTurnRate;
+	AddControllerYawInput(Value * TurnScaleFactor);
+}
+
+void AShooterCharacter::LookUp(float Value)
+{
+	const float LookUpScaleFactor = bAiming ? MouseAimingLookUpRate : MouseHipLookUpRate;
+	AddControllerPitchInput(Value * LookUpScaleFactor);
+}
+
+void AShooterCharacter::FireWeapon()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_FireWeapon);
+
+	if(EquippedWeapon == nullptr) return; // if we are holding a weapon
+	if(CombatState != ECombatState::ECS_Unoccupied) return; // if the weapon is available for firing
+
+	if(WeaponHasAmmo())
+	{
+		FShotRequest Shot;
+		if(!GetFireSample(Shot)) return;
+
+		// The first shot leaves right away, the following ones are released by UpdateFireCadence
+		ShotBatch.Reset();
+		ShotBatch.Add(Shot);
+		FireShots(ShotBatch);
+		LastFireSample = Shot;
+		
+		// Start counting down to the next shot, in order to simulate the weapon's fire rate
+		StartFireCadence();
+	}
+}
+
+void AShooterCharacter::FireShots(const TArray<FShotRequest>& Shots)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_FireShots);
+	INC_DWORD_STAT_BY(STAT_ShotsFired, Shots.Num());
+
+	// Visuals
+	PlayFireSound();
+	SendBullets(Shots);
+	PlayFireAnimation(Shots.Num());
+
+	// Decrement ammo
+	for(int32 i = 0; i < Shots.Num(); i++)
+	{
+		EquippedWeapon -> DecrementAmmo();
+	}
+
+	// Start bullet fire timer for crosshairs
+	StartCrosshairBulletFire();
+
+	// Everything above is predicted, let the server know what we fired
+	if(IsLocallyControlled())
+	{
+		ReplicateShots(Shots);
+	}
+}
+
+bool AShooterCharacter::GetFireSample(FShotRequest& OutShot)
+{
+	const USkeletalMeshSocket* BarrelSocket = EquippedWeapon -> GetItemMesh() -> GetSocketByName("BarrelSocket");
+	if(BarrelSocket == nullptr) return false;
+
+	OutShot.Shooter = this;
+	OutShot.MuzzleTransform = BarrelSocket -> GetSocketTransform(EquippedWeapon -> GetItemMesh());
+	OutShot.Timestamp = GetWorld() -> GetTimeSeconds();
+	return GetCrosshairTraceSegment(OutShot.CrosshairTraceStart, OutShot.CrosshairTraceEnd);
+}
+
+bool AShooterCharacter::GetCrosshairTraceSegment(FVector& OutStart, FVector& OutEnd)
+{
+	// Characters without a player, bots or benchmark ones, aim along their view
+	if(!IsPlayerControlled())
+	{
+		FRotator ViewRotation;
+		GetActorEyesViewPoint(OutStart, ViewRotation);
+		OutEnd = OutStart + ViewRotation.Vector() * 50'000.f;
+		return true;
+	}
+
+	// Get current size of the viewport
+	FVector2D ViewportSize;
+	if(GEngine && GEngine -> GameViewport)
+	{
+		GEngine -> GameViewport -> GetViewportSize(ViewportSize);
+	}
+
+	// Get screen space location of crosshair
+	FVector2D CrosshairLocation(ViewportSize.X / 2.f, ViewportSize.Y / 2.f);
+	CrosshairLocation.Y -= 50.f;
+	FVector CrosshairWorldPosition;
+	FVector CrosshairWorldDirection;
+
+	// Get world position and direction of crosshair
+	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld
+	(UGameplayStatics::GetPlayerController(this, 0),
+	 CrosshairLocation, CrosshairWorldPosition, CrosshairWorldDirection);
+
+	if(!bScreenToWorld) return false; // Was deprojection successful?
+
+	OutStart = CrosshairWorldPosition;
+	OutEnd = CrosshairWorldPosition + CrosshairWorldDirection * 50'000.f;
+	return true;
+}
+
+bool AShooterCharacter::LineTraceFromCrosshair(FHitResult &OutHitResult)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_LineTraceFromCrosshair);
+	INC_DWORD_STAT(STAT_CrosshairTraces);
+
+	FVector Start;
+	FVector End;
+	if(!GetCrosshairTraceSegment(Start, End)) return false;
+
+	// Trace outward from crosshairs world location
+	GetWorld() -> LineTraceSingleByChannel(OutHitResult, Start, End, ECollisionChannel::ECC_Visibility);
+	
+	if(OutHitResult.bBlockingHit) return true;
+	
+	OutHitResult.Location = End; // Mutating location
+	return false;
+}
+
+void AShooterCharacter::FireButtonPressed()
+{
+	bFireButtonPressed = true;
+	FireWeapon();
+}
+
+void AShooterCharacter::FireButtonReleased()
+{
+	bFireButtonPressed = false;	
+}
+
+void AShooterCharacter::SetFireButtonPressed(bool bPressed)
+{
+	if(bPressed == bFireButtonPressed) return;
+	if(bPressed)
+	{
+		FireButtonPressed();
+	}
+	else
+	{
+		FireButtonReleased();
+	}
+}
+
+void AShooterCharacter::AimingButtonPressed()
+{
+	if(EquippedWeapon) // We can only aim when holding a Weapon
+	{
+		bAiming = true;
+	}
+}
+
+void AShooterCharacter::AimingButtonReleased()
+{
+	bAiming = false;
+}
+
+void AShooterCharacter::SelectButtonPressed()
+{
+	if(PickupTraceHitItem)
+	{
+		PickupTraceHitItem -> StartAnimCurves(this);
+		if(PickupTraceHitItem -> GetPickupSound())
+		{
+			UGameplayStatics::PlaySound2D(this, PickupTraceHitItem -> GetPickupSound());
+		}
+		
+		PickupTraceHitItem = nullptr;
+		PreviousPickupTraceHitItem = nullptr;
+		PickupCandidate = nullptr;
+		if(AShooterPlayerController* PlayerController = GetController<AShooterPlayerController>())
+		{
+			PlayerController -> SetPickupWidgetItem(nullptr);
+		}
+	}
+}
+
+void AShooterCharacter::SelectButtonReleased()
+{
+	
+}
+
+void AShooterCharacter::DropButtonPressed()
+{
+	// The next weapon couldn't be equipped before the reload or burst ends, the hands would be left empty
+	if(CombatState != ECombatState::ECS_Unoccupied) return;
+
+	DropWeapon();
+	SwitchWeapon(FindOccupiedSlot(1));
+	if(!HasAuthority())
+	{
+		ServerDropWeapon();
+	}
+}
+
+void AShooterCharacter::DropButtonReleased()
+{
+	
+}
+
+void AShooterCharacter::NextWeaponPressed()
+{
+	WeaponSlotPressed(FindOccupiedSlot(1));
+}
+
+void AShooterCharacter::PreviousWeaponPressed()
+{
+	WeaponSlotPressed(FindOccupiedSlot(-1));
+}
+
+void AShooterCharacter::WeaponSlotPressed(int32 Slot)
+{
+	if(!Inventory.IsValidIndex(Slot) || Inventory[Slot] == nullptr || Inventory[Slot] == EquippedWeapon) return;
+
+	SwitchWeapon(Slot);
+	if(!HasAuthority())
+	{
+		ServerSwitchWeapon(static_cast<uint8>(Slot));
+	}
+}
+
+void AShooterCharacter::CameraInterpZoom(float DeltaTime)
+{
+	// Set current camera field of view
+	if(bAiming)
+	{
+		// Interpolate to zoomed FOV
+		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraZoomedFOV, DeltaTime, ZoomInterpSpeed);
+	}
+	else
+	{
+		// Interpolate to default FOV
+		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraDefaultFOV, DeltaTime, ZoomInterpSpeed);
+	}
+	GetFollowCamera() -> SetFieldOfView(CameraCurrentFOV);
+}
+
+void AShooterCharacter::SetLookRates()
+{
+	if(bAiming)
+	{
+		BaseTurnRate = AimingTurnRate;
+		BaseLookUpRate = AimingLookUpRate;
+	}
+	else
+	{
+		BaseTurnRate = HipTurnRate;
+		BaseLookUpRate = HipLookUpRate;
+	}
+}
+
+void AShooterCharacter::CalculateCrosshairSpread(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_CalculateCrosshairSpread);
+
+	FVector2D WalkingSpeedRange { 0.f , 600.f };
+	FVector2D VelocityMultiplierRange { 0.f, 1.f };
+	FVector Velocity { GetVelocity() };
+	Velocity.Z = 0;
+
+	if(GetCharacterMovement() -> IsFalling())
+	{
+		// Spread the crosshair slowly while in air
+		CrosshairInAirFactor = FMath::FInterpTo(CrosshairInAirFactor, 2.25f, DeltaTime, 2.25f);	
+	}
+	else
+	{
+		// Shrink the crosshair rapidly while on ground
+		CrosshairInAirFactor = FMath::FInterpTo(CrosshairInAirFactor, 0.f, DeltaTime, 35.f);	
+	}
+
+	// Calculate crosshair aim factor
+	if(bAiming)
+	{
+		// Shrink the crosshair while aiming
+		CrosshairAimingFactor = FMath::FInterpTo(CrosshairAimingFactor, 0.5f, DeltaTime, 30.f);
+	}
+	else
+	{
+		// Spread the crosshair while not aiming
+		CrosshairAimingFactor = FMath::FInterpTo(CrosshairAimingFactor, 0.f, DeltaTime, 30.f);
+	}
+
+	// Calculate crosshair shoot factor
+	if(bFiringBullet)
+	{
+		CrosshairShootingFactor = FMath::FInterpTo(CrosshairShootingFactor, 0.3f, DeltaTime, 60.f);
+	}
+	else
+	{
+		CrosshairShootingFactor = FMath::FInterpTo(CrosshairShootingFactor, 0.0f, DeltaTime, 60.f);
+	}
+	
+	// Calculate crosshair velocity factor
+	CrosshairVelocityFactor = FMath::GetMappedRangeValueClamped(
+		WalkingSpeedRange, VelocityMultiplierRange, Velocity.Size());
+	CrosshairSpreadingMultiplier = 0.5f + CrosshairVelocityFactor + CrosshairInAirFactor - CrosshairAimingFactor
+	+ CrosshairShootingFactor;	
+
+	if(UShooterHUDViewModel* HUDViewModel = UShooterHUDViewModel::Get(this))
+	{
+		HUDViewModel -> SetCrosshairSpread(CrosshairSpreadingMultiplier);
+	}
+}
+
+void AShooterCharacter::StartCrosshairBulletFire()
+{
+	bFiringBullet = true;
+	GetWorldTimerManager().SetTimer(CrosshairShootTimer, this, &AShooterCharacter::FinishCrosshairBulletFire,
+		CrosshairShootingDuration);
+}
+
+void AShooterCharacter::FinishCrosshairBulletFire()
+{
+	bFiringBullet = false;
+}
+
+void AShooterCharacter::StartFireCadence()
+{
+	SetCombatState(ECombatState::ECS_FireRateTimerInProgress);
+	FireCooldown = AutomaticFireRate;
+	FireCadenceStartFrame = GFrameCounter;
+}
+
+void AShooterCharacter::UpdateFireCadence(float DeltaTime)
+{
+	if(CombatState != ECombatState::ECS_FireRateTimerInProgress) return;
+	if(EquippedWeapon == nullptr)
+	{
+		StopFireLoop(true);
+		SetCombatState(ECombatState::ECS_Unoccupied);
+		return;
+	}
+
+	FShotRequest CurrentFireSample;
+	if(!GetFireSample(CurrentFireSample))
+	{
+		CurrentFireSample = LastFireSample;
+	}
+
+	// Guard against a zero fire rate, which would release shots forever
+	const float FireInterval = FMath::Max(AutomaticFireRate, KINDA_SMALL_NUMBER);
+	const int32 AmmoLeft = EquippedWeapon -> GetAmmo();
+	// The cooldown starts counting on the frame after the first shot, this frame's time passed before it was fired
+	if(FireCadenceStartFrame != GFrameCounter)
+	{
+		FireCooldown -= DeltaTime;
+	}
+	ShotBatch.Reset();
+
+	// Release every shot due this frame, so the fire rate doesn't depend on the frame rate
+	while(FireCooldown <= 0.f && bFireButtonPressed && ShotBatch.Num() < AmmoLeft)
+	{
+		// How far into this frame the shot was fired, 0 is the start of the frame and 1 is now
+		const float FrameAlpha = DeltaTime > 0.f ? FMath::Clamp(1.f + FireCooldown / DeltaTime, 0.f, 1.f) : 1.f;
+
+		FShotRequest& Shot = ShotBatch.AddDefaulted_GetRef();
+		Shot.Shooter = this;
+		Shot.MuzzleTransform.Blend(LastFireSample.MuzzleTransform, CurrentFireSample.MuzzleTransform, FrameAlpha);
+		Shot.CrosshairTraceStart = FMath::Lerp(LastFireSample.CrosshairTraceStart,
+			CurrentFireSample.CrosshairTraceStart, FrameAlpha);
+		Shot.CrosshairTraceEnd = FMath::Lerp(LastFireSample.CrosshairTraceEnd,
+			CurrentFireSample.CrosshairTraceEnd, FrameAlpha);
+		Shot.Timestamp = CurrentFireSample.Timestamp + FireCooldown;
+
+		FireCooldown += FireInterval;
+	}
+	if(ShotBatch.Num() > 0)
+	{
+		FireShots(ShotBatch);
+	}
+	LastFireSample = CurrentFireSample;
+
+	if(FireCooldown <= 0.f) // The next shot is due, but the fire button is released or the weapon is empty
+	{
+		FireCooldown = 0.f;
+		StopFireLoop(true);
+		SetCombatState(ECombatState::ECS_Unoccupied);
+
+		if(!WeaponHasAmmo())
+		{
+			ReloadWeapon();
+		}
+	}
+}
+
+void AShooterCharacter::PickupTrace()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_PickupTrace);
+
+	AItem* BestCandidate = nullptr;
+	UPickupIndexSubsystem* PickupIndex = GetWorld() -> GetSubsystem<UPickupIndexSubsystem>();
+	if(PickupIndex)
+	{
+		BestCandidate = PickupIndex -> FindBestCandidate(GetActorLocation(), GetCapsuleComponent() -> GetScaledCapsuleRadius(),
+			FollowCamera -> GetComponentLocation(), FollowCamera -> GetForwardVector(),
+			FMath::Cos(FMath::DegreesToRadians(PickupViewConeHalfAngle)));
+	}
+
+	// Only trace when the best candidate changes, to confirm it isn't hidden behind something
+	if(BestCandidate != PickupCandidate)
+	{
+		PickupCandidate = BestCandidate;
+		PickupTraceHitItem = (BestCandidate && IsItemVisible(BestCandidate)) ? BestCandidate : nullptr;
+	}
+
+	// Bots trace for items too, but the pickup widgets are only for a player
+	if(!IsPlayerControlled())
+	{
+		PreviousPickupTraceHitItem = PickupTraceHitItem;
+		return;
+	}
+
+	if(PickupTraceHitItem != PreviousPickupTraceHitItem) // If we are looking at a new item this frame
+	{
+		if(PreviousPickupTraceHitItem && PreviousPickupTraceHitItem -> GetPickupWidget())
+		{
+			PreviousPickupTraceHitItem -> GetPickupWidget() -> SetVisibility(false);
+		}
+		const bool bShared = PickupTraceHitItem && PickupTraceHitItem -> UsesSharedPickupWidget();
+		if(AShooterPlayerController* PlayerController = GetController<AShooterPlayerController>())
+		{
+			// Move the local player's single pickup widget to the new item, or hide it
+			PlayerController -> SetPickupWidgetItem(bShared ? PickupTraceHitItem : nullptr);
+		}
+		if(PickupTraceHitItem && !bShared && PickupTraceHitItem -> GetPickupWidget())
+		{
+			// Show Item pickup widget
+			PickupTraceHitItem -> GetPickupWidget() -> SetVisibility(true);
+		}
+	}
+	
+	// Saving a reference to the item we could pick up last frame. or either null ptr.
+	PreviousPickupTraceHitItem = PickupTraceHitItem;
+}
+
+bool AShooterCharacter::IsItemVisible(AItem* Item)
+{
+	const FVector Start{ FollowCamera -> GetComponentLocation() };
+	const FVector End{ Item -> GetCollisionBox() -> GetComponentLocation() };
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(this);
+
+	FHitResult ItemTraceResult;
+	GetWorld() -> LineTraceSingleByChannel(ItemTraceResult, Start, End, ECollisionChannel::ECC_Visibility, QueryParams);
+	INC_DWORD_STAT(STAT_PickupOcclusionTraces);
+
+	// Either nothing is in the way, or the first thing we hit is the item's CollisionBox
+	return !ItemTraceResult.bBlockingHit || ItemTraceResult.GetActor() == Item;
+}
+
+AWeapon* AShooterCharacter::SpawnDefaultWeapon()
+{
+	UClass* WeaponClass = DefaultWeaponClass.Get();
+	if(WeaponClass == nullptr) return nullptr;
+
+	// Reuse a despawned weapon when there is one
+	UActorPoolSubsystem* ActorPool = GetWorld() -> GetSubsystem<UActorPoolSubsystem>();
+	if(ActorPool)
+	{
+		return ActorPool -> AcquireActor<AWeapon>(WeaponClass, GetActorTransform());
+	}
+	return GetWorld() -> SpawnActor<AWeapon>(WeaponClass);
+}
+
+void AShooterCharacter::EquipWeapon(AWeapon* WeaponToEquip)
+{
+	if(WeaponToEquip)
+	{
+		// Holstered weapons are attached already, attaching again to the same socket does nothing
+		const USkeletalMeshSocket* HandSocket = GetMesh() -> GetSocketByName(FName("righthand_socket"));
+		
+		if(HandSocket)
+		{
+			HandSocket -> AttachActor(WeaponToEquip, GetMesh());
+		}
+		EquippedWeapon = WeaponToEquip;
+		EquippedWeapon -> SetOwner(this);
+		EquippedWeapon -> SetActorHiddenInGame(false);
+		EquippedWeapon -> SetItemState(EItemState::EIS_Equipped);
+		PushHUDAmmo();
+	}
+}
+
+void AShooterCharacter::HolsterWeapon(AWeapon* Weapon)
+{
+	const USkeletalMeshSocket* HandSocket = GetMesh() -> GetSocketByName(FName("righthand_socket"));
+	if(HandSocket && Weapon -> GetAttachParentActor() != this)
+	{
+		HandSocket -> AttachActor(Weapon, GetMesh());
+	}
+	Weapon -> SetOwner(this);
+	Weapon -> SetActorHiddenInGame(true);
+	Weapon -> SetItemState(EItemState::EIS_PickedUp);
+}
+
+void AShooterCharacter::AddWeapon(AWeapon* Weapon)
+{
+	if(Weapon == nullptr || Inventory.Num() == 0 || Inventory.Contains(Weapon)) return;
+
+	// Every slot is taken, the new weapon replaces the equipped one
+	int32 Slot = Inventory.Find(nullptr);
+	if(Slot == INDEX_NONE)
+	{
+		Slot = ActiveSlot;
+		DropWeapon();
+	}
+	Inventory[Slot] = Weapon;
+
+	if(EquippedWeapon == nullptr)
+	{
+		ActiveSlot = Slot;
+		EquipWeapon(Weapon);
+	}
+	else
+	{
+		HolsterWeapon(Weapon);
+	}
+}
+
+void AShooterCharacter::DropWeapon()
+{
+	if(EquippedWeapon)
+	{
+		FDetachmentTransformRules DetachmentTransformRule(EDetachmentRule::KeepWorld, true);
+		EquippedWeapon -> GetItemMesh() -> DetachFromComponent(DetachmentTransformRule);
+		
+		EquippedWeapon -> SetOwner(nullptr);
+		EquippedWeapon -> SetItemState(EItemState::EIS_Falling);
+		EquippedWeapon -> ThrowWeapon();
+		if(Inventory.IsValidIndex(ActiveSlot) && Inventory[ActiveSlot] == EquippedWeapon)
+		{
+			Inventory[ActiveSlot] = nullptr;
+		}
+		EquippedWeapon = nullptr;
+		bAiming = false;
+		PushHUDAmmo();
+	}
+}
+
+void AShooterCharacter::SwitchWeapon(int32 Slot)
+{
+	if(!Inventory.IsValidIndex(Slot) || Inventory[Slot] == nullptr || Inventory[Slot] == EquippedWeapon) return;
+	if(CombatState != ECombatState::ECS_Unoccupied) return; // Don't cut a reload or a burst short
+
+	if(EquippedWeapon)
+	{
+		HolsterWeapon(EquippedWeapon);
+	}
+	ActiveSlot = Slot;
+	EquipWeapon(Inventory[Slot]);
+}
+
+int32 AShooterCharacter::FindOccupiedSlot(int32 Direction) const
+{
+	const int32 NumSlots = Inventory.Num();
+	for(int32 Step = 1; Step <= NumSlots; Step++)
+	{
+		const int32 Slot = ((ActiveSlot + Step * Direction) % NumSlots + NumSlots) % NumSlots;
+		if(Inventory[Slot] && Inventory[Slot] != EquippedWeapon)
+		{
+			return Slot;
+		}
+	}
+	return INDEX_NONE;
+}
+
+void AShooterCharacter::ServerPickupItem_Implementation(AItem* Item)
+{
+	AWeapon* Weapon = Cast<AWeapon>(Item);
+	// Someone else may have got it first
+	if(Weapon && Weapon -> GetItemState() == EItemState::EIS_Pickup)
+	{
+		// The client only picks up items it stands next to, leave some slack for movement lag
+		const float MaxPickupDistance = 2.f * (Weapon -> GetAreaSphere() -> GetScaledSphereRadius() +
+			GetCapsuleComponent() -> GetScaledCapsuleRadius());
+		if(FVector::DistSquared(Weapon -> GetActorLocation(), GetActorLocation()) <= FMath::Square(MaxPickupDistance))
+		{
+			AddWeapon(Weapon);
+			return;
+		}
+	}
+
+	// The client added the weapon already, and nothing the server replicates changed to tell it otherwise
+	ClientCorrectInventory(Inventory, static_cast<uint8>(ActiveSlot));
+	if(Item)
+	{
+		ClientRejectPickup(Item, Item -> GetItemState(), Item -> GetActorTransform());
+	}
+}
+
+void AShooterCharacter::ClientRejectPickup_Implementation(AItem* Item, EItemState ServerItemState,
+	const FTransform& ServerItemTransform)
+{
+	if(Item == nullptr) return;
+
+	Item -> SetActorTransform(ServerItemTransform, false, nullptr, ETeleportType::ResetPhysics);
+	Item -> SetItemState(ServerItemState);
+}
+
+void AShooterCharacter::ClientCorrectInventory_Implementation(const TArray<AWeapon*>& ServerInventory,
+	uint8 ServerActiveSlot)
+{
+	// Let go of the weapons the client predicted it holds but the server doesn't
+	for(AWeapon* Weapon : Inventory)
+	{
+		if(Weapon && !ServerInventory.Contains(Weapon))
+		{
+			FDetachmentTransformRules DetachmentTransformRule(EDetachmentRule::KeepWorld, true);
+			Weapon -> GetItemMesh() -> DetachFromComponent(DetachmentTransformRule);
+			Weapon -> SetOwner(nullptr);
+			Weapon -> SetActorHiddenInGame(false);
+		}
+	}
+
+	// And take back the ones it predicted it dropped or switched away from
+	Inventory = ServerInventory;
+	ActiveSlot = Inventory.IsValidIndex(ServerActiveSlot) ? ServerActiveSlot : 0;
+	EquippedWeapon = nullptr;
+	for(int32 Slot = 0; Slot < Inventory.Num(); Slot++)
+	{
+		if(Inventory[Slot] == nullptr) continue;
+		if(Slot == ActiveSlot)
+		{
+			EquipWeapon(Inventory[Slot]);
+		}
+		else
+		{
+			HolsterWeapon(Inventory[Slot]);
+		}
+	}
+	PushHUDAmmo();
+}
+
+void AShooterCharacter::ServerDropWeapon_Implementation()
+{
+	if(CombatState != ECombatState::ECS_Unoccupied)
+	{
+		// Refused mid-reload, the client dropped already and nothing replicated changes to tell it otherwise
+		ClientCorrectInventory(Inventory, static_cast<uint8>(ActiveSlot));
+		return;
+	}
+	DropWeapon();
+	SwitchWeapon(FindOccupiedSlot(1));
+}
+
+void AShooterCharacter::ServerSwitchWeapon_Implementation(uint8 Slot)
+{
+	SwitchWeapon(Slot);
+	// Refused, e.g. the server is still reloading. The client switched already and EquippedWeapon didn't change to
+	// tell it otherwise
+	if(ActiveSlot != Slot)
+	{
+		ClientCorrectInventory(Inventory, static_cast<uint8>(ActiveSlot));
+	}
+}
+
+void AShooterCharacter::InitializeAmmo()
+{
+	FMemory::Memzero(CarriedAmmo);
+	CarriedAmmo[static_cast<int32>(EAmmoType::EAT_9mm)] = Starting9mmAmmo;
+	CarriedAmmo[static_cast<int32>(EAmmoType::EAT_AR)] = StartingARAmmo;
+	PushHUDAmmo();
+}
+
+int32 AShooterCharacter::GetCarriedAmmo(EAmmoType AmmoType) const
+{
+	const int32 Index = static_cast<int32>(AmmoType);
+	return Index < static_cast<int32>(UE_ARRAY_COUNT(CarriedAmmo)) ? CarriedAmmo[Index] : 0;
+}
+
+void AShooterCharacter::SetCombatState(ECombatState State)
+{
+	CombatState = State;
+	if(UShooterHUDViewModel* HUDViewModel = UShooterHUDViewModel::Get(this))
+	{
+		HUDViewModel -> SetCombatState(CombatState);
+	}
+}
+
+void AShooterCharacter::PushHUDAmmo() const
+{
+	UShooterHUDViewModel* HUDViewModel = UShooterHUDViewModel::Get(this);
+	if(HUDViewModel == nullptr) return;
+
+	HUDViewModel -> SetAmmoInMagazine(EquippedWeapon ? EquippedWeapon -> GetAmmo() : 0);
+	HUDViewModel -> SetCarriedAmmo(EquippedWeapon ? GetCarriedAmmo(EquippedWeapon -> GetAmmoType()) : 0);
+}
+
+void AShooterCharacter::OnRep_EquippedWeapon()
+{
+	UpdateActiveSlot();
+	PushHUDAmmo();
+}
+
+void AShooterCharacter::OnRep_Inventory()
+{
+	UpdateActiveSlot();
+}
+
+void AShooterCharacter::UpdateActiveSlot()
+{
+	// Either may arrive first, the slot is only known once the inventory holds the equipped weapon
+	const int32 Slot = EquippedWeapon ? Inventory.Find(EquippedWeapon) : INDEX_NONE;
+	if(Slot != INDEX_NONE)
+	{
+		ActiveSlot = Slot;
+	}
+}
+
+void AShooterCharacter::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	// A new local player took control, fill its HUD
+	PushHUDAmmo();
+	if(UShooterHUDViewModel* HUDViewModel = UShooterHUDViewModel::Get(this))
+	{
+		HUDViewModel -> SetCombatState(CombatState);
+		HUDViewModel -> SetCrosshairSpread(CrosshairSpreadingMultiplier);
+	}
+}
+
+bool AShooterCharacter::WeaponHasAmmo()
+{
+	if(EquippedWeapon == nullptr) return false; // If we aren't holding a weapon
+	return EquippedWeapon -> GetAmmo() > 0;
+}
+
+void AShooterCharacter::PlayFireSound()
+{
+	UGunfireAudioSubsystem* GunfireAudio = GetWorld() -> GetSubsystem<UGunfireAudioSubsystem>();
+	if(GunfireAudio == nullptr) return;
+
+	// Our own shots play in 2D, the other characters' are heard from where they are
+	const bool b2D = IsPlayerControlled() && IsLocallyControlled();
+	USoundBase* LoopSound = FireLoopSound.Get();
+	if(LoopSound == nullptr)
+	{
+		GunfireAudio -> PlayOneShot(this, FireSound.Get(), b2D);
+		return;
+	}
+
+	// A culled loop tries again with the next shots
+	if(!bFireLoopPlaying)
+	{
+		bFireLoopPlaying = GunfireAudio -> StartFireLoop(this, LoopSound, b2D);
+	}
+	if(bFireLoopPlaying)
+	{
+		// Our fire cadence stops the loop right away, the shots of other characters arrive in packets and the loop
+		// stops when none came for two fire intervals. Less significant characters tick, and so release their shots,
+		// less often than they fire, the loop waits for two of their ticks then
+		const float FireInterval = FMath::Max3(AutomaticFireRate, GetActorTickInterval(), KINDA_SMALL_NUMBER);
+		GetWorldTimerManager().SetTimer(FireLoopTimer, FTimerDelegate::CreateUObject(this,
+			&AShooterCharacter::StopFireLoop, true), 2.f * FireInterval, false);
+	}
+}
+
+void AShooterCharacter::StopFireLoop(bool bPlayTail)
+{
+	GetWorldTimerManager().ClearTimer(FireLoopTimer);
+	if(!bFireLoopPlaying) return;
+
+	bFireLoopPlaying = false;
+	UGunfireAudioSubsystem* GunfireAudio = GetWorld() -> GetSubsystem<UGunfireAudioSubsystem>();
+	if(GunfireAudio)
+	{
+		GunfireAudio -> StopFireLoop(this, bPlayTail ? FireTailSound.Get() : nullptr);
+	}
+}
+
+void AShooterCharacter::SetSignificance(EShooterSignificance NewSignificance)
+{
+	Significance = NewSignificance;
+	// The fire cadence releases every shot due since the last tick, so a longer interval doesn't change the fire rate
+	SetActorTickInterval(UShooterSignificanceSubsystem::GetTickInterval(Significance));
+}
+
+void AShooterCharacter::SendBullets(const TArray<FShotRequest>& Shots)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_SendBullets);
+
+	SpawnMuzzleFlashes(Shots);
+	QueueShots(Shots);
+}
+
+void AShooterCharacter::QueueShots(const TArray<FShotRequest>& Shots)
+{
+	// UProjectileSubsystem spawns the impacts when the projectiles hit something
+	UProjectileSubsystem* ProjectileSubsystem = GetWorld() -> GetSubsystem<UProjectileSubsystem>();
+	if(ProjectileSubsystem && EquippedWeapon && EquippedWeapon -> FiresProjectiles())
+	{
+		ProjectileSubsystem -> FireProjectiles(Shots, *EquippedWeapon);
+		return;
+	}
+
+	// Impact and beam are spawned in ResolveShot once the shots are traced
+	UHitscanSubsystem* HitscanSubsystem = GetWorld() -> GetSubsystem<UHitscanSubsystem>();
+	if(HitscanSubsystem)
+	{
+		HitscanSubsystem -> QueueShots(Shots);
+	}
+}
+
+void AShooterCharacter::SpawnMuzzleFlashes(const TArray<FShotRequest>& Shots)
+{
+	UFXPoolSubsystem* FXPool = GetWorld() -> GetSubsystem<UFXPoolSubsystem>();
+	UParticleSystem* Flash = MuzzleFlash.Get();
+	if(Flash && FXPool)
+	{
+		for(const FShotRequest& Shot : Shots)
+		{
+			FXPool -> SpawnEmitter(Flash, Shot.MuzzleTransform);
+		}
+	}
+}
+
+void AShooterCharacter::ReplicateShots(const TArray<FShotRequest>& Shots)
+{
+	if(GetNetMode() == NM_Standalone) return;
+
+	// The server rewinds the other characters to the time the shots were fired, in its own clock
+	const AGameStateBase* GameState = GetWorld() -> GetGameState();
+	const float ServerTimeOffset = GameState ?
+		static_cast<float>(GameState -> GetServerWorldTimeSeconds()) - GetWorld() -> GetTimeSeconds() : 0.f;
+
+	for(int32 ShotIndex = 0; ShotIndex < Shots.Num();)
+	{
+		FShotBatchPacket Packet;
+		Packet.FirstSequence = NextShotSequence;
+		while(ShotIndex < Shots.Num() &&
+			Packet.AddShot(Shots[ShotIndex], Shots[ShotIndex].Timestamp + ServerTimeOffset))
+		{
+			++ShotIndex;
+			++NextShotSequence;
+		}
+
+		// Measuring a packet serializes a copy of it, only do it when the size is read
+		const bool bLogShotPackets = CVarLogShotPackets.GetValueOnGameThread() != 0;
+		if(STATS || bLogShotPackets)
+		{
+			const int32 PacketBits = Packet.GetSerializedBits();
+			const float BytesPerShot = PacketBits / 8.f / Packet.Shots.Num();
+			INC_DWORD_STAT_BY(STAT_ShotPacketBits, PacketBits);
+			INC_DWORD_STAT_BY(STAT_ShotPacketShots, Packet.Shots.Num());
+			ShotPacketBitsSent += PacketBits;
+			ShotPacketShotsSent += Packet.Shots.Num();
+			SET_FLOAT_STAT(STAT_ShotPacketBytesPerShot, BytesPerShot);
+			if(bLogShotPackets)
+			{
+				UE_LOG(LogShooter, Log, TEXT("Shot packet: %d shots, %d bits, %.2f bytes per shot"),
+					Packet.Shots.Num(), PacketBits, BytesPerShot);
+			}
+		}
+
+		if(HasAuthority())
+		{
+			// Listen server, the shots are already authoritative
+			MulticastFireShots(Packet);
+		}
+		else
+		{
+			ServerFireShots(Packet);
+		}
+	}
+}
+
+void AShooterCharacter::ServerFireShots_Implementation(const FShotBatchPacket& Packet)
+{
+	if(EquippedWeapon == nullptr) return;
+
+	// Refill the budget at the fire rate, so the client can't fire faster than its weapon allows
+	const float Now = GetWorld() -> GetTimeSeconds();
+	const float FireInterval = FMath::Max(AutomaticFireRate, KINDA_SMALL_NUMBER);
+	ServerFireBudget = FMath::Min(ServerFireBudget + (Now - ServerLastFireTime) / FireInterval, ServerFireBurst);
+	ServerLastFireTime = Now;
+
+	// The client saw the other characters about half a round trip behind the server
+	const ULagCompensationSubsystem* LagCompensation = GetWorld() -> GetSubsystem<ULagCompensationSubsystem>();
+	const float ViewDelay = GetPlayerState() ? GetPlayerState() -> GetPingInMilliseconds() / 2000.f : 0.f;
+
+	ShotBatch.Reset();
+	for(int32 ShotIndex = 0; ShotIndex < Packet.Shots.Num(); ShotIndex++)
+	{
+		const uint16 Sequence = Packet.FirstSequence + ShotIndex;
+		if(!IsShotSequenceNewer(Sequence, LastServerShotSequence)) continue; // Already received
+		LastServerShotSequence = Sequence;
+
+		if(CombatState == ECombatState::ECS_Reloading) continue;
+		if(!WeaponHasAmmo() || ServerFireBudget < 1.f) continue;
+
+		FShotRequest Shot;
+		Packet.GetShot(ShotIndex, 50'000.f, Shot);
+		if(FVector::DistSquared(Shot.CrosshairTraceStart, GetActorLocation()) >
+			FMath::Square(ServerMaxShotOriginDistance)) continue;
+
+		Shot.Shooter = this;
+		if(LagCompensation)
+		{
+			Shot.Timestamp = LagCompensation -> ClampRewindTime(Shot.Timestamp - ViewDelay);
+			Shot.bRewind = true;
+		}
+		else
+		{
+			Shot.Timestamp = Now;
+		}
+		ShotBatch.Add(Shot);
+		ServerShotsAccepted++;
+		ServerFireBudget -= 1.f;
+		EquippedWeapon -> DecrementAmmo();
+	}
+
+	if(ShotBatch.Num() > 0)
+	{
+		// The server's traces decide what was hit
+		QueueShots(ShotBatch);
+
+		FShotBatchPacket AcceptedPacket;
+		for(const FShotRequest& Shot : ShotBatch)
+		{
+			AcceptedPacket.AddShot(Shot, Shot.Timestamp);
+		}
+		MulticastFireShots(AcceptedPacket);
+	}
+	ClientConfirmShots(LastServerShotSequence, EquippedWeapon -> GetAmmo());
+}
+
+void AShooterCharacter::ClientConfirmShots_Implementation(uint16 LastSequence, int32 ServerAmmo)
+{
+	if(!IsShotSequenceNewer(LastSequence, LastConfirmedShotSequence)) return; // Out of order confirmation
+	LastConfirmedShotSequence = LastSequence;
+
+	// Ammo changes while reloading, wait for the next confirmation
+	if(EquippedWeapon == nullptr || CombatState == ECombatState::ECS_Reloading) return;
+
+	// Shots fired after LastSequence haven't reached the server yet, keep them predicted
+	const uint16 PendingShots = NextShotSequence - 1 - LastSequence;
+	EquippedWeapon -> SetAmmo(ServerAmmo - PendingShots);
+}
+
+void AShooterCharacter::MulticastFireShots_Implementation(const FShotBatchPacket& Packet)
+{
+	// The shooter predicted its own shots, and a dedicated server has nothing to show
+	if(IsLocallyControlled() || GetNetMode() == NM_DedicatedServer) return;
+
+	ShotBatch.Reset();
+	for(int32 ShotIndex = 0; ShotIndex < Packet.Shots.Num(); ShotIndex++)
+	{
+		FShotRequest& Shot = ShotBatch.AddDefaulted_GetRef();
+		Packet.GetShot(ShotIndex, 50'000.f, Shot);
+		Shot.Shooter = this;
+		Shot.Timestamp = GetWorld() -> GetTimeSeconds();
+	}
+
+	PlayFireSound();
+	PlayFireAnimation(ShotBatch.Num());
+	if(HasAuthority())
+	{
+		// Listen server, ServerFireShots already traced the shots
+		SpawnMuzzleFlashes(ShotBatch);
+	}
+	else
+	{
+		SendBullets(ShotBatch);
+	}
+}
+
+void AShooterCharacter::ResolveShot(const FShotRequest& Shot, bool bBeamEnd)
+{
+	if(GetNetMode() == NM_DedicatedServer) return; // Nobody to show the effects to
+
+	UFXPoolSubsystem* FXPool = GetWorld() -> GetSubsystem<UFXPoolSubsystem>();
+	if(bBeamEnd && FXPool)
+	{
+		SpawnImpactParticles(Shot.BeamEndLocation);
+
+		UParticleSystem* BeamTemplate = BeamParticles.Get();
+		if(BeamTemplate)
+		{
+			UParticleSystemComponent* Beam = FXPool -> SpawnEmitter(BeamTemplate, Shot.MuzzleTransform);
+			if(Beam)
+			{
+				Beam -> SetVectorParameter(FName("Target"), Shot.BeamEndLocation);
+			}
+		}
+	}
+}
+
+void AShooterCharacter::SpawnImpactParticles(const FVector& ImpactLocation)
+{
+	if(GetNetMode() == NM_DedicatedServer) return; // Nobody to show the effects to
+
+	UFXPoolSubsystem* FXPool = GetWorld() -> GetSubsystem<UFXPoolSubsystem>();
+	UParticleSystem* Impact = ImpactParticles.Get();
+	if(FXPool && Impact)
+	{
+		FXPool -> SpawnEmitter(Impact, ImpactLocation);
+	}
+}
+
+void AShooterCharacter::PlayFireAnimation(int32 NumShots)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_PlayFireAnimation);
+	CSV_SCOPED_TIMING_STAT(Shooter, PlayFireAnimation);
+
+	// The animation instance reads these on its next update, sustained fire doesn't touch any montage
+	if(CVarProceduralFireRecoil.GetValueOnGameThread() != 0)
+	{
+		FireShotCount += NumShots;
+		LastFireTime = GetWorld() -> GetTimeSeconds();
+		return;
+	}
+
+	UAnimInstance* AnimInstance = GetMesh() -> GetAnimInstance();
+	UAnimMontage* Montage = HipFireMontage.Get();
+	if(AnimInstance && Montage)
+	{
+		AnimInstance -> Montage_Play(Montage);
+		AnimInstance -> Montage_JumpToSection(FName("StartFire"));
+		INC_DWORD_STAT(STAT_FireMontagesPlayed);
+	}
+}
+
+void AShooterCharacter::ReloadButtonPressed()
+{
+	ReloadWeapon();
+}
+
+void AShooterCharacter::ReloadWeapon()
+{
+	if(CombatState != ECombatState::ECS_Unoccupied) return;
+	if(EquippedWeapon == nullptr) return;
+	
+	if(CarryingAmmo()) // are we carrying the correct type of ammo?
+	{
+		if(!HasAuthority() && IsLocallyControlled())
+		{
+			ServerReloadWeapon();
+		}
+		SetCombatState(ECombatState::ECS_Reloading);
+		UAnimInstance* AnimInstance = GetMesh() -> GetAnimInstance();
+		UAnimMontage* Montage = ReloadMontage.Get();
+		if(AnimInstance && Montage)
+		{
+			AnimInstance ->	Montage_Play(Montage);
+			AnimInstance -> Montage_JumpToSection(EquippedWeapon -> GetReloadMontageSection());
+		}
+	}
+}
+
+void AShooterCharacter::ServerReloadWeapon_Implementation()
+{
+	ReloadWeapon();
+}
+
+void AShooterCharacter::FinishReloading()
+{
+	SetCombatState(ECombatState::ECS_Unoccupied);
+	if(EquippedWeapon == nullptr) return;
+	const int32 AmmoIndex = static_cast<int32>(EquippedWeapon -> GetAmmoType());
+	if(AmmoIndex >= static_cast<int32>(UE_ARRAY_COUNT(CarriedAmmo))) return;
+
+	int32& Carried = CarriedAmmo[AmmoIndex];
+	const int32 MagEmptySpace = EquippedWeapon -> GetMagazineCapacity() - EquippedWeapon -> GetAmmo();
+
+	if(Carried < MagEmptySpace)
+	{
+		// Reload the magazine with all the ammo we are carrying
+		EquippedWeapon -> ReloadAmmo(Carried);
+		Carried = 0;
+	}
+	else
+	{
+		// Fully fill the magazine
+		EquippedWeapon -> ReloadAmmo(MagEmptySpace);
+		Carried -= MagEmptySpace;
+	}
+	PushHUDAmmo();
+}
+
+bool AShooterCharacter::CarryingAmmo()
+{
+	if(EquippedWeapon == nullptr) return false;
+
+	return GetCarriedAmmo(EquippedWeapon -> GetAmmoType()) > 0;
+}
+
+void AShooterCharacter::GrabClip()
+{
+	if(EquippedWeapon == nullptr) return;
+	if(ClipSceneComponent == nullptr) return;
+	
+	const int32 ClipBoneIndex{ EquippedWeapon -> GetItemMesh() -> GetBoneIndex(EquippedWeapon -> GetClipBoneName()) };
+	// Initial transform of the clip when hand first touches the clip
+	ClipTransform = EquippedWeapon -> GetItemMesh() -> GetBoneTransform(ClipBoneIndex);
+	
+	const FAttachmentTransformRules AttachmentRules{ EAttachmentRule::KeepRelative, true };
+	ClipSceneComponent -> AttachToComponent(GetMesh(), AttachmentRules, FName(TEXT("hand_l")));
+	ClipSceneComponent -> SetWorldTransform(ClipTransform);
+
+	EquippedWeapon -> SetMovingClip(true);
+}
+
+void AShooterCharacter::ReleaseClip()
+{
+	if(EquippedWeapon == nullptr) return;
+
+	EquippedWeapon -> SetMovingClip(false);
+}
+
+// Called every frame
+void AShooterCharacter::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	CSV_SCOPED_TIMING_STAT(Shooter, CharacterTick);
+	
+	// Handle interpolation for zoom when aiming
+	CameraInterpZoom(DeltaTime);
+	// Change look sensitivity based on aiming state
+	SetLookRates();
+	// Release the automatic fire shots due this frame
+	UpdateFireCadence(DeltaTime);
+	// Calculate crosshair spread multiplier
+	CalculateCrosshairSpread(DeltaTime);
+	// Look for items to pick up around the character, only its own player or bot needs to know
+	if(IsLocallyControlled())
+	{
+		PickupTrace();
+	}
+}
+
+// Called to bind functionality to input
+void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
+{
+	Super::SetupPlayerInputComponent(PlayerInputComponent);
+	check(PlayerInputComponent);
+
+	PlayerInputComponent->BindAxis("Move Forward / Backward", this, &AShooterCharacter::MoveForward);
+	PlayerInputComponent->BindAxis("Move Right / Left", this, &AShooterCharacter::MoveRight);
+	PlayerInputComponent->BindAxis("TurnRate", this, &AShooterCharacter::TurnAtRate);
+	PlayerInputComponent->BindAxis("LookUpRate", this, &AShooterCharacter::LookUpRate);
+	PlayerInputComponent->BindAxis("Turn Right / Left", this, &AShooterCharacter::Turn);
+	PlayerInputComponent->BindAxis("Look Up / Down", this, &AShooterCharacter::LookUp);
+
+	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
+	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
+	PlayerInputComponent->BindAction("FireButton", IE_Pressed, this, &AShooterCharacter::FireButtonPressed);
+	PlayerInputComponent->BindAction("FireButton", IE_Released, this, &AShooterCharacter::FireButtonReleased);
+	PlayerInputComponent->BindAction("AimingButton", IE_Pressed, this, &AShooterCharacter::AimingButtonPressed);
+	PlayerInputComponent->BindAction("AimingButton", IE_Released, this, &AShooterCharacter::AimingButtonReleased);
+	PlayerInputComponent->BindAction("Select", IE_Pressed, this, &AShooterCharacter::SelectButtonPressed);
+	PlayerInputComponent->BindAction("Select", IE_Released, this, &AShooterCharacter::SelectButtonReleased);
+	PlayerInputComponent->BindAction("Drop", IE_Pressed, this, &AShooterCharacter::DropButtonPressed);
+	PlayerInputComponent->BindAction("Drop", IE_Released, this, &AShooterCharacter::DropButtonReleased);
+	PlayerInputComponent->BindAction("Reload", IE_Pressed, this, &AShooterCharacter::ReloadButtonPressed);
+	PlayerInputComponent->BindAction("NextWeapon", IE_Pressed, this, &AShooterCharacter::NextWeaponPressed);
+	PlayerInputComponent->BindAction("PreviousWeapon", IE_Pressed, this, &AShooterCharacter::PreviousWeaponPressed);
+	// WeaponSlot1, WeaponSlot2... select a slot directly
+	for(int32 Slot = 0; Slot < WeaponSlots; Slot++)
+	{
+		FInputActionBinding SlotBinding(FName(*FString::Printf(TEXT("WeaponSlot%d"), Slot + 1)), IE_Pressed);
+		SlotBinding.ActionDelegate.GetDelegateForManualSet().BindUObject(this,
+			&AShooterCharacter::WeaponSlotPressed, Slot);
+		PlayerInputComponent->AddActionBinding(SlotBinding);
+	}
+}
+
+float AShooterCharacter::GetCrosshairSpreadMultiplier() const
+{
+	return CrosshairSpreadingMultiplier;
+}
+
+FVector AShooterCharacter::GetPickupInterpTargetLocation()
+{
+	const FVector CameraWorldLocation{ FollowCamera -> GetComponentLocation() };
+	const FVector CameraForward{ FollowCamera -> GetForwardVector() };
+	// Desired location = Camera location + (Forward * A) + (Up * B)
+	return CameraWorldLocation + (CameraForward * CameraPickupInterpDistance) + FVector(0.f, 0.f,
+		CameraPickupInterpElevation);
+}
+
+void AShooterCharacter::PickupItem(AItem* Item)
+{
+	if(Item -> GetEquipSound())
+	{
+		UGameplayStatics::PlaySound2D(this, Item -> GetEquipSound());
+	}
+	
+	auto Weapon = Cast<AWeapon>(Item);
+	if(Weapon)
+	{
+		AddWeapon(Weapon);
+		if(!HasAuthority())
+		{
+			ServerPickupItem(Weapon);
+		}
+	}
+}
+
+void AShooterCharacter::GetCombatAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Add(FireSound.ToSoftObjectPath());
+	OutPaths.Add(FireLoopSound.ToSoftObjectPath());
+	OutPaths.Add(FireTailSound.ToSoftObjectPath());
+	OutPaths.Add(MuzzleFlash.ToSoftObjectPath());
+	OutPaths.Add(HipFireMontage.ToSoftObjectPath());
+	OutPaths.Add(ImpactParticles.ToSoftObjectPath());
+	OutPaths.Add(BeamParticles.ToSoftObjectPath());
+	OutPaths.Add(ReloadMontage.ToSoftObjectPath());
+	OutPaths.Add(DefaultWeaponClass.ToSoftObjectPath());
+}
+
+void AShooterCharacter::OnCombatAssetsLoaded()
+{
+	// Create the pooled combat effects up front, so the first shots don't allocate them
+	UFXPoolSubsystem* FXPool = GetWorld() -> GetSubsystem<UFXPoolSubsystem>();
+	if(FXPool)
+	{
+		FXPool -> Prewarm(MuzzleFlash.Get());
+		FXPool -> Prewarm(ImpactParticles.Get());
+		FXPool -> Prewarm(BeamParticles.Get());
+	}
+	// Spawn the default Weapon and equip it, the server's weapon replicates to the clients.
+	// Pooled characters get theirs when they leave the pool
+	if(HasAuthority() && EquippedWeapon == nullptr && !bInActorPool)
+	{
+		AddWeapon(SpawnDefaultWeapon());
+	}
 }
\ No newline at end of file
@@ -1,379 +1,618 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/Character.h"
-#include "AmmoType.h"
-#include "ShooterCharacter.generated.h"
-
-UENUM(BlueprintType)
-enum class ECombatState : uint8
-{
-	ECS_Unoccupied UMETA(DisplayName = "Unoccupied"),
-	ECS_FireRateTimerInProgress UMETA(DisplayName = "FireRateTimerInProgress"),
-	ECS_Reloading UMETA(DisplayName = "Reloading"),
-
-	ECS_Max UMETA(Display = "DefaultMax")
-};
-
-UCLASS()
-class SHOOTER_API AShooterCharacter : public ACharacter
-{
-	GENERATED_BODY()
-
-public:
-	// Sets default values for this character's properties
-	AShooterCharacter();
-
-protected:
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
-
-	/** Called for forwards/backwards input */
-	void MoveForward(float Value);
-
-	/** Called for side to side input */
-	void MoveRight(float Value);
-
-	/** 
-	* Called via input to turn at a given rate.
-	* @param Rate This is a normalized rate, i.e. 1.0 means %100 of desired turn rate
-	*/
-	void TurnAtRate(float Rate);
-
-	/**
-	* Called via input to turn at a given rate.
-	* @param Rate This is a normalized rate, i.e. 1.0 means %100 of desired turn rate
-	*/
-	void LookUpRate(float Rate);
-
-	/**
-	* Rotate controller based on mouse X movement
-	* @param Value The input value from mouse movement
-	*/
-	void Turn(float Value);
-
-	/**
-	* Rotate controller based on mouse Y movement
-	* @param Value The input value from mouse movement
-	*/
-	void LookUp(float Value);
-	
-	/**
-	 * Called when the fire button is pressed
-	 */
-	void FireWeapon();
-
-	/** Set bAiming to true or false with button pressed */
-	void AimingButtonPressed();
-
-	/** Set bAiming to true or false with button pressed */
-	void AimingButtonReleased();
-
-	/** Perform a line trace from crosshair screen location outward */
-	bool LineTraceFromCrosshair(FHitResult &OutHitResult);
-
-	/** Perform a second line trace from gun barrel to where the beam ends and mix the two trace together
-	 *  and get the end location vector
-	 *  @param MuzzleSocketLocation The location of gun barrel tip and where Muzzle particle spawns
-	 *  @param OutBeamLocation Give out the location of where beam trace ends
-	 */
-	bool LineTraceFromGunBarrel(const FVector& MuzzleSocketLocation, FVector& OutBeamLocation);
-
-	/** Calculate camera interpolation zoom */
-	void CameraInterpZoom(float DeltaTime);
-
-	/** Set BaseTurnRate and BaseLookUpRate based on aiming state */
-	void SetLookRates();
-
-	/** Calculate dynamic crosshair animation */
-	void CalculateCrosshairSpread(float DeltaTime);
-
-	/** Crosshair BulletFire animation */
-	UFUNCTION()
-	void StartCrosshairBulletFire();
-	UFUNCTION()
-	void FinishCrosshairBulletFire();
-
-	/** Automatic fire loop */
-	void FireButtonPressed();
-	void FireButtonReleased();
-	void StartFireRateTimer();
-	UFUNCTION()
-	void FireRateTimerReset();
-
-	/** Trace for items if OverlappedItemCount > 0 */
-	void PickupTrace();
-
-	/** Spawn default Weapon for the character */
-	class AWeapon* SpawnDefaultWeapon();
-
-	/** Attach Weapon to HandSocket and apply appropriate properties */
-	void EquipWeapon(AWeapon* WeaponToEquip);
-
-	/** Detach Weapon from HandSocket and drop it */
-	void DropWeapon();
-
-	void SelectButtonPressed();
-	void SelectButtonReleased();
-	
-	void DropButtonPressed();
-	void DropButtonReleased();
-
-	/** Drops currently equipped Weapon and equips PickupTraceHitItem */
-	void SwapWeapon(AWeapon* WeaponToSwap);
-
-	/** Initialize the AmmoMap with ammo values */
-	void InitializeAmmoMap();
-
-	/** Return true if EquippedWeapon has ammo */
-	bool WeaponHasAmmo();
-
-	/** Play firing sound */
-	void PlayFireSound();
-
-	/** Perform linetrace for shooting and gathering information */
-	void SendBullet();
-
-	/** Play HipFire montage animation */
-	void PlayHipFireMontage();
-	
-	void ReloadButtonPressed();
-
-	/** Handle reloading the weapon */
-	void ReloadWeapon();
-
-	UFUNCTION(BlueprintCallable)
-	void FinishReloading();
-
-	/** Return true if the character is carrying the type of ammo matching to EquippedWeapon's */
-	bool CarryingAmmo();
-	
-	UFUNCTION(BlueprintCallable)
-	void GrabClip();
-
-	UFUNCTION(BlueprintCallable)
-	void ReleaseClip();
-
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
-	// Called to bind functionality to input
-	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
-
-private:
-	/** Camera Boom Positioning the camera behind the character */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-    class USpringArmComponent* CameraBoom;
-	
-	/** Camera that follows the character */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	class UCameraComponent* FollowCamera;
-
-	/** Base turn rate in deg/sec. Other scaling may affect fina turn rate */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	float BaseTurnRate;
-
-	/** Base turn rate in deg/sec. Other scaling may affect fina turn rate */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	float BaseLookUpRate;
-
-	/** Turn rate while not aiming */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	float HipTurnRate;
-
-	/** Look up rate while not aiming */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	float HipLookUpRate;
-
-	/** Turn rate while aiming */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	float AimingTurnRate;
-
-	/** Look up rate while aiming */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	float AimingLookUpRate;
-
-	/** Scale factor for mouse look sensitivity, Turn rate when not aiming. */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
-		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
-	float MouseHipTurnRate;
-
-	/** Scale factor for mouse look sensitivity, Look up rate when not aiming. */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
-		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
-	float MouseHipLookUpRate;
-
-	/** Scale factor for mouse look sensitivity, Turn rate when aiming. */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
-		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
-	float MouseAimingTurnRate;
-	
-	/** Scale factor for mouse look sensitivity, Look up rate when aiming. */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
-		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
-	float MouseAimingLookUpRate;
-
-	/** Randomized gunshot sound cue */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	class USoundCue* FireSound;
-
-	/** Flash spawned at BarrelSocket */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	UParticleSystem* MuzzleFlash;
-	
-	/** Montage for firing weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* HipFireMontage;
-
-	/** Particles spawned upon bullet impact */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	UParticleSystem* ImpactParticles;
-	
-	/** Smoke trail for bullets */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	UParticleSystem* BeamParticles;
-
-	/** True when aiming */
-	UPROPERTY(BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	bool bAiming;
-
-	/** Default camera field of view value */
-	float CameraDefaultFOV;
-	
-	/** Field of view value when the camera is zoomed in */
-	float CameraZoomedFOV;
-
-	/** Current camera field of view value */
-	float CameraCurrentFOV;
-
-	/** Interp speed for zooming when aiming */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float ZoomInterpSpeed;
-
-	/** Determines the spread of the crosshairs */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
-	float CrosshairSpreadingMultiplier;
-
-	/** Velocity component for crosshairs spread */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
-	float CrosshairVelocityFactor;
-
-	/** In air component for crosshairs spread */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
-	float CrosshairInAirFactor;
-
-	/** Aim component for crosshairs spread */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
-	float CrosshairAimingFactor;
-
-	/** Shooting component for crosshairs spread */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
-	float CrosshairShootingFactor;
-
-	/** Right mouse button or right console trigger pressed */
-	bool bFireButtonPressed;
-
-	/** True when we can fire. False when waiting for the timer */
-	bool bShouldFire;
-	
-	/** True while gun is firing */
-	bool bFiringBullet;
-
-	/** Rate of automatic gun fire */
-	float AutomaticFireRate;
-	
-	/** Duration of crosshair spread for shooting */
-	float CrosshairShootingDuration;
-	
-	/** Sets a timer between gunshots */
-	FTimerHandle AutomaticFireRateTimer;
-
-	/** Sets a timer between crosshair spreads */
-	FTimerHandle CrosshairShootTimer;
-
-	/** True if we should trac every frame for items */
-	bool bShouldTraceForItems;
-
-	/** Number of overlapped AItem */
-	int8 OverlappedItemCount;
-
-	/** The AItem we currently hit by our trace in PickupTrace (could we null) */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class AItem* PickupTraceHitItem;
-	
-	/** The AItem we hit last frame in PickupTrace */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items , meta = (AllowPrivateAccess = "true"))
-	AItem* PreviousPickupTraceHitItem;
-
-	/** Currently equipped weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	AWeapon* EquippedWeapon;
-
-	/** Set default weapon class blueprint */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	TSubclassOf<AWeapon> DefaultWeaponClass;
-
-	/** Distance of desired location for Item pickup interpolation from the camera */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float CameraPickupInterpDistance;
-
-	/** Elevation of desired location for Item pickup interpolation from the camera */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float CameraPickupInterpElevation;
-
-	/** Map to keep track of ammo of different ammo types */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	TMap<EAmmoType, int32> AmmoMap;
-
-	/** Starting amount of 9mm ammo */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	int32 Starting9mmAmmo;
-
-	/** Starting amount of 9mm ammo */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	int32 StartingARAmmo;
-
-	/** State of Character's combat */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	ECombatState CombatState;
-
-	/** Montage for reloading the weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* ReloadMontage;
-
-	/** Transform of the clip when hand touches the clip for the first time */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	FTransform ClipTransform;
-
-	/** Scene component to keep track of hand location with initial offset from the clip */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat , meta = (AllowPrivateAccess = "true"))
-	USceneComponent* ClipSceneComponent;
-	
-public:
-	/** Returns CameraBoom subObject */
-	FORCEINLINE USpringArmComponent *GetCameraBoom() const { return CameraBoom; }
-	/** Returns FollowCamera subObject */
-	FORCEINLINE UCameraComponent* GetFollowCamera() const { return FollowCamera; }
-
-	FORCEINLINE bool GetAiming() const { return bAiming; }
-
-	/** Returns CrosshairSpreadingMultiplier function */
-	UFUNCTION(BlueprintCallable)
-	float GetCrosshairSpreadMultiplier() const;
-	
-	FORCEINLINE int8 GetOverlappedItemCount() const { return OverlappedItemCount; }
-
-	/** Adds/subtracts OverlappedItemCount and updates bShouldTraceForItems  */
-	void IncrementOverlappedItemCount(int8 Value);
-
-	/** Get the desired location for Item pick up interpolation */
-	FVector GetPickupInterpTargetLocation();
-
-	/** Set an item to pickup
-	 * @param Item Item to pick up
-	 */
-	void PickupItem(AItem* Item);
-};
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Character.h"
+#include "AmmoType.h"
+#include "Item.h"
+#include "HitscanSubsystem.h"
+#include "ShotPacket.h"
+#include "LagCompensationSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "ShooterSignificanceSubsystem.h"
+#include "ShooterCharacter.generated.h"
+
+UENUM(BlueprintType)
+enum class ECombatState : uint8
+{
+	ECS_Unoccupied UMETA(DisplayName = "Unoccupied"),
+	ECS_FireRateTimerInProgress UMETA(DisplayName = "FireRateTimerInProgress"),
+	ECS_Reloading UMETA(DisplayName = "Reloading"),
+
+	ECS_Max UMETA(Display = "DefaultMax")
+};
+
+UCLASS()
+class SHOOTER_API AShooterCharacter : public ACharacter, public IPooledActor
+{
+	GENERATED_BODY()
+
+	/** Bots press the same buttons as the input bindings */
+	friend class AShooterBotController;
+
+public:
+	// Sets default values for this character's properties
+	AShooterCharacter();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the character is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Respawn: registers again, walks, starting ammo and a default weapon */
+	virtual void OnAcquiredFromPool() override;
+
+	/** Sends the inventory back to the pool and resets the combat state, the caller unpossesses the character */
+	virtual void OnReleasedToPool() override;
+
+	/** Register with the lag compensation (on the server), the animation budget and the significance */
+	void RegisterWithSubsystems();
+	void UnregisterFromSubsystems();
+
+	// Called on the owning client when it takes control of the character
+	virtual void PawnClientRestart() override;
+
+	/** Called for forwards/backwards input */
+	void MoveForward(float Value);
+
+	/** Called for side to side input */
+	void MoveRight(float Value);
+
+	/** 
+	* Called via input to turn at a given rate.
+	* @param Rate This is a normalized rate, i.e. 1.0 means %100 of desired turn rate
+	*/
+	void TurnAtRate(float Rate);
+
+	/**
+	* Called via input to turn at a given rate.
+	* @param Rate This is a normalized rate, i.e. 1.0 means %100 of desired turn rate
+	*/
+	void LookUpRate(float Rate);
+
+	/**
+	* Rotate controller based on mouse X movement
+	* @param Value The input value from mouse movement
+	*/
+	void Turn(float Value);
+
+	/**
+	* Rotate controller based on mouse Y movement
+	* @param Value The input value from mouse movement
+	*/
+	void LookUp(float Value);
+	
+	/**
+	 * Called when the fire button is pressed
+	 */
+	void FireWeapon();
+
+	/** Set bAiming to true or false with button pressed */
+	void AimingButtonPressed();
+
+	/** Set bAiming to true or false with button pressed */
+	void AimingButtonReleased();
+
+	/** Get the start and end of a trace from crosshair screen location outward
+	 *  @return False if the crosshair couldn't be deprojected to the world */
+	bool GetCrosshairTraceSegment(FVector& OutStart, FVector& OutEnd);
+
+	/** Perform a line trace from crosshair screen location outward */
+	bool LineTraceFromCrosshair(FHitResult &OutHitResult);
+
+	/** Calculate camera interpolation zoom */
+	void CameraInterpZoom(float DeltaTime);
+
+	/** Set BaseTurnRate and BaseLookUpRate based on aiming state */
+	void SetLookRates();
+
+	/** Calculate dynamic crosshair animation */
+	void CalculateCrosshairSpread(float DeltaTime);
+
+	/** Crosshair BulletFire animation */
+	UFUNCTION()
+	void StartCrosshairBulletFire();
+	UFUNCTION()
+	void FinishCrosshairBulletFire();
+
+	/** Automatic fire loop */
+	void FireButtonPressed();
+	void FireButtonReleased();
+
+	/** Start counting down AutomaticFireRate until the next shot */
+	void StartFireCadence();
+
+	/** Release every shot due this frame while the fire button is held, reload when the weapon is empty
+	 *  @param DeltaTime Length of the frame, shots are spread over it */
+	void UpdateFireCadence(float DeltaTime);
+
+	/** Get the muzzle transform and crosshair trace of this frame for firing
+	 *  @param OutShot Shot to fill, it's fired at the current time
+	 *  @return False if the barrel or crosshair couldn't be found */
+	bool GetFireSample(FShotRequest& OutShot);
+
+	/** Fire a batch of shots: ammo, sound, muzzle flashes, traces and animation */
+	void FireShots(const TArray<FShotRequest>& Shots);
+
+	/** Find the item to pick up with UPickupIndexSubsystem and show its pickup widget */
+	void PickupTrace();
+
+	/** Trace from the camera to confirm nothing blocks the view of Item */
+	bool IsItemVisible(AItem* Item);
+
+	/** Spawn default Weapon for the character */
+	class AWeapon* SpawnDefaultWeapon();
+
+	/** Attach Weapon to HandSocket and make it the equipped one, the weapon must be in Inventory */
+	void EquipWeapon(AWeapon* WeaponToEquip);
+
+	/** Keep Weapon attached to HandSocket, but hidden and out of the way of the equipped one */
+	void HolsterWeapon(AWeapon* Weapon);
+
+	/** Put Weapon in a free inventory slot, or in place of the equipped weapon if every slot is taken.
+	 *	The weapon is equipped if the character's hands are empty */
+	void AddWeapon(AWeapon* Weapon);
+
+	/** Detach the equipped Weapon from HandSocket, drop it and free its slot */
+	void DropWeapon();
+
+	/** Equip the weapon in Slot right away, the previous one is holstered */
+	void SwitchWeapon(int32 Slot);
+
+	/** Returns the first occupied slot after ActiveSlot in Direction (1 or -1), or INDEX_NONE */
+	int32 FindOccupiedSlot(int32 Direction) const;
+
+	void SelectButtonPressed();
+	void SelectButtonReleased();
+	
+	void DropButtonPressed();
+	void DropButtonReleased();
+
+	void NextWeaponPressed();
+	void PreviousWeaponPressed();
+	void WeaponSlotPressed(int32 Slot);
+
+	/** Pick up the item on the server once the client's pickup interpolation is done */
+	UFUNCTION(Server, Reliable)
+	void ServerPickupItem(AItem* Item);
+
+	/** The server refused the client's pickup of Item, put the item back the way the server has it */
+	UFUNCTION(Client, Reliable)
+	void ClientRejectPickup(AItem* Item, EItemState ServerItemState, const FTransform& ServerItemTransform);
+
+	/** Make the owning client's inventory match the server's, after a predicted change the server refused */
+	UFUNCTION(Client, Reliable)
+	void ClientCorrectInventory(const TArray<AWeapon*>& ServerInventory, uint8 ServerActiveSlot);
+
+	/** Drop the equipped weapon on the server as well */
+	UFUNCTION(Server, Reliable)
+	void ServerDropWeapon();
+
+	/** Switch weapons on the server as well */
+	UFUNCTION(Server, Reliable)
+	void ServerSwitchWeapon(uint8 Slot);
+
+	/** Initialize CarriedAmmo with the starting values */
+	void InitializeAmmo();
+
+	/** Set CombatState and push it to the HUD */
+	void SetCombatState(ECombatState State);
+
+	/** Push the equipped weapon's ammo and the matching carried ammo to the HUD */
+	void PushHUDAmmo() const;
+
+	UFUNCTION()
+	void OnRep_EquippedWeapon();
+
+	UFUNCTION()
+	void OnRep_Inventory();
+
+	/** Point ActiveSlot at EquippedWeapon's slot, on clients the two replicate separately */
+	void UpdateActiveSlot();
+
+	/** Return true if EquippedWeapon has ammo */
+	bool WeaponHasAmmo();
+
+	/** Play the firing sound of a batch of shots, or keep the fire loop going if the character has one */
+	void PlayFireSound();
+
+	/** Stop the fire loop, with its tail if bPlayTail */
+	void StopFireLoop(bool bPlayTail);
+
+	/** Spawn muzzle flashes and queue the shots for tracing */
+	void SendBullets(const TArray<FShotRequest>& Shots);
+
+	/** Queue the shots in UHitscanSubsystem, or launch them in UProjectileSubsystem if the weapon fires projectiles */
+	void QueueShots(const TArray<FShotRequest>& Shots);
+
+	/** Spawn a muzzle flash for each shot */
+	void SpawnMuzzleFlashes(const TArray<FShotRequest>& Shots);
+
+	/** Send the shots fired locally to the server, or to the other clients when we are the server */
+	void ReplicateShots(const TArray<FShotRequest>& Shots);
+
+	/** Check the shots against ammo and fire rate, trace the valid ones and confirm them to the client */
+	UFUNCTION(Server, Unreliable)
+	void ServerFireShots(const FShotBatchPacket& Packet);
+
+	/** Let the owning client know the last shot processed by the server and how much ammo is left
+	 *  @param LastSequence Sequence number of the last shot the server received
+	 *  @param ServerAmmo Ammo in the weapon on the server after processing the shots */
+	UFUNCTION(Client, Unreliable)
+	void ClientConfirmShots(uint16 LastSequence, int32 ServerAmmo);
+
+	/** Play shots fired by another player (sound, animation, muzzle flash, beam and impact) */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastFireShots(const FShotBatchPacket& Packet);
+
+	/** Count the shots for the procedural recoil of the animation, or play the HipFire montage when it is disabled */
+	void PlayFireAnimation(int32 NumShots);
+	
+	void ReloadButtonPressed();
+
+	/** Handle reloading the weapon */
+	void ReloadWeapon();
+
+	/** Reload on the server as well, so it keeps track of the ammo */
+	UFUNCTION(Server, Reliable)
+	void ServerReloadWeapon();
+
+	UFUNCTION(BlueprintCallable)
+	void FinishReloading();
+
+	/** Return true if the character is carrying the type of ammo matching to EquippedWeapon's */
+	bool CarryingAmmo();
+	
+	UFUNCTION(BlueprintCallable)
+	void GrabClip();
+
+	UFUNCTION(BlueprintCallable)
+	void ReleaseClip();
+
+public:	
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Called to bind functionality to input
+	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+private:
+	/** Camera Boom Positioning the camera behind the character */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+    class USpringArmComponent* CameraBoom;
+	
+	/** Camera that follows the character */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	class UCameraComponent* FollowCamera;
+
+	/** Base turn rate in deg/sec. Other scaling may affect fina turn rate */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	float BaseTurnRate;
+
+	/** Base turn rate in deg/sec. Other scaling may affect fina turn rate */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	float BaseLookUpRate;
+
+	/** Turn rate while not aiming */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	float HipTurnRate;
+
+	/** Look up rate while not aiming */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	float HipLookUpRate;
+
+	/** Turn rate while aiming */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	float AimingTurnRate;
+
+	/** Look up rate while aiming */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	float AimingLookUpRate;
+
+	/** Scale factor for mouse look sensitivity, Turn rate when not aiming. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
+		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+	float MouseHipTurnRate;
+
+	/** Scale factor for mouse look sensitivity, Look up rate when not aiming. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
+		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+	float MouseHipLookUpRate;
+
+	/** Scale factor for mouse look sensitivity, Turn rate when aiming. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
+		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+	float MouseAimingTurnRate;
+	
+	/** Scale factor for mouse look sensitivity, Look up rate when aiming. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"),
+		meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+	float MouseAimingLookUpRate;
+
+	/** Randomized gunshot sound cue */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<class USoundCue> FireSound;
+
+	/** Looping automatic fire sound, started by the first shot and stopped by FireTailSound.
+	 *	If unset FireSound plays for every batch of shots */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<class USoundBase> FireLoopSound;
+
+	/** Played where FireLoopSound stops, when the fire button is released or the weapon is empty */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<class USoundBase> FireTailSound;
+
+	/** Flash spawned at BarrelSocket */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
+	
+	/** Montage for firing weapon, played for every shot when Shooter.Anim.ProceduralFireRecoil is 0 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UAnimMontage> HipFireMontage;
+
+	/** Particles spawned upon bullet impact */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UParticleSystem> ImpactParticles;
+	
+	/** Smoke trail for bullets */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UParticleSystem> BeamParticles;
+
+	/** True when aiming */
+	UPROPERTY(BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	bool bAiming;
+
+	/** Default camera field of view value */
+	float CameraDefaultFOV;
+	
+	/** Field of view value when the camera is zoomed in */
+	float CameraZoomedFOV;
+
+	/** Current camera field of view value */
+	float CameraCurrentFOV;
+
+	/** Interp speed for zooming when aiming */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float ZoomInterpSpeed;
+
+	/** Determines the spread of the crosshairs */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
+	float CrosshairSpreadingMultiplier;
+
+	/** Velocity component for crosshairs spread */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
+	float CrosshairVelocityFactor;
+
+	/** In air component for crosshairs spread */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
+	float CrosshairInAirFactor;
+
+	/** Aim component for crosshairs spread */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
+	float CrosshairAimingFactor;
+
+	/** Shooting component for crosshairs spread */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = (AllowPrivateAccess = "true"))
+	float CrosshairShootingFactor;
+
+	/** Right mouse button or right console trigger pressed */
+	bool bFireButtonPressed;
+
+	/** True when we can fire. False when waiting for the timer */
+	bool bShouldFire;
+	
+	/** True while gun is firing */
+	bool bFiringBullet;
+
+	/** Rate of automatic gun fire */
+	float AutomaticFireRate;
+	
+	/** Duration of crosshair spread for shooting */
+	float CrosshairShootingDuration;
+	
+	/** Time left until the next shot, negative when the shot is due since that long */
+	float FireCooldown;
+
+	/** Frame the fire cadence started on, its first shot already left during that frame */
+	uint64 FireCadenceStartFrame;
+
+	/** Muzzle transform and crosshair trace of last frame, shots fired during this frame are interpolated from it */
+	FShotRequest LastFireSample;
+
+	/** Shots fired this frame, kept around to avoid allocating every frame */
+	TArray<FShotRequest> ShotBatch;
+
+	/** Sequence number of the next shot fired locally */
+	uint16 NextShotSequence;
+
+	/** Last shot confirmed by the server, shots fired after it are still predicted */
+	uint16 LastConfirmedShotSequence;
+
+	/** Last shot received by the server from the owning client */
+	uint16 LastServerShotSequence;
+
+	/** Number of shots the server accepts right now, refilled at the fire rate */
+	float ServerFireBudget;
+
+	/** Most shots the server accepts in a burst, the slack absorbs network jitter */
+	float ServerFireBurst;
+
+	/** Time of the last shot packet received by the server */
+	float ServerLastFireTime;
+
+	/** How far from the character a shot's crosshair trace may start before the server rejects it */
+	float ServerMaxShotOriginDistance;
+
+	/** Shots sent to the server so far, and the bits their packets took */
+	uint32 ShotPacketShotsSent;
+	uint32 ShotPacketBitsSent;
+
+	/** Shots the server accepted from the owning client so far */
+	uint32 ServerShotsAccepted;
+
+	/** Boxes the server records for lag compensation, the capsule is used when empty */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	TArray<FLagCompensationHitbox> LagCompensationHitboxes;
+
+	/** Sets a timer between crosshair spreads */
+	FTimerHandle CrosshairShootTimer;
+
+	/** True while FireLoopSound plays */
+	bool bFireLoopPlaying;
+
+	/** Shots fired since the character spawned, the animation recoils once per new shot */
+	uint32 FireShotCount;
+
+	/** World time of the last shot */
+	float LastFireTime;
+
+	/** Stops the fire loop once shots stop coming, for characters whose fire cadence runs elsewhere */
+	FTimerHandle FireLoopTimer;
+
+	/** Half angle of the view cone in which items are considered for pickup, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	float PickupViewConeHalfAngle;
+
+	/** Best item found in the view cone by PickupTrace, visible or not */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	class AItem* PickupCandidate;
+
+	/** The AItem we can currently pick up, found in PickupTrace (could be null) */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	AItem* PickupTraceHitItem;
+	
+	/** The AItem we hit last frame in PickupTrace */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items , meta = (AllowPrivateAccess = "true"))
+	AItem* PreviousPickupTraceHitItem;
+
+	/** Currently equipped weapon, set by the server (and predicted by the owning client) */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_EquippedWeapon, Category = Combat ,
+		meta = (AllowPrivateAccess = "true"))
+	AWeapon* EquippedWeapon;
+
+	/** Set default weapon class blueprint */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftClassPtr<AWeapon> DefaultWeaponClass;
+
+	/** Distance of desired location for Item pickup interpolation from the camera */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CameraPickupInterpDistance;
+
+	/** Elevation of desired location for Item pickup interpolation from the camera */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CameraPickupInterpElevation;
+
+	/** Weapons carried by the character, one per slot, empty slots are null. Sized to WeaponSlots on the server */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_Inventory, Category = Combat,
+		meta = (AllowPrivateAccess = "true"))
+	TArray<AWeapon*> Inventory;
+
+	/** Number of weapons the character can carry */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 WeaponSlots;
+
+	/** Slot of EquippedWeapon in Inventory */
+	int32 ActiveSlot;
+
+	/** True while the character waits in UActorPoolSubsystem */
+	bool bInActorPool;
+
+	/** Significance to the local views, set by UShooterSignificanceSubsystem */
+	EShooterSignificance Significance;
+
+	/** Carried ammo of each ammo type, indexed by EAmmoType */
+	UPROPERTY(VisibleAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true", ArraySizeEnum = "EAmmoType"))
+	int32 CarriedAmmo[static_cast<int32>(EAmmoType::EAT_Max)];
+
+	/** Starting amount of 9mm ammo */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	int32 Starting9mmAmmo;
+
+	/** Starting amount of 9mm ammo */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	int32 StartingARAmmo;
+
+	/** State of Character's combat */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	ECombatState CombatState;
+
+	/** Montage for reloading the weapon */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UAnimMontage> ReloadMontage;
+
+	/** Transform of the clip when hand touches the clip for the first time */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	FTransform ClipTransform;
+
+	/** Scene component to keep track of hand location with initial offset from the clip */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat , meta = (AllowPrivateAccess = "true"))
+	USceneComponent* ClipSceneComponent;
+	
+public:
+	/** Returns CameraBoom subObject */
+	FORCEINLINE USpringArmComponent *GetCameraBoom() const { return CameraBoom; }
+	/** Returns FollowCamera subObject */
+	FORCEINLINE UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+
+	FORCEINLINE bool GetAiming() const { return bAiming; }
+	FORCEINLINE uint32 GetFireShotCount() const { return FireShotCount; }
+	FORCEINLINE float GetLastFireTime() const { return LastFireTime; }
+	FORCEINLINE AWeapon* GetEquippedWeapon() const { return EquippedWeapon; }
+	FORCEINLINE const TArray<AWeapon*>& GetInventory() const { return Inventory; }
+
+	/** Returns the amount of ammo of AmmoType the character carries */
+	UFUNCTION(BlueprintPure)
+	int32 GetCarriedAmmo(EAmmoType AmmoType) const;
+	FORCEINLINE const TSoftClassPtr<AWeapon>& GetDefaultWeaponClass() const { return DefaultWeaponClass; }
+
+	/** Press or release the fire button, for characters driven without player input */
+	void SetFireButtonPressed(bool bPressed);
+	FORCEINLINE bool IsFireButtonPressed() const { return bFireButtonPressed; }
+	FORCEINLINE ECombatState GetCombatState() const { return CombatState; }
+
+	FORCEINLINE EShooterSignificance GetSignificance() const { return Significance; }
+	/** Tick less often the less significant the character is */
+	void SetSignificance(EShooterSignificance NewSignificance);
+
+	FORCEINLINE const TArray<FLagCompensationHitbox>& GetLagCompensationHitboxes() const { return LagCompensationHitboxes; }
+
+	/** Returns the average bytes per shot of the packets sent to the server, RPC header excluded.
+	 *	Packets are only measured in builds with stats, or with Shooter.Net.LogShotPackets on */
+	FORCEINLINE float GetShotPacketBytesPerShot() const
+	{
+		return ShotPacketShotsSent > 0 ? ShotPacketBitsSent / 8.f / ShotPacketShotsSent : 0.f;
+	}
+	FORCEINLINE uint32 GetServerShotsAccepted() const { return ServerShotsAccepted; }
+
+	/** Returns CrosshairSpreadingMultiplier function */
+	UFUNCTION(BlueprintCallable)
+	float GetCrosshairSpreadMultiplier() const;
+	
+	/** Get the desired location for Item pick up interpolation */
+	FVector GetPickupInterpTargetLocation();
+
+	/** Set an item to pickup
+	 * @param Item Item to pick up
+	 */
+	void PickupItem(AItem* Item);
+
+	/** Spawn impact and beam particles once UHitscanSubsystem has traced the shot
+	 * @param Shot The traced shot, BeamEndLocation is where the beam ends
+	 * @param bBeamEnd True if the beam hit something
+	 */
+	void ResolveShot(const FShotRequest& Shot, bool bBeamEnd);
+
+	/** Spawn the impact particles where one of the character's shots or projectiles hit something */
+	void SpawnImpactParticles(const FVector& ImpactLocation);
+
+	/** Add the soft referenced combat assets, streamed in when the character begins play, to OutPaths */
+	void GetCombatAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/** Called by UItemAssetStreamer once the combat assets are loaded, pools the effects and equips the default weapon */
+	void OnCombatAssetsLoaded();
+};
@@ -1,17 +1,17 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/GameModeBase.h"
-#include "ShooterGameModeBase.generated.h"
-
-/**
- * 
- */
-UCLASS()
-class SHOOTER_API AShooterGameModeBase : public AGameModeBase
-{
-	GENERATED_BODY()
-	
-};
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "ShooterGameModeBase.generated.h"
+
+/**
+ * 
+ */
+UCLASS()
+class SHOOTER_API AShooterGameModeBase : public AGameModeBase
+{
+	GENERATED_BODY()
+	
+};
@@ -0,0 +1,68 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterHUDViewModel.h"
+
+#include "Shooter.h"
+#include "ShooterPlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("HUD Value Changes"), STAT_HUDValueChanges, STATGROUP_Shooter);
+
+UShooterHUDViewModel::UShooterHUDViewModel():
+	AmmoInMagazine(0),
+	CarriedAmmo(0),
+	CombatState(ECombatState::ECS_Unoccupied),
+	CrosshairSpread(0.f),
+	CrosshairSpreadTolerance(0.01f)
+{
+
+}
+
+UShooterHUDViewModel* UShooterHUDViewModel::Get(const APawn* Pawn)
+{
+	if(Pawn == nullptr) return nullptr;
+
+	const AShooterPlayerController* PlayerController = Pawn -> GetController<AShooterPlayerController>();
+	if(PlayerController == nullptr || !PlayerController -> IsLocalController()) return nullptr;
+	return PlayerController -> GetHUDViewModel();
+}
+
+void UShooterHUDViewModel::SetAmmoInMagazine(int32 Value)
+{
+	if(AmmoInMagazine == Value) return;
+	AmmoInMagazine = Value;
+	INC_DWORD_STAT(STAT_HUDValueChanges);
+	OnAmmoInMagazineChanged.Broadcast(AmmoInMagazine);
+}
+
+void UShooterHUDViewModel::SetCarriedAmmo(int32 Value)
+{
+	if(CarriedAmmo == Value) return;
+	CarriedAmmo = Value;
+	INC_DWORD_STAT(STAT_HUDValueChanges);
+	OnCarriedAmmoChanged.Broadcast(CarriedAmmo);
+}
+
+void UShooterHUDViewModel::SetCombatState(ECombatState Value)
+{
+	if(CombatState == Value) return;
+	CombatState = Value;
+	INC_DWORD_STAT(STAT_HUDValueChanges);
+	OnCombatStateChanged.Broadcast(CombatState);
+}
+
+void UShooterHUDViewModel::SetCrosshairSpread(float Value)
+{
+	if(FMath::IsNearlyEqual(CrosshairSpread, Value, CrosshairSpreadTolerance)) return;
+	CrosshairSpread = Value;
+	INC_DWORD_STAT(STAT_HUDValueChanges);
+	OnCrosshairSpreadChanged.Broadcast(CrosshairSpread);
+}
+
+void UShooterHUDViewModel::BroadcastAll()
+{
+	OnAmmoInMagazineChanged.Broadcast(AmmoInMagazine);
+	OnCarriedAmmoChanged.Broadcast(CarriedAmmo);
+	OnCombatStateChanged.Broadcast(CombatState);
+	OnCrosshairSpreadChanged.Broadcast(CrosshairSpread);
+}
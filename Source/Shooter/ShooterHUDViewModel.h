@@ -0,0 +1,75 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "ShooterCharacter.h"
+#include "ShooterHUDViewModel.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHUDIntChanged, int32, NewValue);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHUDFloatChanged, float, NewValue);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHUDCombatStateChanged, ECombatState, NewValue);
+
+/**
+ * Values shown by the HUD, owned by AShooterPlayerController.
+ * The character and its weapon push their changes in, and each setter only broadcasts when the value
+ * actually changed, so widgets bound to the events redraw on change instead of polling every frame.
+ */
+UCLASS(BlueprintType)
+class SHOOTER_API UShooterHUDViewModel : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UShooterHUDViewModel();
+
+	/** Returns the view model of the local player controlling Pawn, or null for remote and AI pawns */
+	static UShooterHUDViewModel* Get(const APawn* Pawn);
+
+	void SetAmmoInMagazine(int32 Value);
+	void SetCarriedAmmo(int32 Value);
+	void SetCombatState(ECombatState Value);
+	void SetCrosshairSpread(float Value);
+
+	FORCEINLINE int32 GetAmmoInMagazine() const { return AmmoInMagazine; }
+	FORCEINLINE int32 GetCarriedAmmo() const { return CarriedAmmo; }
+	FORCEINLINE ECombatState GetCombatState() const { return CombatState; }
+	FORCEINLINE float GetCrosshairSpread() const { return CrosshairSpread; }
+
+	/** Broadcast every value, for widgets that just bound to the events */
+	UFUNCTION(BlueprintCallable, Category = HUD)
+	void BroadcastAll();
+
+	UPROPERTY(BlueprintAssignable, Category = HUD)
+	FOnHUDIntChanged OnAmmoInMagazineChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = HUD)
+	FOnHUDIntChanged OnCarriedAmmoChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = HUD)
+	FOnHUDCombatStateChanged OnCombatStateChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = HUD)
+	FOnHUDFloatChanged OnCrosshairSpreadChanged;
+
+private:
+	/** Ammo in the equipped weapon's magazine */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = HUD, meta = (AllowPrivateAccess = "true"))
+	int32 AmmoInMagazine;
+
+	/** Ammo carried for the equipped weapon's ammo type */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = HUD, meta = (AllowPrivateAccess = "true"))
+	int32 CarriedAmmo;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = HUD, meta = (AllowPrivateAccess = "true"))
+	ECombatState CombatState;
+
+	/** Crosshair spread multiplier */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = HUD, meta = (AllowPrivateAccess = "true"))
+	float CrosshairSpread;
+
+	/** Smallest spread change worth a redraw, the spread moves a little almost every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = HUD, meta = (AllowPrivateAccess = "true"))
+	float CrosshairSpreadTolerance;
+};
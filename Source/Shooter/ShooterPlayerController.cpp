@@ -1,27 +1,79 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-
-#include "ShooterPlayerController.h"
-#include "Blueprint/UserWidget.h"
-
-AShooterPlayerController::AShooterPlayerController()
-{
-	
-}
-
-void AShooterPlayerController::BeginPlay()
-{
-	Super::BeginPlay();
-
-	if(HUDOverlayClass)
-	{
-		HUDOverlay = CreateWidget<UUserWidget>(this, HUDOverlayClass);
-		
-		if(HUDOverlay)
-		{
-			HUDOverlay -> AddToViewport();
-			HUDOverlay -> SetVisibility(ESlateVisibility::Visible);
-		}
-	}
-}
-
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterPlayerController.h"
+#include "ShooterHUDViewModel.h"
+#include "ItemPickupWidget.h"
+#include "Item.h"
+#include "Shooter.h"
+#include "Blueprint/UserWidget.h"
+#include "Components/WidgetComponent.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Shared Pickup Widget Components"), STAT_SharedPickupWidgetComponents, STATGROUP_Shooter);
+
+AShooterPlayerController::AShooterPlayerController()
+{
+	// Created up front so the pawn can push its values before the HUD exists
+	HUDViewModel = CreateDefaultSubobject<UShooterHUDViewModel>(TEXT("HUDViewModel"));
+}
+
+void AShooterPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if(HUDOverlayClass)
+	{
+		HUDOverlay = CreateWidget<UUserWidget>(this, HUDOverlayClass);
+		
+		if(HUDOverlay)
+		{
+			HUDOverlay -> AddToViewport();
+			HUDOverlay -> SetVisibility(ESlateVisibility::Visible);
+		}
+	}
+}
+
+void AShooterPlayerController::SetPickupWidgetItem(AItem* Item)
+{
+	// Only the player on this machine sees its pickup widget, a listen server would draw the remote players' too
+	if(!IsLocalController() || Item == PickupWidgetItem) return;
+	PickupWidgetItem = Item;
+
+	if(Item == nullptr)
+	{
+		if(PickupWidget)
+		{
+			PickupWidget -> SetVisibility(false);
+		}
+		return;
+	}
+
+	TSubclassOf<UUserWidget> WidgetClass = PickupWidgetClass ? PickupWidgetClass : Item -> GetPickupWidgetClass();
+	if(WidgetClass == nullptr) return;
+
+	if(PickupWidget == nullptr)
+	{
+		// Screen space, so it needs no render target however many items there are
+		PickupWidget = NewObject<UWidgetComponent>(this, TEXT("SharedPickupWidget"));
+		PickupWidget -> SetWidgetSpace(EWidgetSpace::Screen);
+		PickupWidget -> SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		PickupWidget -> SetOwnerPlayer(GetLocalPlayer());
+		PickupWidget -> RegisterComponent();
+		INC_DWORD_STAT(STAT_SharedPickupWidgetComponents);
+	}
+	if(PickupWidget -> GetWidgetClass() != WidgetClass)
+	{
+		PickupWidget -> SetWidgetClass(WidgetClass);
+		PickupWidget -> InitWidget();
+	}
+
+	PickupWidget -> SetDrawSize(Item -> GetPickupWidgetDrawSize());
+	PickupWidget -> AttachToComponent(Item -> GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	PickupWidget -> SetRelativeLocation(Item -> GetPickupWidgetLocation());
+	PickupWidget -> SetVisibility(true);
+
+	if(UItemPickupWidget* ItemPickupWidget = Cast<UItemPickupWidget>(PickupWidget -> GetWidget()))
+	{
+		ItemPickupWidget -> SetItem(Item);
+	}
+}
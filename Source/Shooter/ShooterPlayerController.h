@@ -1,29 +1,51 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/PlayerController.h"
-#include "ShooterPlayerController.generated.h"
-
-UCLASS()
-class SHOOTER_API AShooterPlayerController : public APlayerController
-{
-	GENERATED_BODY()
-
-public:
-	AShooterPlayerController();
-
-protected:
-	virtual void BeginPlay() override;
-	
-private:
-	/** Reference to the Overall HUD Blueprint Class */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
-	TSubclassOf<class UUserWidget> HUDOverlayClass;
-
-	/** Variable to hold the HUD Overlay Widget after creating it */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
-	UUserWidget* HUDOverlay;
-	
-};
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "ShooterPlayerController.generated.h"
+
+UCLASS()
+class SHOOTER_API AShooterPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	AShooterPlayerController();
+
+protected:
+	virtual void BeginPlay() override;
+	
+private:
+	/** Reference to the Overall HUD Blueprint Class */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<class UUserWidget> HUDOverlayClass;
+
+	/** Variable to hold the HUD Overlay Widget after creating it */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	UUserWidget* HUDOverlay;
+
+	/** Values shown by the HUD, widgets bind to its events instead of polling the character */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	class UShooterHUDViewModel* HUDViewModel;
+
+	/** Pickup widget class of the shared pickup widget, uses the focused item's widget class when not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<UUserWidget> PickupWidgetClass;
+
+	/** The single pickup widget of this player, moved to the item it looks at (created on first use) */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	class UWidgetComponent* PickupWidget;
+
+	/** Item PickupWidget is showing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	class AItem* PickupWidgetItem;
+
+public:
+	UFUNCTION(BlueprintPure, Category = "Widgets")
+	FORCEINLINE UShooterHUDViewModel* GetHUDViewModel() const { return HUDViewModel; }
+
+	/** Move the shared pickup widget to Item and fill it, hide it when Item is null */
+	void SetPickupWidgetItem(AItem* Item);
+};
@@ -0,0 +1,74 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterReplicationGraph.h"
+
+#include "Shooter.h"
+#include "Engine/NetDriver.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Held Items (Always Relevant)"), STAT_RepGraphHeldItems, STATGROUP_Shooter);
+
+UShooterReplicationGraph::UShooterReplicationGraph()
+{
+
+}
+
+void UShooterReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// Loot is only considered within its cull distance, at its own update rate
+	const AItem* ItemCDO = GetDefault<AItem>();
+	FClassReplicationInfo ItemInfo;
+	ItemInfo.SetCullDistanceSquared(ItemCDO -> NetCullDistanceSquared);
+	ItemInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ItemCDO -> NetUpdateFrequency);
+	GlobalActorReplicationInfoMap.SetClassInfo(AItem::StaticClass(), ItemInfo);
+}
+
+void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+	FGlobalActorReplicationInfo& GlobalInfo)
+{
+	const AItem* Item = Cast<AItem>(ActorInfo.Actor);
+	if(Item && IsHeldItemState(Item -> GetItemState()))
+	{
+		HeldItems.Add(ActorInfo.Actor);
+		AlwaysRelevantNode -> NotifyAddNetworkActor(ActorInfo);
+		INC_DWORD_STAT(STAT_RepGraphHeldItems);
+		return;
+	}
+	// Everything else, loot included, goes through the basic routing: dormant actors in the spatial grid
+	Super::RouteAddNetworkActorToNodes(ActorInfo, GlobalInfo);
+}
+
+void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	if(HeldItems.RemoveSwap(ActorInfo.Actor) > 0)
+	{
+		AlwaysRelevantNode -> NotifyRemoveNetworkActor(ActorInfo);
+		DEC_DWORD_STAT(STAT_RepGraphHeldItems);
+		return;
+	}
+	Super::RouteRemoveNetworkActorToNodes(ActorInfo);
+}
+
+void UShooterReplicationGraph::NotifyItemStateChanged(AItem* Item, EItemState OldState)
+{
+	if(IsHeldItemState(OldState) == IsHeldItemState(Item -> GetItemState())) return;
+
+	const UNetDriver* NetDriver = Item -> GetNetDriver();
+	UShooterReplicationGraph* Graph = NetDriver ? Cast<UShooterReplicationGraph>(NetDriver -> GetReplicationDriver()) : nullptr;
+	// Items that aren't in the graph yet are routed by RouteAddNetworkActorToNodes
+	if(Graph == nullptr || Graph -> GlobalActorReplicationInfoMap.Find(Item) == nullptr) return;
+
+	const FNewReplicatedActorInfo ActorInfo{ Item };
+	FGlobalActorReplicationInfo& GlobalInfo = Graph -> GlobalActorReplicationInfoMap.Get(Item);
+	// Take it out of the node it was routed to for its old state, and route it again for the new one
+	Graph -> RouteRemoveNetworkActorToNodes(ActorInfo);
+	Graph -> RouteAddNetworkActorToNodes(ActorInfo, GlobalInfo);
+}
+
+bool UShooterReplicationGraph::IsHeldItemState(EItemState State)
+{
+	return State == EItemState::EIS_EquipInterp || State == EItemState::EIS_PickedUp ||
+		State == EItemState::EIS_Equipped;
+}
@@ -0,0 +1,39 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BasicReplicationGraph.h"
+#include "Item.h"
+#include "ShooterReplicationGraph.generated.h"
+
+/**
+ * Replication graph of the game, enabled with Shooter.Net.ReplicationGraph.
+ * Loot lying in the world goes into the spatial grid as dormant actors: static while dormant, dynamic while awake,
+ * so thousands of items in EIS_Pickup cost nothing per net tick. Items held by a character are routed to the
+ * always relevant list instead, and moved back to the grid when they are dropped.
+ */
+UCLASS(Transient, Config = Engine)
+class SHOOTER_API UShooterReplicationGraph : public UBasicReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UShooterReplicationGraph();
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+		FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** Move an item between the grid and the always relevant list when it changes hands, only on servers */
+	static void NotifyItemStateChanged(AItem* Item, EItemState OldState);
+
+	/** Returns true if items in State are held by a character */
+	static bool IsHeldItemState(EItemState State);
+
+private:
+	/** Items held by a character, routed to the always relevant list */
+	UPROPERTY()
+	TArray<AActor*> HeldItems;
+};
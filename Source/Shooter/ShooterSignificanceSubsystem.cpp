@@ -0,0 +1,243 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterSignificanceSubsystem.h"
+
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "Item.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_SignificanceUpdate, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Changes"), STAT_SignificanceChanges, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarSignificanceHighDistance(
+	TEXT("Shooter.Significance.HighDistance"),
+	1500.f,
+	TEXT("Actors and effects closer than this to a local view are High, in view or not."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSignificanceMediumDistance(
+	TEXT("Shooter.Significance.MediumDistance"),
+	4000.f,
+	TEXT("Actors and effects in view and closer than this are Medium, out of view they are Low."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSignificanceCullDistance(
+	TEXT("Shooter.Significance.CullDistance"),
+	10000.f,
+	TEXT("Actors and effects in view and closer than this are Low, the others are Culled."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSignificanceMediumTickInterval(
+	TEXT("Shooter.Significance.MediumTickInterval"),
+	0.f,
+	TEXT("Seconds between two ticks of Medium actors."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSignificanceLowTickInterval(
+	TEXT("Shooter.Significance.LowTickInterval"),
+	0.1f,
+	TEXT("Seconds between two ticks of Low actors."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSignificanceCulledTickInterval(
+	TEXT("Shooter.Significance.CulledTickInterval"),
+	0.5f,
+	TEXT("Seconds between two ticks of Culled actors."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSignificanceUpdatesPerFrame(
+	TEXT("Shooter.Significance.UpdatesPerFrame"),
+	256,
+	TEXT("Characters and items re-scored per frame, the others keep their significance until their turn."),
+	ECVF_Default);
+
+UShooterSignificanceSubsystem::UShooterSignificanceSubsystem():
+	UpdateCursor(0)
+{
+
+}
+
+bool UShooterSignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World -> IsGameWorld();
+}
+
+void UShooterSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_SignificanceUpdate);
+
+	UpdateViews();
+
+	const int32 NumEntries = Characters.Num() + Items.Num();
+	const int32 NumUpdates = FMath::Min(FMath::Max(CVarSignificanceUpdatesPerFrame.GetValueOnGameThread(), 1),
+		NumEntries);
+	for(int32 Update = 0; Update < NumUpdates; Update++)
+	{
+		const int32 Index = (UpdateCursor + Update) % NumEntries;
+		if(Index < Characters.Num())
+		{
+			AShooterCharacter* Character = Characters[Index].Get();
+			if(Character == nullptr) continue;
+
+			// The local player's own character always runs at full quality
+			const EShooterSignificance Significance = Character -> IsPlayerControlled() &&
+				Character -> IsLocallyControlled() ? EShooterSignificance::ESS_High :
+				Evaluate(Character -> GetActorLocation(), Character -> GetMesh() -> WasRecentlyRendered(0.2f));
+			if(Significance != Character -> GetSignificance())
+			{
+				Character -> SetSignificance(Significance);
+				INC_DWORD_STAT(STAT_SignificanceChanges);
+			}
+		}
+		else
+		{
+			AItem* Item = Items[Index - Characters.Num()].Get();
+			if(Item == nullptr) continue;
+
+			const EShooterSignificance Significance = Evaluate(Item -> GetActorLocation(),
+				Item -> GetItemMesh() -> WasRecentlyRendered(0.2f));
+			if(Significance != Item -> GetSignificance())
+			{
+				Item -> SetSignificance(Significance);
+				INC_DWORD_STAT(STAT_SignificanceChanges);
+			}
+		}
+	}
+	UpdateCursor = NumEntries > 0 ? (UpdateCursor + NumUpdates) % NumEntries : 0;
+}
+
+bool UShooterSignificanceSubsystem::IsTickable() const
+{
+	return Characters.Num() > 0 || Items.Num() > 0;
+}
+
+TStatId UShooterSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterSignificanceSubsystem::RegisterCharacter(AShooterCharacter* Character)
+{
+	if(Character && !Characters.Contains(Character))
+	{
+		Characters.Add(Character);
+	}
+}
+
+void UShooterSignificanceSubsystem::UnregisterCharacter(AShooterCharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+}
+
+void UShooterSignificanceSubsystem::RegisterItem(AItem* Item)
+{
+	if(Item && !Items.Contains(Item))
+	{
+		Items.Add(Item);
+	}
+}
+
+void UShooterSignificanceSubsystem::UnregisterItem(AItem* Item)
+{
+	Items.RemoveSwap(Item);
+}
+
+EShooterSignificance UShooterSignificanceSubsystem::GetLocationSignificance(const FVector& Location) const
+{
+	return Evaluate(Location, false);
+}
+
+float UShooterSignificanceSubsystem::GetViewDistanceSquared(const FVector& Location) const
+{
+	if(Views.Num() == 0) return 0.f;
+
+	float DistanceSquared = MAX_flt;
+	for(const FSignificanceView& View : Views)
+	{
+		DistanceSquared = FMath::Min(DistanceSquared, FVector::DistSquared(Location, View.Location));
+	}
+	return DistanceSquared;
+}
+
+void UShooterSignificanceSubsystem::ApplyEmitterLOD(UParticleSystemComponent* Component,
+	EShooterSignificance Significance)
+{
+	if(Component == nullptr || Component -> Template == nullptr) return;
+
+	// High, Medium and Low map to the first three LODs of the template
+	const int32 NumLODs = Component -> Template -> LODDistances.Num();
+	const int32 LODLevel = FMath::Min(static_cast<int32>(Significance), NumLODs - 1);
+	if(LODLevel < 0) return;
+	Component -> bOverrideLODMethod = true;
+	Component -> LODMethod = PARTICLESYSTEMLODMETHOD_DirectSet;
+	Component -> SetLODLevel(LODLevel);
+}
+
+float UShooterSignificanceSubsystem::GetTickInterval(EShooterSignificance Significance)
+{
+	switch(Significance)
+	{
+	case EShooterSignificance::ESS_Medium:
+		return FMath::Max(CVarSignificanceMediumTickInterval.GetValueOnGameThread(), 0.f);
+	case EShooterSignificance::ESS_Low:
+		return FMath::Max(CVarSignificanceLowTickInterval.GetValueOnGameThread(), 0.f);
+	case EShooterSignificance::ESS_Culled:
+		return FMath::Max(CVarSignificanceCulledTickInterval.GetValueOnGameThread(), 0.f);
+	default:
+		return 0.f;
+	}
+}
+
+void UShooterSignificanceSubsystem::UpdateViews()
+{
+	Views.Reset();
+	for(FConstPlayerControllerIterator Iterator = GetWorld() -> GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator -> Get();
+		if(PlayerController == nullptr || !PlayerController -> IsLocalController()) continue;
+
+		// The camera manager follows the FollowCamera of the possessed character
+		FSignificanceView& View = Views.AddDefaulted_GetRef();
+		FRotator ViewRotation;
+		PlayerController -> GetPlayerViewPoint(View.Location, ViewRotation);
+		View.Direction = ViewRotation.Vector();
+		const APlayerCameraManager* CameraManager = PlayerController -> PlayerCameraManager;
+		const float FOV = CameraManager ? CameraManager -> GetFOVAngle() : 90.f;
+		View.CosHalfFOV = FMath::Cos(FMath::DegreesToRadians(FMath::Min(FOV * 0.5f + 10.f, 180.f)));
+	}
+}
+
+EShooterSignificance UShooterSignificanceSubsystem::Evaluate(const FVector& Location, bool bRendered) const
+{
+	// Nobody watching, a dedicated server must not degrade the game
+	if(Views.Num() == 0) return EShooterSignificance::ESS_High;
+
+	float DistanceSquared = MAX_flt;
+	bool bInView = bRendered;
+	for(const FSignificanceView& View : Views)
+	{
+		const FVector ToLocation = Location - View.Location;
+		DistanceSquared = FMath::Min(DistanceSquared, ToLocation.SizeSquared());
+		bInView = bInView || (ToLocation.GetSafeNormal() | View.Direction) >= View.CosHalfFOV;
+	}
+
+	if(DistanceSquared < FMath::Square(CVarSignificanceHighDistance.GetValueOnGameThread()))
+	{
+		return EShooterSignificance::ESS_High;
+	}
+	if(DistanceSquared < FMath::Square(CVarSignificanceMediumDistance.GetValueOnGameThread()))
+	{
+		return bInView ? EShooterSignificance::ESS_Medium : EShooterSignificance::ESS_Low;
+	}
+	if(DistanceSquared < FMath::Square(CVarSignificanceCullDistance.GetValueOnGameThread()))
+	{
+		return bInView ? EShooterSignificance::ESS_Low : EShooterSignificance::ESS_Culled;
+	}
+	return EShooterSignificance::ESS_Culled;
+}
@@ -0,0 +1,92 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSignificanceSubsystem.generated.h"
+
+class AShooterCharacter;
+class AItem;
+class UParticleSystemComponent;
+
+/** How much an actor or effect matters to the local views, from full quality down to not worth updating */
+UENUM(BlueprintType)
+enum class EShooterSignificance : uint8
+{
+	ESS_High UMETA(DisplayName = "High"),
+	ESS_Medium UMETA(DisplayName = "Medium"),
+	ESS_Low UMETA(DisplayName = "Low"),
+	ESS_Culled UMETA(DisplayName = "Culled"),
+
+	ESS_Max UMETA(DisplayName = "DefaultMax")
+};
+
+/** A local view the significance is measured from */
+struct FSignificanceView
+{
+	FVector Location;
+	FVector Direction;
+
+	/** Cosine of the half field of view, with some margin */
+	float CosHalfFOV;
+};
+
+/**
+ * Scores characters, items and combat effects by their distance to the local cameras (the FollowCamera of the
+ * local players), whether they are in view or were rendered recently, and whether they are the local player.
+ * Characters and items are re-scored a slice at a time and told when their significance changes, they lower their
+ * tick rate (AShooterCharacter::SetSignificance, AItem::SetSignificance). Effects are scored when they spawn,
+ * UFXPoolSubsystem skips culled ones and lowers the LOD of the others, and remote fire sounds are skipped past Medium.
+ * The distances and tick intervals are scalability settings (Shooter.Significance.*), set per effects quality
+ * level in Config/DefaultScalability.ini.
+ * Without local views (dedicated servers) everything stays High.
+ */
+UCLASS()
+class SHOOTER_API UShooterSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UShooterSignificanceSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterCharacter(AShooterCharacter* Character);
+	void UnregisterCharacter(AShooterCharacter* Character);
+	void RegisterItem(AItem* Item);
+	void UnregisterItem(AItem* Item);
+
+	/** Returns the significance of an effect or sound at Location */
+	EShooterSignificance GetLocationSignificance(const FVector& Location) const;
+
+	/** Returns the squared distance from Location to the closest local view, 0 without local views */
+	float GetViewDistanceSquared(const FVector& Location) const;
+
+	/** Lower the LOD of an effect spawned with Significance, the template's lowest LOD at most */
+	static void ApplyEmitterLOD(UParticleSystemComponent* Component, EShooterSignificance Significance);
+
+	/** Returns the actor tick interval of Significance, 0 is every frame */
+	static float GetTickInterval(EShooterSignificance Significance);
+
+private:
+	/** Gather the local views, from the local players' cameras */
+	void UpdateViews();
+
+	/** Score an actor against the views
+	 *	@param bRendered True if the actor was rendered recently, it counts as in view */
+	EShooterSignificance Evaluate(const FVector& Location, bool bRendered) const;
+
+	/** Characters and items re-scored a slice at a time */
+	TArray<TWeakObjectPtr<AShooterCharacter>> Characters;
+	TArray<TWeakObjectPtr<AItem>> Items;
+
+	/** Local views of this frame */
+	TArray<FSignificanceView> Views;
+
+	/** Index of the next actor to score, characters first then items */
+	int32 UpdateCursor;
+};
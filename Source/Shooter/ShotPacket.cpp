@@ -0,0 +1,78 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShotPacket.h"
+
+#include "HitscanSubsystem.h"
+#include "Engine/NetSerialization.h"
+#include "Serialization/BitWriter.h"
+
+FShotBatchPacket::FShotBatchPacket():
+	FirstSequence(0),
+	FireTime(0.f)
+{
+
+}
+
+bool FShotBatchPacket::AddShot(const FShotRequest& Shot, float ServerTime)
+{
+	if(Shots.Num() >= MaxShots) return false;
+	if(Shots.Num() == 0)
+	{
+		FireTime = ServerTime;
+	}
+	const int32 TimeOffset = FMath::RoundToInt((ServerTime - FireTime) * 1000.f);
+	if(TimeOffset < 0 || TimeOffset > MAX_uint8) return false;
+
+	FPackedShot& PackedShot = Shots.AddDefaulted_GetRef();
+	PackedShot.Origin = Shot.CrosshairTraceStart;
+	PackedShot.MuzzleOffset = Shot.MuzzleTransform.GetLocation() - Shot.CrosshairTraceStart;
+	PackedShot.Aim = (Shot.CrosshairTraceEnd - Shot.CrosshairTraceStart).Rotation();
+	PackedShot.TimeOffset = static_cast<uint8>(TimeOffset);
+	return true;
+}
+
+void FShotBatchPacket::GetShot(int32 Index, float TraceDistance, FShotRequest& OutShot) const
+{
+	const FPackedShot& PackedShot = Shots[Index];
+	const FVector Direction{ PackedShot.Aim.Vector() };
+
+	OutShot.CrosshairTraceStart = PackedShot.Origin;
+	OutShot.CrosshairTraceEnd = PackedShot.Origin + Direction * TraceDistance;
+	OutShot.MuzzleTransform = FTransform(PackedShot.Aim, PackedShot.Origin + PackedShot.MuzzleOffset);
+	OutShot.Timestamp = FireTime + PackedShot.TimeOffset / 1000.f;
+}
+
+int32 FShotBatchPacket::GetSerializedBits() const
+{
+	FBitWriter Writer(0, true);
+	bool bSuccess = true;
+	FShotBatchPacket Copy{ *this }; // NetSerialize isn't const, it reads and writes
+	Copy.NetSerialize(Writer, nullptr, bSuccess);
+	return static_cast<int32>(Writer.GetNumBits());
+}
+
+bool FShotBatchPacket::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+	Ar << FirstSequence;
+	Ar << FireTime;
+
+	uint32 NumShots = Shots.Num();
+	Ar.SerializeInt(NumShots, MaxShots + 1);
+	if(Ar.IsLoading())
+	{
+		Shots.SetNum(FMath::Min<int32>(NumShots, MaxShots));
+	}
+
+	for(FPackedShot& Shot : Shots)
+	{
+		// Origin and muzzle offset are rounded to the centimeter, the offset is small so it packs in fewer bits
+		bOutSuccess &= SerializePackedVector<1, 20>(Shot.Origin, Ar);
+		bOutSuccess &= SerializePackedVector<1, 20>(Shot.MuzzleOffset, Ar);
+		// Pitch and yaw as shorts, roll is always zero and takes a single bit
+		Shot.Aim.SerializeCompressedShort(Ar);
+		Ar << Shot.TimeOffset;
+	}
+	return true;
+}
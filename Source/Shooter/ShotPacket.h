@@ -0,0 +1,80 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShotPacket.generated.h"
+
+struct FShotRequest;
+
+/** A single shot inside FShotBatchPacket, quantized when serialized */
+struct FPackedShot
+{
+	/** Start of the crosshair trace, 1cm precision */
+	FVector Origin{ 0.f };
+
+	/** Gun barrel tip relative to Origin, 1cm precision */
+	FVector MuzzleOffset{ 0.f };
+
+	/** Direction of the crosshair trace, pitch and yaw as 16 bits each */
+	FRotator Aim{ 0.f };
+
+	/** Milliseconds between FireTime and this shot, 8 bits */
+	uint8 TimeOffset{ 0 };
+};
+
+/**
+ * The shots a client fired in one frame, sent to the server in a single RPC.
+ * Shots are numbered from FirstSequence so the server can drop duplicates and acknowledge them.
+ * Serialized by hand to keep the bits per shot low, see NetSerialize.
+ */
+USTRUCT()
+struct SHOOTER_API FShotBatchPacket
+{
+	GENERATED_BODY()
+
+	/** Most shots a single packet can carry */
+	static constexpr int32 MaxShots = 15;
+
+	/** Sequence number of the first shot, the following shots are numbered after it */
+	uint16 FirstSequence;
+
+	/** Server world time at which the first shot was fired, for lag compensation */
+	float FireTime;
+
+	TArray<FPackedShot, TInlineAllocator<4>> Shots;
+
+	FShotBatchPacket();
+
+	/** Add a shot to the packet, returns false when the packet is full or the shot is too late for FireTime
+	 *	@param ServerTime Time the shot was fired at, in server world time */
+	bool AddShot(const FShotRequest& Shot, float ServerTime);
+
+	/** Fill OutShot with the shot at Index, the crosshair trace ends TraceDistance away from its origin.
+	 *	The timestamp is left in the sender's server time */
+	void GetShot(int32 Index, float TraceDistance, FShotRequest& OutShot) const;
+
+	/** Sequence number of the last shot in the packet */
+	FORCEINLINE uint16 GetLastSequence() const { return FirstSequence + Shots.Num() - 1; }
+
+	/** Number of bits the packet takes once serialized, without the RPC overhead.
+	 *	Serializes a copy of the packet, keep it out of shipping code paths */
+	int32 GetSerializedBits() const;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FShotBatchPacket> : public TStructOpsTypeTraitsBase2<FShotBatchPacket>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/** Returns true if sequence number A was issued after B, wrapping around */
+FORCEINLINE bool IsShotSequenceNewer(uint16 A, uint16 B)
+{
+	return static_cast<int16>(A - B) > 0;
+}
@@ -0,0 +1,151 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "GunfireAudioSubsystem.h"
+#include "ShooterCharacter.h"
+#include "GameFramework/GameModeBase.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Sound/SoundWave.h"
+#include "Tests/AutomationCommon.h"
+
+namespace
+{
+	/** Loop cap of the test, and shooters starting a loop, past the cap */
+	constexpr int32 MaxLoops = 4;
+	constexpr int32 NumShooters = 7;
+
+	/** Real seconds the map gets to load */
+	constexpr double StartTimeout = 60.0;
+}
+
+/** Wait for the game world to begin play, then start more fire loops than the cap allows */
+class FCheckFireLoopCapCommand : public IAutomationLatentCommand
+{
+public:
+	FCheckFireLoopCapCommand(FAutomationTestBase* InTest):
+		Test(InTest),
+		StartTime(FPlatformTime::Seconds())
+	{
+
+	}
+
+	virtual bool Update() override
+	{
+		UWorld* World = ShooterTests::FindGameWorld();
+		UGunfireAudioSubsystem* GunfireAudio = World && World -> HasBegunPlay() ?
+			World -> GetSubsystem<UGunfireAudioSubsystem>() : nullptr;
+		if(GunfireAudio == nullptr)
+		{
+			if(FPlatformTime::Seconds() - StartTime <= StartTimeout) return false;
+
+			Test -> AddError(FString::Printf(TEXT("No game world with gunfire audio began play after %.0fs"),
+				StartTimeout));
+			return true;
+		}
+
+		CheckFireLoopCap(*World, *GunfireAudio);
+		ShooterTests::EndPlaySession();
+		return true;
+	}
+
+private:
+	void CheckFireLoopCap(UWorld& World, UGunfireAudioSubsystem& GunfireAudio) const
+	{
+		// Shooters of the game's class if it has one, their assets don't matter
+		const AGameModeBase* GameMode = World.GetAuthGameMode();
+		UClass* CharacterClass = GameMode ? GameMode -> DefaultPawnClass.Get() : nullptr;
+		if(CharacterClass == nullptr || !CharacterClass -> IsChildOf(AShooterCharacter::StaticClass()))
+		{
+			CharacterClass = AShooterCharacter::StaticClass();
+		}
+
+		// Next to the local player and High until the significance first scores them, so they are all heard
+		const AShooterCharacter* LocalCharacter = ShooterTests::GetLocalCharacter(&World);
+		const FVector Origin = LocalCharacter ? LocalCharacter -> GetActorLocation() : FVector::ZeroVector;
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		TArray<AShooterCharacter*> Shooters;
+		for(int32 Index = 0; Index < NumShooters; Index++)
+		{
+			AShooterCharacter* Shooter = World.SpawnActor<AShooterCharacter>(CharacterClass,
+				Origin + FVector(100.f * (Index + 1), 0.f, 0.f), FRotator::ZeroRotator, SpawnParameters);
+			if(Shooter)
+			{
+				Shooters.Add(Shooter);
+			}
+		}
+		if(Shooters.Num() != NumShooters)
+		{
+			Test -> AddError(FString::Printf(TEXT("Only %d of %d shooters spawned"), Shooters.Num(), NumShooters));
+		}
+
+		IConsoleVariable* MaxLoopsVariable =
+			IConsoleManager::Get().FindConsoleVariable(TEXT("Shooter.GunfireAudio.MaxLoops"));
+		const int32 PreviousMaxLoops = MaxLoopsVariable -> GetInt();
+		MaxLoopsVariable -> Set(MaxLoops, ECVF_SetByCode);
+
+		USoundWave* LoopSound = NewObject<USoundWave>(GetTransientPackage());
+		const int32 PreviousCulledVoices = GunfireAudio.GetNumCulledVoices();
+		for(AShooterCharacter* Shooter : Shooters)
+		{
+			GunfireAudio.StartFireLoop(Shooter, LoopSound, false);
+		}
+		const int32 NumFireLoops = GunfireAudio.GetNumFireLoops();
+		const int32 NumCulledVoices = GunfireAudio.GetNumCulledVoices() - PreviousCulledVoices;
+		Test -> AddInfo(FString::Printf(TEXT("%d loops started, %d playing, %d culled"), Shooters.Num(),
+			NumFireLoops, NumCulledVoices));
+
+		// A real device would stop our empty sound right away and free its slot
+		if(FApp::CanEverRenderAudio())
+		{
+			Test -> AddWarning(TEXT("The loop counts are only checked with the null audio device, run with -nosound"));
+		}
+		else
+		{
+			Test -> TestEqual(TEXT("The loops are capped"), NumFireLoops, FMath::Min(Shooters.Num(), MaxLoops));
+			Test -> TestEqual(TEXT("Every loop past the cap is culled"), NumCulledVoices,
+				FMath::Max(Shooters.Num() - MaxLoops, 0));
+		}
+
+		for(AShooterCharacter* Shooter : Shooters)
+		{
+			GunfireAudio.StopFireLoop(Shooter, nullptr);
+			Shooter -> Destroy();
+		}
+		Test -> TestEqual(TEXT("Stopping the shooters stops their loops"), GunfireAudio.GetNumFireLoops(), 0);
+		MaxLoopsVariable -> Set(PreviousMaxLoops, ECVF_SetByCode);
+	}
+
+	FAutomationTestBase* Test;
+
+	/** Real time the command was created */
+	double StartTime;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGunfireAudioLoopCapTest, "Shooter.Audio.FireLoopCap",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Opens the test map and starts more fire loops than Shooter.GunfireAudio.MaxLoops, the loops playing must stay at
+ * the cap and every one past it must be counted as culled. Run with -nosound, the loops are counted without a device.
+ */
+bool FGunfireAudioLoopCapTest::RunTest(const FString& Parameters)
+{
+	const FString Map = ShooterTests::GetTestMap();
+	if(Map.IsEmpty())
+	{
+		AddError(TEXT("No test map, pass -ShooterTestMap= or set the game default map"));
+		return false;
+	}
+	AutomationOpenMap(Map);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckFireLoopCapCommand(this));
+	return true;
+}
+
+#endif
@@ -0,0 +1,163 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ShooterBenchmarkSubsystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Tests/AutomationCommon.h"
+
+namespace
+{
+	/** A short run, enough for every character to get its weapon and fire */
+	constexpr int32 NumCharacters = 8;
+	constexpr int32 NumItems = 10;
+	constexpr float Duration = 5.f;
+
+	/** Real seconds the map gets to load, and the run to finish */
+	constexpr double StartTimeout = 60.0;
+	constexpr double RunTimeout = 120.0;
+}
+
+/** State shared by the latent commands of FShooterBenchmarkTest */
+struct FBenchmarkTestState
+{
+	TWeakObjectPtr<UShooterBenchmarkSubsystem> Benchmark;
+
+	/** Real time the current command started */
+	double CommandStartTime{ 0.0 };
+};
+
+/** Wait for the game world to begin play, then start a short benchmark run in it */
+class FStartBenchmarkCommand : public IAutomationLatentCommand
+{
+public:
+	FStartBenchmarkCommand(FAutomationTestBase* InTest, TSharedRef<FBenchmarkTestState> InState):
+		Test(InTest),
+		State(InState)
+	{
+
+	}
+
+	virtual bool Update() override
+	{
+		if(State -> CommandStartTime == 0.0)
+		{
+			State -> CommandStartTime = FPlatformTime::Seconds();
+		}
+
+		UWorld* World = ShooterTests::FindGameWorld();
+		UShooterBenchmarkSubsystem* Benchmark = World && World -> HasBegunPlay() ?
+			World -> GetSubsystem<UShooterBenchmarkSubsystem>() : nullptr;
+		if(Benchmark == nullptr)
+		{
+			if(FPlatformTime::Seconds() - State -> CommandStartTime <= StartTimeout) return false;
+
+			Test -> AddError(FString::Printf(TEXT("No game world began play after %.0fs"), StartTimeout));
+			return true;
+		}
+
+		FShooterBenchmarkSettings Settings;
+		Settings.NumCharacters = NumCharacters;
+		Settings.NumItems = NumItems;
+		Settings.Duration = Duration;
+		Settings.CSVPath = FPaths::AutomationTransientDir() / TEXT("ShooterBenchmarkTest.csv");
+		Settings.bQuitWhenFinished = false;
+		IFileManager::Get().Delete(*Settings.CSVPath, false, true, true);
+
+		Benchmark -> StartBenchmark(Settings);
+		State -> Benchmark = Benchmark;
+		State -> CommandStartTime = 0.0;
+		return true;
+	}
+
+private:
+	FAutomationTestBase* Test;
+	TSharedRef<FBenchmarkTestState> State;
+};
+
+/** Wait for the run to finish, check it fired and wrote its CSV */
+class FCheckBenchmarkCommand : public IAutomationLatentCommand
+{
+public:
+	FCheckBenchmarkCommand(FAutomationTestBase* InTest, TSharedRef<FBenchmarkTestState> InState):
+		Test(InTest),
+		State(InState)
+	{
+
+	}
+
+	virtual bool Update() override
+	{
+		if(State -> CommandStartTime == 0.0)
+		{
+			State -> CommandStartTime = FPlatformTime::Seconds();
+		}
+
+		const UShooterBenchmarkSubsystem* Benchmark = State -> Benchmark.Get();
+		if(Benchmark == nullptr)
+		{
+			if(!Test -> HasAnyErrors())
+			{
+				Test -> AddError(TEXT("The benchmark's world went away before the run finished"));
+			}
+			return EndPlay();
+		}
+		if(!Benchmark -> HasFinished())
+		{
+			if(FPlatformTime::Seconds() - State -> CommandStartTime <= RunTimeout) return false;
+
+			Test -> AddError(FString::Printf(TEXT("The benchmark didn't finish after %.0fs"), RunTimeout));
+			return EndPlay();
+		}
+
+		TArray<FString> Rows;
+		FFileHelper::LoadFileToStringArray(Rows, *Benchmark -> GetCSVPath());
+		Test -> AddInfo(FString::Printf(TEXT("%d shots fired, %d rows written to %s"),
+			Benchmark -> GetTotalShotsFired(), Rows.Num(), *Benchmark -> GetCSVPath()));
+		Test -> TestTrue(TEXT("The characters fired"), Benchmark -> GetTotalShotsFired() > 0);
+		Test -> TestTrue(TEXT("The CSV has a header and one row per frame"), Rows.Num() > 1);
+		return EndPlay();
+	}
+
+private:
+	/** Leave the play session the map was opened in */
+	static bool EndPlay()
+	{
+		ShooterTests::EndPlaySession();
+		return true;
+	}
+
+	FAutomationTestBase* Test;
+	TSharedRef<FBenchmarkTestState> State;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShooterBenchmarkTest, "Shooter.Benchmark.ShortRun",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Opens the test map, runs the benchmark for a few simulated seconds without quitting, and checks the characters
+ * fired and the CSV was written.
+ */
+bool FShooterBenchmarkTest::RunTest(const FString& Parameters)
+{
+	const FString Map = ShooterTests::GetTestMap();
+	if(Map.IsEmpty())
+	{
+		AddError(TEXT("No test map, pass -ShooterTestMap= or set the game default map"));
+		return false;
+	}
+	AutomationOpenMap(Map);
+
+	const TSharedRef<FBenchmarkTestState> State = MakeShared<FBenchmarkTestState>();
+	ADD_LATENT_AUTOMATION_COMMAND(FStartBenchmarkCommand(this, State));
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckBenchmarkCommand(this, State));
+	return true;
+}
+
+#endif
@@ -0,0 +1,245 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "ShooterCharacter.h"
+#include "Weapon.h"
+#include "Editor.h"
+#include "GameFramework/PlayerState.h"
+#include "Misc/AutomationTest.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationEditorCommon.h"
+
+namespace
+{
+	/** Players of the session: the listen server's own and two clients */
+	constexpr int32 NumPlayers = 3;
+
+	/** Seconds the session gets to start and arm every player, and the server to receive the shots */
+	constexpr double SessionTimeout = 60.0;
+	constexpr double ShotsTimeout = 5.0;
+
+	/** Seconds the client holds the fire button */
+	constexpr double BurstDuration = 0.5;
+
+	/** Bytes of an unquantized shot: origin, muzzle offset and aim as 3 floats each */
+	constexpr float UnquantizedBytesPerShot = 9 * sizeof(float);
+}
+
+/** State shared by the latent commands of FShooterListenServerFireTest */
+struct FListenServerFireState
+{
+	/** Character of the client firing the burst, in the client's world */
+	TWeakObjectPtr<AShooterCharacter> ClientShooter;
+
+	/** Player id of ClientShooter, to find its character in the server's world */
+	int32 PlayerId{ INDEX_NONE };
+
+	/** Real time the current command started */
+	double CommandStartTime{ 0.0 };
+};
+
+/** Start a listen server PIE session with NumPlayers players, all in this process */
+class FStartListenServerSessionCommand : public IAutomationLatentCommand
+{
+public:
+	virtual bool Update() override
+	{
+		ULevelEditorPlaySettings* PlaySettings = NewObject<ULevelEditorPlaySettings>();
+		PlaySettings -> SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+		PlaySettings -> SetPlayNumberOfClients(NumPlayers);
+		PlaySettings -> bLaunchSeparateServer = false;
+		PlaySettings -> SetRunUnderOneProcess(true);
+
+		FRequestPlaySessionParams Params;
+		Params.WorldType = EPlaySessionWorldType::PlayInEditor;
+		Params.EditorPlaySettings = PlaySettings;
+		GEditor -> RequestPlaySession(Params);
+		return true;
+	}
+};
+
+/** Wait until every player has a weapon with ammo, then pick the client that fires */
+class FWaitForArmedPlayersCommand : public IAutomationLatentCommand
+{
+public:
+	FWaitForArmedPlayersCommand(FAutomationTestBase* InTest, TSharedRef<FListenServerFireState> InState):
+		Test(InTest),
+		State(InState)
+	{
+
+	}
+
+	virtual bool Update() override
+	{
+		if(State -> CommandStartTime == 0.0)
+		{
+			State -> CommandStartTime = FPlatformTime::Seconds();
+		}
+
+		int32 NumArmedPlayers = 0;
+		AShooterCharacter* ClientShooter = nullptr;
+		for(UWorld* World : ShooterTests::GetGameWorlds())
+		{
+			AShooterCharacter* Character = ShooterTests::GetLocalCharacter(World);
+			const AWeapon* Weapon = Character ? Character -> GetEquippedWeapon() : nullptr;
+			if(Weapon == nullptr || Weapon -> GetAmmo() == 0 || Character -> GetPlayerState() == nullptr) continue;
+
+			NumArmedPlayers++;
+			if(ClientShooter == nullptr && World -> GetNetMode() == NM_Client)
+			{
+				ClientShooter = Character;
+			}
+		}
+
+		if(NumArmedPlayers >= NumPlayers && ClientShooter)
+		{
+			State -> ClientShooter = ClientShooter;
+			State -> PlayerId = ClientShooter -> GetPlayerState() -> GetPlayerId();
+			State -> CommandStartTime = 0.0;
+			return true;
+		}
+		if(FPlatformTime::Seconds() - State -> CommandStartTime > SessionTimeout)
+		{
+			Test -> AddError(FString::Printf(TEXT("Only %d of %d players were armed after %.0fs"), NumArmedPlayers,
+				NumPlayers, SessionTimeout));
+			return true;
+		}
+		return false;
+	}
+
+private:
+	FAutomationTestBase* Test;
+	TSharedRef<FListenServerFireState> State;
+};
+
+/** Hold the fire button of the client for BurstDuration */
+class FFireClientBurstCommand : public IAutomationLatentCommand
+{
+public:
+	FFireClientBurstCommand(TSharedRef<FListenServerFireState> InState):
+		State(InState)
+	{
+
+	}
+
+	virtual bool Update() override
+	{
+		AShooterCharacter* ClientShooter = State -> ClientShooter.Get();
+		if(ClientShooter == nullptr) return true;
+
+		if(State -> CommandStartTime == 0.0)
+		{
+			State -> CommandStartTime = FPlatformTime::Seconds();
+			ClientShooter -> SetFireButtonPressed(true);
+			return false;
+		}
+		if(FPlatformTime::Seconds() - State -> CommandStartTime < BurstDuration) return false;
+
+		ClientShooter -> SetFireButtonPressed(false);
+		State -> CommandStartTime = 0.0;
+		return true;
+	}
+
+private:
+	TSharedRef<FListenServerFireState> State;
+};
+
+/** Wait for the server to accept the client's shots, check the bytes per shot and end the session */
+class FCheckServerShotsCommand : public IAutomationLatentCommand
+{
+public:
+	FCheckServerShotsCommand(FAutomationTestBase* InTest, TSharedRef<FListenServerFireState> InState):
+		Test(InTest),
+		State(InState)
+	{
+
+	}
+
+	virtual bool Update() override
+	{
+		if(State -> CommandStartTime == 0.0)
+		{
+			State -> CommandStartTime = FPlatformTime::Seconds();
+		}
+
+		const AShooterCharacter* ClientShooter = State -> ClientShooter.Get();
+		const AShooterCharacter* ServerShooter = FindServerShooter();
+		const bool bTimedOut = FPlatformTime::Seconds() - State -> CommandStartTime > ShotsTimeout;
+		if(ClientShooter && ServerShooter && ServerShooter -> GetServerShotsAccepted() == 0 && !bTimedOut) return false;
+
+		if(ClientShooter && ServerShooter)
+		{
+			const float BytesPerShot = ClientShooter -> GetShotPacketBytesPerShot();
+			Test -> AddInfo(FString::Printf(TEXT("Server accepted %u shots, %.2f bytes per shot"),
+				ServerShooter -> GetServerShotsAccepted(), BytesPerShot));
+			Test -> TestTrue(TEXT("The server accepted the client's shots"),
+				ServerShooter -> GetServerShotsAccepted() > 0);
+#if STATS
+			// Packets are only measured with stats
+			Test -> TestTrue(TEXT("The client sent shot packets"), BytesPerShot > 0.f);
+			Test -> TestTrue(TEXT("Shots are sent quantized"), BytesPerShot < UnquantizedBytesPerShot);
+#endif
+		}
+		else if(!Test -> HasAnyErrors())
+		{
+			Test -> AddError(TEXT("The firing client's character is missing on the client or on the server"));
+		}
+
+		GEditor -> RequestEndPlayMap();
+		return true;
+	}
+
+private:
+	/** Returns the character of the firing client in the server's world */
+	AShooterCharacter* FindServerShooter() const
+	{
+		UWorld* ServerWorld = ShooterTests::FindGameWorld(NM_ListenServer);
+		if(ServerWorld == nullptr) return nullptr;
+
+		FConstPlayerControllerIterator Iterator = ServerWorld -> GetPlayerControllerIterator();
+		for(; Iterator; ++Iterator)
+		{
+			const APlayerController* PlayerController = Iterator -> Get();
+			if(PlayerController && PlayerController -> PlayerState &&
+				PlayerController -> PlayerState -> GetPlayerId() == State -> PlayerId)
+			{
+				return Cast<AShooterCharacter>(PlayerController -> GetPawn());
+			}
+		}
+		return nullptr;
+	}
+
+	FAutomationTestBase* Test;
+	TSharedRef<FListenServerFireState> State;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShooterListenServerFireTest, "Shooter.Network.ListenServerFire",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Plays the test map as a listen server with two clients, one client fires a burst, and the server must accept
+ * its shots. Logs the bytes per shot of the client's packets and checks they are quantized.
+ */
+bool FShooterListenServerFireTest::RunTest(const FString& Parameters)
+{
+	const FString Map = ShooterTests::GetTestMap();
+	if(Map.IsEmpty())
+	{
+		AddError(TEXT("No test map, pass -ShooterTestMap= or set the game default map"));
+		return false;
+	}
+	FAutomationEditorCommonUtils::LoadMap(Map);
+
+	const TSharedRef<FListenServerFireState> State = MakeShared<FListenServerFireState>();
+	ADD_LATENT_AUTOMATION_COMMAND(FStartListenServerSessionCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForArmedPlayersCommand(this, State));
+	ADD_LATENT_AUTOMATION_COMMAND(FFireClientBurstCommand(State));
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckServerShotsCommand(this, State));
+	return true;
+}
+
+#endif
@@ -0,0 +1,82 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "ShooterTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ShooterCharacter.h"
+#include "Engine/Engine.h"
+#include "GameFramework/PlayerController.h"
+#include "GameMapsSettings.h"
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
+FString ShooterTests::GetTestMap()
+{
+	FString Map;
+	if(!FParse::Value(FCommandLine::Get(), TEXT("ShooterTestMap="), Map))
+	{
+		Map = UGameMapsSettings::GetGameDefaultMap();
+	}
+	return Map;
+}
+
+TArray<UWorld*> ShooterTests::GetGameWorlds()
+{
+	TArray<UWorld*> Worlds;
+	if(GEngine == nullptr) return Worlds;
+
+	for(const FWorldContext& Context : GEngine -> GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if(World && (Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE))
+		{
+			Worlds.Add(World);
+		}
+	}
+	return Worlds;
+}
+
+UWorld* ShooterTests::FindGameWorld(ENetMode NetMode)
+{
+	for(UWorld* World : GetGameWorlds())
+	{
+		if(World -> GetNetMode() == NetMode) return World;
+	}
+	return nullptr;
+}
+
+UWorld* ShooterTests::FindGameWorld()
+{
+	const TArray<UWorld*> Worlds = GetGameWorlds();
+	return Worlds.Num() > 0 ? Worlds[0] : nullptr;
+}
+
+AShooterCharacter* ShooterTests::GetLocalCharacter(UWorld* World)
+{
+	if(World == nullptr) return nullptr;
+
+	for(FConstPlayerControllerIterator Iterator = World -> GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator -> Get();
+		if(PlayerController && PlayerController -> IsLocalController())
+		{
+			return Cast<AShooterCharacter>(PlayerController -> GetPawn());
+		}
+	}
+	return nullptr;
+}
+
+void ShooterTests::EndPlaySession()
+{
+#if WITH_EDITOR
+	if(GEditor && GEditor -> PlayWorld)
+	{
+		GEditor -> RequestEndPlayMap();
+	}
+#endif
+}
+
+#endif
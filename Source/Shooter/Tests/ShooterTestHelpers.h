@@ -0,0 +1,33 @@
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class AShooterCharacter;
+
+/** Shared by the Shooter.* automation tests */
+namespace ShooterTests
+{
+	/** Returns the map the tests run on, -ShooterTestMap= or the project's game default map */
+	FString GetTestMap();
+
+	/** Returns the running game worlds, the game's or the PIE instances' */
+	TArray<UWorld*> GetGameWorlds();
+
+	/** Returns the first running game world with NetMode, nullptr if there is none */
+	UWorld* FindGameWorld(ENetMode NetMode);
+
+	/** Returns the first running game world, whatever its net mode */
+	UWorld* FindGameWorld();
+
+	/** Returns the character possessed by the local player controller of World, nullptr if there is none */
+	AShooterCharacter* GetLocalCharacter(UWorld* World);
+
+	/** End the editor's play session the test map was opened in, if there is one */
+	void EndPlaySession();
+}
+
+#endif
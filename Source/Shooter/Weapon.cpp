@@ -1,70 +1,132 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-
-#include "Weapon.h"
-
-AWeapon::AWeapon():
-	ThrowWeaponDuration(0.7f),
-	bFalling(false),
-	Ammo(30),
-	MagazineCapacity(30),
-	WeaponType(EWeaponType::EWT_SubmachineGun),
-	AmmoType(EAmmoType::EAT_9mm),
-	ReloadMontageSection(FName(TEXT("RELOAD_SMG"))),
-	bMovingClip(false),
-	ClipBoneName(FName(TEXT("smg_clip")))
-{
-	PrimaryActorTick.bCanEverTick = true;
-}
-
-void AWeapon::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-	// Keep the Weapon upright
-	if(GetItemState() == EItemState::EIS_Falling && bFalling)
-	{
-		FRotator MeshRotation{ 0.f, GetItemMesh() -> GetComponentRotation().Yaw, 0.f };
-		GetItemMesh() -> SetWorldRotation(MeshRotation, false, nullptr, ETeleportType::TeleportPhysics);
-	}
-}
-
-void AWeapon::ThrowWeapon()
-{
-	// Keeping the Weapon still on its yaw rotation
-	FRotator MeshRotation { 0.f, GetItemMesh() -> GetComponentRotation().Yaw, 0.f };
-	GetItemMesh() -> SetWorldRotation(MeshRotation, false, nullptr, ETeleportType::TeleportPhysics);
-	
-	const FVector MeshForward { GetItemMesh() -> GetForwardVector() };
-	const FVector MeshRight { GetItemMesh() -> GetRightVector() };
-	// Direction in which we throw the Weapon
-	FVector ImpulseDirection = MeshRight.RotateAngleAxis(-50.f, MeshForward);
-
-	const float RandomRotation { 30.f };
-
-	ImpulseDirection = ImpulseDirection.RotateAngleAxis(RandomRotation, FVector(0.f, 0.f, 1.f));
-	ImpulseDirection *= 10'000.f;
-	
-	GetItemMesh() -> AddImpulse(ImpulseDirection);
-	bFalling = true;
-
-	GetWorldTimerManager().SetTimer(ThrowWeaponTimer, this, &AWeapon::StopFalling, ThrowWeaponDuration);
-}
-
-void AWeapon::StopFalling()
-{
-	bFalling = false;
-	SetItemState(EItemState::EIS_Pickup);
-}
-
-void AWeapon::DecrementAmmo()
-{
-	if(Ammo - 1 <= 0) Ammo = 0;
-	else --Ammo;
-}
-
-void AWeapon::ReloadAmmo(int32 Amount)
-{
-	checkf(Ammo + Amount <= MagazineCapacity, TEXT("Attempted to overfill the magazine"));
-	Ammo += Amount;
-}
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+
+#include "Weapon.h"
+
+#include "ShooterHUDViewModel.h"
+#include "ItemCollisionSubsystem.h"
+#include "DroppedItemSubsystem.h"
+
+AWeapon::AWeapon():
+	ThrowWeaponDuration(0.7f),
+	bFalling(false),
+	Ammo(30),
+	MagazineCapacity(30),
+	WeaponType(EWeaponType::EWT_SubmachineGun),
+	AmmoType(EAmmoType::EAT_9mm),
+	ReloadMontageSection(FName(TEXT("RELOAD_SMG"))),
+	bMovingClip(false),
+	ClipBoneName(FName(TEXT("smg_clip"))),
+	bFiresProjectiles(false),
+	MuzzleVelocity(40'000.f),
+	ProjectileGravityScale(1.f),
+	ProjectileLifetime(3.f)
+{
+	// The physics simulation keeps a thrown Weapon upright, equipped and resting weapons have nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AWeapon::ThrowWeapon()
+{
+	// The impulse needs the falling collision and physics now, not at the end of the frame
+	UItemCollisionSubsystem* ItemCollision = GetWorld() -> GetSubsystem<UItemCollisionSubsystem>();
+	if(ItemCollision)
+	{
+		ItemCollision -> FlushCommit(this);
+	}
+
+	// Keeping the Weapon still on its yaw rotation, the lock holds it there while it falls
+	FRotator MeshRotation { 0.f, GetItemMesh() -> GetComponentRotation().Yaw, 0.f };
+	GetItemMesh() -> SetWorldRotation(MeshRotation, false, nullptr, ETeleportType::TeleportPhysics);
+	SetUprightLock(true);
+	
+	const FVector MeshForward { GetItemMesh() -> GetForwardVector() };
+	const FVector MeshRight { GetItemMesh() -> GetRightVector() };
+	// Direction in which we throw the Weapon
+	FVector ImpulseDirection = MeshRight.RotateAngleAxis(-50.f, MeshForward);
+
+	const float RandomRotation { 30.f };
+
+	ImpulseDirection = ImpulseDirection.RotateAngleAxis(RandomRotation, FVector(0.f, 0.f, 1.f));
+	ImpulseDirection *= 10'000.f;
+	
+	GetItemMesh() -> AddImpulse(ImpulseDirection);
+	bFalling = true;
+
+	// The timer is the upper bound, UDroppedItemSubsystem stops the fall as soon as the Weapon rests
+	GetWorldTimerManager().SetTimer(ThrowWeaponTimer, this, &AWeapon::StopFalling, ThrowWeaponDuration);
+	UDroppedItemSubsystem* DroppedItems = GetWorld() -> GetSubsystem<UDroppedItemSubsystem>();
+	if(DroppedItems)
+	{
+		DroppedItems -> RegisterDrop(this);
+	}
+}
+
+void AWeapon::StopFalling()
+{
+	GetWorldTimerManager().ClearTimer(ThrowWeaponTimer);
+	bFalling = false;
+	SetUprightLock(false);
+	// The Weapon may have been picked up again before the timer ran out
+	if(GetItemState() == EItemState::EIS_Falling)
+	{
+		SetItemState(EItemState::EIS_Pickup);
+	}
+}
+
+void AWeapon::OnAcquiredFromPool()
+{
+	Ammo = GetClass() -> GetDefaultObject<AWeapon>() -> Ammo;
+	bMovingClip = false;
+	Super::OnAcquiredFromPool();
+}
+
+void AWeapon::OnReleasedToPool()
+{
+	GetWorldTimerManager().ClearTimer(ThrowWeaponTimer);
+	bFalling = false;
+	SetUprightLock(false);
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SetOwner(nullptr);
+	Super::OnReleasedToPool();
+}
+
+void AWeapon::SetUprightLock(bool bLock)
+{
+	FBodyInstance* BodyInstance = GetItemMesh() -> GetBodyInstance();
+	if(BodyInstance == nullptr) return;
+
+	// Only yaw stays free, the constraint is created at the current (upright) rotation
+	BodyInstance -> bLockXRotation = bLock;
+	BodyInstance -> bLockYRotation = bLock;
+	BodyInstance -> bLockZRotation = false;
+	BodyInstance -> SetDOFLock(bLock ? EDOFMode::SixDOF : EDOFMode::None);
+}
+
+void AWeapon::DecrementAmmo()
+{
+	if(Ammo - 1 <= 0) Ammo = 0;
+	else --Ammo;
+	PushHUDAmmo();
+}
+
+void AWeapon::SetAmmo(int32 Amount)
+{
+	Ammo = FMath::Clamp(Amount, 0, MagazineCapacity);
+	PushHUDAmmo();
+}
+
+void AWeapon::ReloadAmmo(int32 Amount)
+{
+	checkf(Ammo + Amount <= MagazineCapacity, TEXT("Attempted to overfill the magazine"));
+	Ammo += Amount;
+	PushHUDAmmo();
+}
+
+void AWeapon::PushHUDAmmo() const
+{
+	if(UShooterHUDViewModel* HUDViewModel = UShooterHUDViewModel::Get(Cast<APawn>(GetOwner())))
+	{
+		HUDViewModel -> SetAmmoInMagazine(Ammo);
+	}
+}
@@ -1,82 +1,120 @@
-// Copyright 2023 JesseTheCatLover. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Item.h"
-#include "AmmoType.h"
-#include "Weapon.generated.h"
-
-UENUM(BlueprintType)
-enum class EWeaponType : uint8
-{
-	EWT_SubmachineGun UMETA(Display = "SubmachineGun"),
-	EWT_AssaultRiffle UMETA(Display = "AssaultRiffle"),
-
-	EWT_DefaultMax UMETA(Display = "DefaultMax")
-};
-
-UCLASS()
-class SHOOTER_API AWeapon : public AItem
-{
-	GENERATED_BODY()
-public:
-	AWeapon();
-
-	virtual void Tick(float DeltaTime) override;
-
-protected:
-	void StopFalling();
-	
-private:
-	FTimerHandle ThrowWeaponTimer;
-	float ThrowWeaponDuration;
-	/** True when Weapon is falling */
-	bool bFalling;
-	
-	/** Amount of ammo in the weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	int32 Ammo;
-
-	/** Maximum amount of ammo the weapon can hold */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	int32 MagazineCapacity;
-
-	/** Type of weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	EWeaponType WeaponType;
-
-	/** Type of ammo */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	EAmmoType AmmoType;
-
-	/** Name of the ReloadMontage's section */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "ture"))
-	FName ReloadMontageSection;
-
-	/** True when moving the clip while reloading */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	bool bMovingClip;
-
-	/** Name for the clip bone */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	FName ClipBoneName;
-
-public:
-	/** Adds pulse to the Weapon */
-	void ThrowWeapon();
-
-	/** Called from Character class to decrement ammo value */
-	void DecrementAmmo();
-	
-	FORCEINLINE int32 GetAmmo() const { return Ammo; }
-	FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; }
-	FORCEINLINE EAmmoType GetAmmoType() const { return AmmoType; }
-	FORCEINLINE EWeaponType GetWeaponType() const { return WeaponType; }
-	FORCEINLINE FName GetReloadMontageSection() const { return ReloadMontageSection; }
-	FORCEINLINE FName GetClipBoneName() const { return ClipBoneName; }
-
-	void ReloadAmmo(int32 Amount);
-
-	FORCEINLINE void SetMovingClip(bool Moving) { bMovingClip = Moving; }
-};
+// Copyright 2023 JesseTheCatLover. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Item.h"
+#include "AmmoType.h"
+#include "Weapon.generated.h"
+
+UENUM(BlueprintType)
+enum class EWeaponType : uint8
+{
+	EWT_SubmachineGun UMETA(Display = "SubmachineGun"),
+	EWT_AssaultRiffle UMETA(Display = "AssaultRiffle"),
+
+	EWT_DefaultMax UMETA(Display = "DefaultMax")
+};
+
+UCLASS()
+class SHOOTER_API AWeapon : public AItem
+{
+	GENERATED_BODY()
+public:
+	AWeapon();
+
+protected:
+	/** Full magazine of the class defaults, back to Pickup */
+	virtual void OnAcquiredFromPool() override;
+
+	/** Ends a throw still in progress and leaves the character that dropped it */
+	virtual void OnReleasedToPool() override;
+
+	/** Lock the pitch and roll of the simulated ItemMesh so the Weapon falls upright, or release the lock
+	 *	@param bLock True while the Weapon is thrown */
+	void SetUprightLock(bool bLock);
+	
+private:
+	FTimerHandle ThrowWeaponTimer;
+	float ThrowWeaponDuration;
+	/** True when Weapon is falling */
+	bool bFalling;
+	
+	/** Amount of ammo in the weapon */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	int32 Ammo;
+
+	/** Maximum amount of ammo the weapon can hold */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	int32 MagazineCapacity;
+
+	/** Type of weapon */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	EWeaponType WeaponType;
+
+	/** Type of ammo */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	EAmmoType AmmoType;
+
+	/** Name of the ReloadMontage's section */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "ture"))
+	FName ReloadMontageSection;
+
+	/** True when moving the clip while reloading */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	bool bMovingClip;
+
+	/** Name for the clip bone */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	FName ClipBoneName;
+
+	/** Fire projectiles simulated by UProjectileSubsystem, with travel time and bullet drop, instead of hitscan */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	bool bFiresProjectiles;
+
+	/** Speed of the projectiles leaving the barrel, in cm/s */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true",
+		EditCondition = "bFiresProjectiles", ClampMin = "1.0"))
+	float MuzzleVelocity;
+
+	/** Multiplier of the world gravity applied to the projectiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true",
+		EditCondition = "bFiresProjectiles"))
+	float ProjectileGravityScale;
+
+	/** Seconds before a projectile that hit nothing disappears */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true",
+		EditCondition = "bFiresProjectiles", ClampMin = "0.0"))
+	float ProjectileLifetime;
+
+public:
+	/** Adds pulse to the Weapon */
+	void ThrowWeapon();
+
+	/** End the fall of the Weapon, once it rests or ThrowWeaponDuration has passed */
+	void StopFalling();
+
+	/** Called from Character class to decrement ammo value */
+	void DecrementAmmo();
+	
+	FORCEINLINE int32 GetAmmo() const { return Ammo; }
+	/** Called on clients to correct the predicted ammo with the server's */
+	void SetAmmo(int32 Amount);
+	FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; }
+	FORCEINLINE EAmmoType GetAmmoType() const { return AmmoType; }
+	FORCEINLINE EWeaponType GetWeaponType() const { return WeaponType; }
+	FORCEINLINE FName GetReloadMontageSection() const { return ReloadMontageSection; }
+	FORCEINLINE FName GetClipBoneName() const { return ClipBoneName; }
+	FORCEINLINE bool FiresProjectiles() const { return bFiresProjectiles; }
+	FORCEINLINE float GetMuzzleVelocity() const { return MuzzleVelocity; }
+	FORCEINLINE float GetProjectileGravityScale() const { return ProjectileGravityScale; }
+	FORCEINLINE float GetProjectileLifetime() const { return ProjectileLifetime; }
+
+	void ReloadAmmo(int32 Amount);
+
+	FORCEINLINE void SetMovingClip(bool Moving) { bMovingClip = Moving; }
+
+private:
+	/** Push Ammo to the HUD of the local player holding the weapon */
+	void PushHUDAmmo() const;
+};